@@ -0,0 +1,128 @@
+/*
+ * Copyright (C) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * is provided AS IS, WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, and
+ * NON-INFRINGEMENT.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ */
+
+// Memory benchmark for the directory entries kept by the zim writer. It
+// creates count dirents, which look like those of a wikipedia dump (80%
+// articles with the aid equal to the url, 20% redirects), once in a
+// std::vector<zim::writer::Dirent> as the writer did before, and once in
+// a zim::writer::DirentStore, each in its own process, and reports the
+// peak resident set size per million dirents.
+//
+// usage: direntMemory [count [vector|store]]
+
+#include <zim/writer/direntstore.h>
+#include <iostream>
+#include <sstream>
+#include <vector>
+#include <cstdlib>
+#include <cerrno>
+#include <cstring>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace
+{
+  // peak resident set size in kilobytes
+  long peakRss()
+  {
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+  }
+
+  zim::writer::Dirent makeDirent(unsigned n)
+  {
+    static const char* words[] = { "History", "of", "the", "Republic",
+      "List", "River", "Battle", "Station", "Church", "University" };
+
+    std::ostringstream url;
+    url << words[n % 10] << '_' << words[n / 10 % 10] << '_' << words[n / 100 % 10] << '_' << n;
+
+    zim::writer::Dirent dirent('A', url.str());
+    dirent.setAid(url.str());
+    if (n % 5 == 4)
+    {
+      dirent.setRedirectAid(makeDirent(n - 1).getAid());
+      dirent.setRedirect(0);
+    }
+    else
+      dirent.setArticle(0, 0, 0);
+    return dirent;
+  }
+
+  void run(const std::string& mode, unsigned count)
+  {
+    long before = peakRss();
+
+    std::vector<zim::writer::Dirent> dirents;
+    zim::writer::DirentStore store;
+    for (unsigned n = 0; n < count; ++n)
+    {
+      if (mode == "vector")
+        dirents.push_back(makeDirent(n));
+      else
+        store.push_back(makeDirent(n));
+    }
+
+    long used = peakRss() - before;
+    std::cout << mode << ": " << count << " dirents, peak rss "
+              << used / 1024 << " MB, "
+              << static_cast<double>(used) / 1024 * 1000000 / count << " MB per million dirents"
+              << std::endl;
+  }
+}
+
+int main(int argc, char* argv[])
+{
+  unsigned count = argc > 1 ? std::atoi(argv[1]) : 1000000;
+  if (count == 0)
+  {
+    std::cerr << "usage: " << argv[0] << " [count [vector|store]]" << std::endl;
+    return 1;
+  }
+
+  if (argc > 2)
+  {
+    run(argv[2], count);
+    return 0;
+  }
+
+  // every mode in a fresh process, so that they do not share the peak
+  const char* modes[] = { "vector", "store" };
+  for (unsigned m = 0; m < 2; ++m)
+  {
+    pid_t pid = fork();
+    if (pid < 0)
+    {
+      std::cerr << "fork failed: " << strerror(errno) << std::endl;
+      return 1;
+    }
+
+    if (pid == 0)
+    {
+      run(modes[m], count);
+      std::cout.flush();
+      _exit(0);
+    }
+
+    int status;
+    waitpid(pid, &status, 0);
+  }
+}
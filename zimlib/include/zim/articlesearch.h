@@ -21,6 +21,7 @@
 #define ZIM_ARTICLESEARCH_H
 
 #include <vector>
+#include <limits>
 #include <zim/file.h>
 #include <zim/fileiterator.h>
 #include <zim/article.h>
@@ -34,14 +35,18 @@ namespace zim
 
     private:
       File articleFile;
-      std::string titles;
+      char ns;
 
     public:
-      explicit ArticleSearch(const File& articleFile_)
-        : articleFile(articleFile_)
+      explicit ArticleSearch(const File& articleFile_, char ns_ = 'A')
+        : articleFile(articleFile_),
+          ns(ns_)
         { }
 
-      Results search(const std::string& expr);
+      /// Returns the articles of the namespace with expr in their title.
+      /// The titles are searched with the in-memory title index of the
+      /// file (see File::getTitleIndex).
+      Results search(const std::string& expr, size_type limit = std::numeric_limits<size_type>::max());
   };
 }
 
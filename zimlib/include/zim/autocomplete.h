@@ -0,0 +1,94 @@
+/*
+ * Copyright (C) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * is provided AS IS, WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, and
+ * NON-INFRINGEMENT.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ */
+
+#ifndef ZIM_AUTOCOMPLETE_H
+#define ZIM_AUTOCOMPLETE_H
+
+#include <string>
+#include <vector>
+#include <zim/zim.h>
+
+namespace zim
+{
+  /**
+     Precomputed completions for short title prefixes.
+
+     For every prefix of up to maxPrefixLength bytes, which starts at least
+     one title, the article indexes of the k most popular titles starting
+     with it are stored. Popularity is a score given by the caller (e.g.
+     the number of redirects to the article); ties prefer shorter titles
+     and then lower article indexes.
+
+     A lookup is a binary search over the prefixes and does not depend on
+     the number of titles starting with the prefix.
+   */
+  class Autocomplete
+  {
+    public:
+      typedef std::vector<size_type> Results;
+
+    private:
+      struct EntryType
+      {
+        std::string key;    // title truncated to maxPrefixLength bytes
+        size_type length;   // full length of the title
+        size_type idx;
+        size_type score;
+      };
+
+      unsigned k;
+      unsigned maxPrefixLength;
+      std::vector<EntryType> entries;   // added titles until build()
+
+      std::vector<std::string> prefixes;    // sorted
+      std::vector<size_type> starts;        // start of each prefix in completions
+      std::vector<size_type> completions;
+
+    public:
+      explicit Autocomplete(unsigned k_ = 10, unsigned maxPrefixLength_ = 3)
+        : k(k_),
+          maxPrefixLength(maxPrefixLength_)
+        { }
+
+      /// Appends a title. Call build() after adding the last title.
+      void add(const std::string& title, size_type idx, size_type score);
+      /// Computes the completions and releases the added titles.
+      void build();
+
+      unsigned getK() const                 { return k; }
+      unsigned getMaxPrefixLength() const   { return maxPrefixLength; }
+      size_type getCountPrefixes() const    { return prefixes.size(); }
+
+      /// Returns the approximate number of bytes used by the completions.
+      size_type getMemoryUsage() const;
+
+      /// Returns true, if prefix is not empty and not longer than
+      /// maxPrefixLength, so that its completions are stored.
+      bool covers(const std::string& prefix) const
+        { return !prefix.empty() && prefix.size() <= maxPrefixLength; }
+
+      /// Appends the article indexes of the most popular titles starting
+      /// with prefix to results, best first, but not more than limit and
+      /// never more than k. Returns false, if the prefix is not covered.
+      bool find(const std::string& prefix, Results& results, unsigned limit = 10) const;
+  };
+
+}
+
+#endif // ZIM_AUTOCOMPLETE_H
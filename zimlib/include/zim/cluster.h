@@ -40,6 +40,8 @@ namespace zim
       typedef std::vector<char> Data;
 
       CompressionType compression;
+      int compressionLevel;
+      size_type blockSize;
       Offsets offsets;
       Data data;
 
@@ -52,16 +54,32 @@ namespace zim
       void setCompression(CompressionType c)  { compression = c; }
       CompressionType getCompression() const  { return compression; }
       bool isCompressed() const               { return compression == zimcompZip || compression == zimcompBzip2 || compression == zimcompLzma; }
+      /// The level passed to the compressor when writing: the zlib level,
+      /// the bzip2 block size or the lzma preset. -1 selects the default,
+      /// which is ZIM_LZMA_LEVEL for lzma.
+      void setCompressionLevel(int l)         { compressionLevel = l; }
+      int getCompressionLevel() const         { return compressionLevel; }
+      /// A compressed cluster larger than a non zero block size is written
+      /// as independently compressed blocks of that size, so that readers
+      /// need not decompress all of it to get a blob.
+      void setBlockSize(size_type s)          { blockSize = s; }
+      size_type getBlockSize() const          { return blockSize; }
 
       size_type getCount() const              { return offsets.size() - 1; }
       const char* getData(unsigned n) const   { return &data[ offsets[n] ]; }
       size_type getSize(unsigned n) const     { return offsets[n+1] - offsets[n]; }
       size_type getSize() const               { return offsets.size() * sizeof(size_type) + data.size(); }
+      size_type getDataSize() const           { return data.size(); }
       Blob getBlob(size_type n) const;
       void clear();
 
       void addBlob(const Blob& blob);
       void addBlob(const char* data, unsigned size);
+      /// Replaces the content with a single blob of size bytes and returns
+      /// a pointer to its data, which the caller fills.
+      char* resizeBlob(size_type size);
+      /// Replaces the content with a single blob of size bytes read from in.
+      void readBlob(std::istream& in, size_type size);
   };
 
   class Cluster
@@ -78,6 +96,10 @@ namespace zim
 
       void setCompression(CompressionType c)  { getImpl()->setCompression(c); }
       CompressionType getCompression() const  { return impl ? impl->getCompression() : zimcompNone; }
+      void setCompressionLevel(int l)         { getImpl()->setCompressionLevel(l); }
+      int getCompressionLevel() const         { return impl ? impl->getCompressionLevel() : -1; }
+      void setBlockSize(size_type s)          { getImpl()->setBlockSize(s); }
+      size_type getBlockSize() const          { return impl ? impl->getBlockSize() : 0; }
       bool isCompressed() const
         { return impl && (impl->getCompression() == zimcompZip
                        || impl->getCompression() == zimcompBzip2
@@ -89,10 +111,15 @@ namespace zim
 
       size_type count() const   { return impl ? impl->getCount() : 0; }
       size_type size() const    { return impl ? impl->getSize() : 0; }
+      /// Returns the size of the blobs, which are stored one after another
+      /// starting at getBlobPtr(0).
+      size_type dataSize() const  { return impl ? impl->getDataSize() : 0; }
       void clear()              { impl = 0; }
 
       void addBlob(const char* data, unsigned size) { getImpl()->addBlob(data, size); }
       void addBlob(const Blob& blob)                { getImpl()->addBlob(blob); }
+      char* resizeBlob(size_type size)              { return getImpl()->resizeBlob(size); }
+      void readBlob(std::istream& in, size_type size) { getImpl()->readBlob(in, size); }
 
       operator bool() const   { return impl; }
   };
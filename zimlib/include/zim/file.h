@@ -62,7 +62,9 @@ namespace zim
       offset_type getClusterOffset(size_type idx) const    { return impl->getClusterOffset(idx); }
 
       Blob getBlob(size_type clusterIdx, size_type blobIdx)
-        { return getCluster(clusterIdx).getBlob(blobIdx); }
+        { return impl->getBlob(clusterIdx, blobIdx); }
+      size_type getBlobSize(size_type clusterIdx, size_type blobIdx) const
+        { return impl->getBlobSize(clusterIdx, blobIdx); }
 
       size_type getNamespaceBeginOffset(char ch)
         { return impl->getNamespaceBeginOffset(ch); }
@@ -97,8 +99,15 @@ namespace zim
 
       const std::string& getMimeType(uint16_t idx) const   { return impl->getMimeType(idx); }
 
+      const TitleDictionary& getTitleDictionary(char ns)  { return impl->getTitleDictionary(ns); }
+      const TitleIndex& getTitleIndex(char ns)            { return impl->getTitleIndex(ns); }
+      void writeTitleIndex(char ns)                       { impl->writeTitleIndex(ns); }
+      const Autocomplete& getAutocomplete(char ns)        { return impl->getAutocomplete(ns); }
+
       std::string getChecksum()   { return impl->getChecksum(); }
-      bool verify()               { return impl->verify(); }
+      /// Verifies the md5 checksum of the file. Returns false, if the file
+      /// has no checksum and throws ZimFileFormatError, if it does not match.
+      bool verify(Progress* progress = 0)   { return impl->verify(progress); }
   };
 
   std::string urldecode(const std::string& url);
@@ -30,10 +30,17 @@
 #include <zim/cache.h>
 #include <zim/dirent.h>
 #include <zim/cluster.h>
+#include <zim/blob.h>
 #include <zim/geopoint.h>
+#include <zim/titledictionary.h>
+#include <zim/titleindex.h>
+#include <zim/autocomplete.h>
+#include <zim/progress.h>
 
 namespace zim
 {
+  class ClusterBlocks;
+
   class FileImpl : public RefCounted
   {
       ifstream zimFile;
@@ -42,6 +49,8 @@ namespace zim
 
       Cache<size_type, Dirent> direntCache;
       Cache<offset_type, Cluster> clusterCache;
+      typedef std::pair<size_type, size_type> BlockKey;   // cluster, block
+      Cache<BlockKey, Cluster> blockCache;
       typedef std::map<char, size_type> NamespaceCache;
       NamespaceCache namespaceBeginCache;
       NamespaceCache namespaceEndCache;
@@ -53,7 +62,32 @@ namespace zim
 
       std::vector<offset_type> geoIndices;
 
+      typedef std::map<char, TitleDictionary> TitleDictionaries;
+      TitleDictionaries titleDictionaries;
+
+      typedef std::map<char, TitleIndex> TitleIndexes;
+      TitleIndexes titleIndexes;
+
+      typedef std::map<char, Autocomplete> Autocompletes;
+      Autocompletes autocompletes;
+
+      // The titles of the dirents of a namespace in url order. They are
+      // read in one pass for building the title dictionary, the title index
+      // or the autocompletion and released right after the build.
+      struct NamespaceTitles
+      {
+        std::vector<std::string> titles;
+        std::vector<bool> isArticle;
+        std::vector<size_type> redirects;   // number of redirects to each dirent
+      };
+
       offset_type getOffset(offset_type ptrOffset, size_type idx);
+      bool getBlobRange(offset_type clusterOffset, size_type blobIdx, offset_type& pos, size_type& size, ClusterBlocks& blocks);
+      Cluster getBlock(size_type clusterIdx, offset_type clusterOffset, const ClusterBlocks& blocks, size_type n);
+      void readBlocks(size_type clusterIdx, offset_type clusterOffset, const ClusterBlocks& blocks,
+                      size_type begin, size_type end, char* out);
+      void getBlockedBlobRange(size_type clusterIdx, offset_type clusterOffset, const ClusterBlocks& blocks,
+                               size_type blobIdx, size_type& begin, size_type& end);
 
     public:
       explicit FileImpl(const char* fname);
@@ -73,6 +107,13 @@ namespace zim
       size_type getCountClusters() const       { return header.getClusterCount(); }
       offset_type getClusterOffset(size_type idx)   { return getOffset(header.getClusterPtrPos(), idx); }
 
+      /// Returns a blob. Blobs of uncompressed clusters, which are not
+      /// cached, are read from the file without reading the whole cluster.
+      /// Of clusters compressed in blocks only the blocks covering the
+      /// blob are decompressed; the blocks are cached separately.
+      Blob getBlob(size_type clusterIdx, size_type blobIdx);
+      size_type getBlobSize(size_type clusterIdx, size_type blobIdx);
+
       size_type getNamespaceBeginOffset(char ch);
       size_type getNamespaceEndOffset(char ch);
       size_type getNamespaceCount(char ns)
@@ -83,13 +124,40 @@ namespace zim
 
       const std::string& getMimeType(uint16_t idx) const;
 
+      /// Returns the title dictionary of namespace ns. It is read from the
+      /// title index on first use and kept in memory.
+      const TitleDictionary& getTitleDictionary(char ns);
+
+      /// Returns the substring index over the titles of the articles in
+      /// namespace ns. It is read from the sidecar file named by
+      /// getTitleIndexFilename, when that exists and belongs to this file.
+      /// Otherwise it is built from the directory entries on first use.
+      const TitleIndex& getTitleIndex(char ns);
+      /// Writes the title index of namespace ns to its sidecar file.
+      void writeTitleIndex(char ns);
+      std::string getTitleIndexFilename(char ns) const;
+
+      /// Returns the completions of short title prefixes in namespace ns.
+      /// They are built from the directory entries on first use, ranking
+      /// the articles by the number of redirects pointing to them.
+      const Autocomplete& getAutocomplete(char ns);
+
       unsigned getCountGeoIndices() const      { return geoIndices.size() - 1; }
       bool findArticlesByGeoArea(const GeoPoint& min, const GeoPoint& max, size_t maxResults, unsigned index, std::vector<ArticleGeoPoint>& results);
 
       std::string getChecksum();
-      bool verify();
+      bool verify(Progress* progress = 0);
 
     private:
+      void readUrlPointers(size_type begin, size_type end, std::vector<offset_type>& result);
+      template <typename T>
+      T& getPerNamespace(std::map<char, T>& cache, char ns, void (FileImpl::*create)(char, T&));
+      void readNamespaceTitles(char ns, NamespaceTitles& result);
+      void readTitleDictionary(char ns, TitleDictionary& dict);
+      void createTitleIndex(char ns, TitleIndex& index);
+      void buildTitleIndex(char ns, TitleIndex& index);
+      bool readTitleIndexFile(char ns, TitleIndex& index);
+      void buildAutocomplete(char ns, Autocomplete& autocomplete);
       bool findArticlesByGeoAreaInt(GeoPoint min, GeoPoint max, size_t maxResults, unsigned depth, std::vector<ArticleGeoPoint>& results);
   };
 
@@ -64,13 +64,20 @@ namespace zim
 
       std::streambuf::int_type overflow(std::streambuf::int_type ch);
       std::streambuf::int_type underflow();
+      /// Reads larger blocks directly into s, bypassing the buffer.
+      std::streamsize xsgetn(char* s, std::streamsize n);
       int sync();
 
+      int readFile(char* p, size_t size);
+
       void setCurrentFile(const std::string& fname, zim::offset_type off);
 
       mutable time_t mtime;
 
     public:
+      /// names and sizes of the files, which make up a split file
+      typedef std::vector<std::pair<std::string, zim::offset_type> > PartsType;
+
       streambuf(const std::string& fname, unsigned bufsize, unsigned openFilesCache);
 
       void seekg(zim::offset_type off);
@@ -78,6 +85,7 @@ namespace zim
       { buffer.resize(s); }
       zim::offset_type fsize() const;
       time_t getMTime() const;
+      PartsType getParts() const;
   };
 
   class ifstream : public std::istream
@@ -96,6 +104,7 @@ namespace zim
       void setBufsize(unsigned s) { myStreambuf.setBufsize(s); }
       zim::offset_type fsize() const  { return myStreambuf.fsize(); }
       time_t getMTime() const     { return myStreambuf.getMTime(); }
+      streambuf::PartsType getParts() const  { return myStreambuf.getParts(); }
   };
 
 }
@@ -21,10 +21,37 @@
 #define ZIM_INDEXARTICLE_H
 
 #include <zim/article.h>
+#include <zim/zintstream.h>
 #include <vector>
+#include <iosfwd>
 
 namespace zim
 {
+  /**
+     Index articles in namespace 'X' hold the entries of the full text index
+     for one word. The entries are split into 4 categories by weight.
+
+     There are 3 formats:
+
+       - "B": the parameter is empty and the data holds 4 entry counts
+         followed by the entries as 32 bit little endian values.
+
+       - "Z": the parameter holds zint compressed a field with one flag per
+         non empty category and for each such category the length of its
+         data and the first entry. The data holds the remaining entries as
+         zint compressed index and position deltas.
+
+       - block format: like "Z", but the flag field has blockFormatFlag set
+         and the parameter holds for each non empty category the length of
+         its data and the number of entries. The data of a category starts
+         with a skip entry for each block of blockSize entries: the delta of
+         its largest article index to the one of the previous block and the
+         length of the block. The blocks follow. Each block holds the index
+         deltas of its entries followed by their positions, which are deltas
+         to the previous position, when the index does not change.
+         Blocks are decoded independently, so that the skip entries allow
+         passing over blocks without decoding them.
+   */
   class IndexArticle : public Article
   {
     public:
@@ -36,34 +63,103 @@ namespace zim
 
       typedef std::vector<Entry> EntriesType;
 
+      struct Block
+      {
+        unsigned maxIndex;  // largest article index in the block
+        unsigned offset;    // offset of the block in the article data
+        unsigned size;      // size of the block in bytes
+        unsigned count;     // number of entries in the block
+      };
+
+      typedef std::vector<Block> BlocksType;
+
+      /// flag in the parameter, which marks the block format
+      static const unsigned blockFormatFlag = 0x10;
+      /// maximum number of entries in a block
+      static const unsigned blockSize = 128;
+
+      /**
+         Iterates over the entries of a category ordered by article index.
+         In the block format only the current block is decoded and skipTo
+         passes over blocks using the skip entries.
+       */
+      class Cursor
+      {
+          IndexArticle* article;
+          unsigned cat;
+          unsigned block;
+          EntriesType blockEntries;
+          EntriesType::size_type current;
+
+          const EntriesType& entries() const
+            { return article->blockFormat ? blockEntries : article->entries[cat]; }
+          void readBlock();
+
+        public:
+          Cursor(IndexArticle& article_, unsigned cat_);
+
+          bool end() const                   { return current >= entries().size(); }
+          const Entry& operator*() const     { return entries()[current]; }
+          const Entry* operator->() const    { return &entries()[current]; }
+          Cursor& operator++();
+
+          /// moves to the first entry with an article index not less than
+          /// index and returns false, when there is none
+          bool skipTo(unsigned index);
+      };
+
     private:
+      friend class Cursor;
+
       EntriesType entries[4];
+      BlocksType blocks[4];
+      unsigned counts[4];
       bool categoriesRead;
+      bool blockFormat;
+      bool blocksDecoded[4];
       void readEntries();
       void readEntriesZ();  // directmedia style zint-compression
       void readEntriesB();  // article compressed style
+      void readBlocks(ZIntStream& extra, unsigned flagfield);
+      void readBlock(unsigned cat, unsigned block, EntriesType& result);
+      void decodeBlocks(unsigned cat);
 
       static bool noOffset;
 
     public:
       IndexArticle(const Article& article)
         : Article(article),
-          categoriesRead(false)
-        { }
+          categoriesRead(false),
+          blockFormat(false)
+      {
+        for (unsigned c = 0; c < 4; ++c)
+          counts[c] = 0;
+      }
 
       unsigned getCategoryCount(unsigned cat)
-        { readEntries(); return entries[cat].size(); }
+        { readEntries(); return counts[cat]; }
       const EntriesType& getCategory(unsigned cat)
-        { readEntries(); return entries[cat]; }
+        { readEntries(); decodeBlocks(cat); return entries[cat]; }
       unsigned getTotalCount()
       {
         readEntries();
         unsigned c = 0;
         for (unsigned cat = 0; cat < 4; ++cat)
-          c += entries[cat].size();
+          c += counts[cat];
         return c;
       }
 
+      /// returns true, if the entries are stored in the block format
+      bool isBlockFormat()
+        { readEntries(); return blockFormat; }
+      /// returns the skip entries of a category in the block format
+      const BlocksType& getBlocks(unsigned cat)
+        { readEntries(); return blocks[cat]; }
+
+      /// writes the entries of a category in the block format: the skip
+      /// entries followed by the blocks
+      static void writeBlocks(std::ostream& out, const EntriesType& entries);
+
       static void setNoOffset(bool sw = true)   { noOffset = sw; }
       static bool getNoOffset()                 { return noOffset; }
   };
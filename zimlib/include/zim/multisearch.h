@@ -0,0 +1,75 @@
+/*
+ * Copyright (C) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * is provided AS IS, WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, and
+ * NON-INFRINGEMENT.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ */
+
+#ifndef ZIM_MULTISEARCH_H
+#define ZIM_MULTISEARCH_H
+
+#include <zim/search.h>
+#include <zim/noncopyable.h>
+
+namespace zim
+{
+  class MultiSearchImpl;
+
+  /**
+     Full text search over a library of zim files.
+
+     A query runs one Search per file on a pool of threads and merges the
+     best matches of all files into one list ordered by priority. A query
+     may be given a deadline: files, whose search did not finish in time,
+     are left out of the results. A search, which is already running, is
+     not interrupted but finishes in the background; its results are
+     discarded.
+
+     File objects are not thread safe, so each file is locked while a
+     search runs on it. Files added here must not be used by other threads
+     at the same time without further synchronization.
+   */
+  class MultiSearch : private NonCopyable
+  {
+      MultiSearchImpl* impl;
+
+    public:
+      typedef Search::Results Results;
+
+      /// Creates a library searched by the given number of threads. When
+      /// threads is 0, the environment variable ZIM_SEARCHTHREADS or 4 is
+      /// used.
+      explicit MultiSearch(unsigned threads = 0);
+      /// Waits for searches running in the background.
+      ~MultiSearch();
+
+      /// Adds a zim file, which contains its full text index.
+      void add(const File& zimfile);
+      /// Adds a zim file and the file with its full text index.
+      void add(const File& articlefile, const File& indexfile);
+
+      size_type size() const;
+      unsigned getCountThreads() const;
+
+      /// Searches all files for expr and returns the limit best matches in
+      /// results. When timeout is not 0, results found within timeout
+      /// milliseconds are returned. Returns the number of files, which
+      /// were searched completely.
+      size_type search(Results& results, const std::string& expr,
+                       unsigned limit = 100, unsigned timeout = 0);
+  };
+}
+
+#endif // ZIM_MULTISEARCH_H
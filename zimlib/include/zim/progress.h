@@ -0,0 +1,38 @@
+/*
+ * Copyright (C) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * is provided AS IS, WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, and
+ * NON-INFRINGEMENT.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ */
+
+#ifndef ZIM_PROGRESS_H
+#define ZIM_PROGRESS_H
+
+#include <zim/zim.h>
+
+namespace zim
+{
+  /// Receives the progress of long running operations like File::verify().
+  class Progress
+  {
+    public:
+      virtual ~Progress()  { }
+
+      /// Called from time to time with the number of bytes processed so far.
+      virtual void progress(offset_type done, offset_type total) = 0;
+  };
+}
+
+#endif // ZIM_PROGRESS_H
@@ -48,8 +48,15 @@ namespace zim
 
       virtual ~RefCounted()  { }
 
+      // The counter is changed atomically, so that handles to the same
+      // object may be copied and released in different threads.
+#ifdef __GNUC__
+      virtual unsigned addRef()  { return __sync_add_and_fetch(&rc, 1); }
+      virtual void release()     { if (__sync_sub_and_fetch(&rc, 1) == 0) delete this; }
+#else
       virtual unsigned addRef()  { return ++rc; }
       virtual void release()     { if (--rc == 0) delete this; }
+#endif
       unsigned refs() const   { return rc; }
   };
 
@@ -23,6 +23,7 @@
 #include <zim/article.h>
 #include <vector>
 #include <map>
+#include <limits>
 
 namespace zim
 {
@@ -44,7 +45,7 @@ namespace zim
 
     public:
       SearchResult() : priority(0) { }
-      explicit SearchResult(const Article& article_, unsigned priority_ = 0)
+      explicit SearchResult(const Article& article_, double priority_ = 0)
         : article(article_),
           priority(priority_)
           { }
@@ -61,12 +62,33 @@ namespace zim
       class Results : public std::vector<SearchResult>
       {
           std::string expr;
+          size_type totalCount;
+          size_type offset;
 
         public:
+          Results()
+            : totalCount(0),
+              offset(0)
+            { }
+
           void setExpression(const std::string& e)
             { expr = e; }
           const std::string& getExpression() const
             { return expr; }
+
+          /// number of matching articles; may exceed size(), when the
+          /// search was limited
+          void setTotalCount(size_type c)
+            { totalCount = c; }
+          size_type getTotalCount() const
+            { return totalCount > offset + size() ? totalCount : offset + size(); }
+
+          /// rank of the first result, when only a page of the results
+          /// is returned
+          void setOffset(size_type o)
+            { offset = o; }
+          size_type getOffset() const
+            { return offset; }
       };
 
     private:
@@ -78,6 +100,7 @@ namespace zim
       static double weightPosRel;
       static double weightDistinctWords;
       static unsigned searchLimit;
+      static unsigned phraseGap;
 
       File indexfile;
       File articlefile;
@@ -95,7 +118,48 @@ namespace zim
           articlefile(articlefile_)
           { }
 
-      void search(Results& results, const std::string& expr);
+      /// Searches the full text index for expr and returns the limit best
+      /// matches in results. Only these get their title read.
+      ///
+      /// Words in double quotes ("new york") form a phrase, which must
+      /// occur in this order in a matching article with at most
+      /// getPhraseGap() bytes between the words. A suffix ~n ("new york"~20)
+      /// allows n bytes. Phrases are checked while intersecting the
+      /// postings, so articles not containing all phrases are not ranked.
+      void search(Results& results, const std::string& expr,
+                  unsigned limit = std::numeric_limits<unsigned>::max());
+      /// Returns count matches of expr starting with the match at offset.
+      /// The ranking is kept in a process wide cache, which is shared by
+      /// all searches of equal expressions in the same files, so only the
+      /// requested page is read from the files.
+      void searchCached(Results& results, const std::string& expr, unsigned offset, unsigned count);
+
+      /// Finds up to limit articles in namespace ns, whose titles differ
+      /// from title by at most maxDistance characters, closest first. The
+      /// priority of a result is maxDistance + 1 - distance. This uses the
+      /// title index of the article file (see File::getTitleIndex) and
+      /// gives "did you mean" suggestions.
+      void findSimilar(Results& results, char ns, const std::string& title,
+                       unsigned limit = 10, unsigned maxDistance = 2);
+
+      /// Returns up to limit articles in namespace ns, whose titles start
+      /// with praefix, for completing a title while it is typed. Short
+      /// prefixes are answered from the precomputed completions of the
+      /// article file (see File::getAutocomplete) with the most linked
+      /// articles first. Longer prefixes have few matches, which are
+      /// returned in title order.
+      void suggest(Results& results, char ns, const std::string& praefix, unsigned limit = 10);
+
+      /// Returns for each of the results of a search in these files about
+      /// size bytes of the article text around the densest group of words
+      /// of the search expression, which are highlighted with <b> tags. The
+      /// positions of the words are taken from the full text index, so only
+      /// a small window of each article is scanned. The articles are read
+      /// ordered by cluster, so that each cluster is decompressed at most
+      /// once. The snippets are html.
+      void getSnippets(const Results& results, std::vector<std::string>& snippets,
+                       unsigned size = 200);
+
       void find(Results& results, char ns, const std::string& praefix, unsigned limit = searchLimit);
       void find(Results& results, char ns, const std::string& begin, const std::string& end, unsigned limit = searchLimit);
 
@@ -107,6 +171,8 @@ namespace zim
       static double getWeightPosRel()              { return weightPosRel; }
       static double getWeightDistinctWords()       { return weightDistinctWords; }
       static unsigned getSearchLimit()             { return searchLimit; }
+      static unsigned getPhraseGap()               { return phraseGap; }
+      static size_type getCacheSize();
 
       static void setWeightOcc(double v)           { weightOcc = v; }
       static void setWeightOccOff(double v)        { weightOccOff = v; }
@@ -116,6 +182,12 @@ namespace zim
       static void setWeightPosRel(double v)        { weightPosRel = v; }
       static void setWeightDistinctWords(double v) { weightDistinctWords = v; }
       static void setSearchLimit(unsigned v)       { searchLimit = v; }
+      /// Sets the maximum number of bytes between the words of a phrase
+      /// without a ~n suffix. Positions in the index count the bytes of the
+      /// article including markup.
+      static void setPhraseGap(unsigned v)         { phraseGap = v; }
+      /// Sets the maximum number of bytes used by the search cache.
+      static void setCacheSize(size_type bytes);
   };
 }
 
@@ -0,0 +1,130 @@
+/*
+ * Copyright (C) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * is provided AS IS, WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, and
+ * NON-INFRINGEMENT.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ */
+
+#ifndef ZIM_TITLEDICTIONARY_H
+#define ZIM_TITLEDICTIONARY_H
+
+#include <string>
+#include <vector>
+#include <zim/zim.h>
+
+namespace zim
+{
+  /**
+     In-memory dictionary mapping the titles of one namespace to article
+     indexes.
+
+     The titles are kept sorted and front coded: each entry stores the
+     length of the prefix shared with the previous title, the remaining
+     suffix and the article index, all lengths and numbers zint compressed.
+     Every restartInterval entries the full title is stored, so that a
+     lookup is a binary search over these restart points followed by a
+     short linear scan. This needs a few bytes per title and no file
+     access at all.
+   */
+  class TitleDictionary
+  {
+    public:
+      static const unsigned restartInterval = 16;
+
+      class const_iterator
+      {
+          friend class TitleDictionary;
+
+          const TitleDictionary* dict;
+          size_type entry;
+          size_type offset;
+          size_type next;
+          std::string title;
+          size_type index;
+
+          const_iterator(const TitleDictionary* dict_, size_type entry_, size_type offset_)
+            : dict(dict_),
+              entry(entry_),
+              offset(offset_),
+              next(offset_),
+              index(0)
+          { decode(); }
+
+          void decode();
+
+        public:
+          const_iterator()
+            : dict(0),
+              entry(0),
+              offset(0),
+              next(0),
+              index(0)
+            { }
+
+          const std::string& getTitle() const  { return title; }
+          size_type getIndex() const           { return index; }
+
+          const std::string& operator*() const   { return title; }
+          const std::string* operator->() const  { return &title; }
+
+          const_iterator& operator++();
+          const_iterator operator++(int)
+            { const_iterator it = *this; operator++(); return it; }
+
+          bool operator== (const const_iterator& it) const
+            { return entry == it.entry; }
+          bool operator!= (const const_iterator& it) const
+            { return entry != it.entry; }
+      };
+
+    private:
+      friend class const_iterator;
+
+      std::string data;
+      std::vector<size_type> restarts;
+      size_type count;
+      std::string lastTitle;
+
+    public:
+      TitleDictionary()
+        : count(0)
+        { }
+
+      /// Appends a title. Titles must be added in ascending order.
+      void add(const std::string& title, size_type idx);
+
+      size_type size() const      { return count; }
+      bool empty() const          { return count == 0; }
+
+      /// Returns the approximate number of bytes used by the dictionary.
+      size_type getMemoryUsage() const
+        { return data.capacity() + restarts.capacity() * sizeof(size_type) + sizeof(*this); }
+
+      const_iterator begin() const
+        { return const_iterator(this, 0, 0); }
+      const_iterator end() const
+        { return const_iterator(this, count, data.size()); }
+
+      /// Returns an iterator to the first title not less than title.
+      const_iterator lower_bound(const std::string& title) const;
+      /// Returns an iterator to title or end(), if not found.
+      const_iterator find(const std::string& title) const;
+      /// Returns true and the article index of title in idx, if found.
+      bool find(const std::string& title, size_type& idx) const;
+  };
+
+}
+
+#endif // ZIM_TITLEDICTIONARY_H
@@ -0,0 +1,117 @@
+/*
+ * Copyright (C) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * is provided AS IS, WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, and
+ * NON-INFRINGEMENT.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ */
+
+#ifndef ZIM_TITLEINDEX_H
+#define ZIM_TITLEINDEX_H
+
+#include <string>
+#include <vector>
+#include <iosfwd>
+#include <limits>
+#include <zim/zim.h>
+
+namespace zim
+{
+  /**
+     In-memory substring index over the titles of one namespace.
+
+     The titles are packed into one buffer, each terminated by a '\0'.
+     Every trigram of a title (ascii characters folded to lower case) is
+     hashed into a bucket, and each bucket holds the numbers of the titles
+     containing one of its trigrams as zint compressed deltas.
+
+     A search for an expression of 3 or more characters intersects the
+     buckets of its trigrams and verifies the remaining candidates against
+     the packed titles. Shorter expressions are searched by scanning the
+     packed titles, which is still a memory only operation.
+   */
+  class TitleIndex
+  {
+    public:
+      /// article indexes of matching titles in the order they were added
+      typedef std::vector<size_type> Results;
+
+    private:
+      std::string titles;
+      std::vector<size_type> offsets;    // start of each title in titles
+      std::vector<size_type> articles;   // article index of each title
+      unsigned bucketBits;
+      std::vector<size_type> buckets;    // start of each bucket in postings
+      std::string postings;
+
+      unsigned bucket(const char* p) const;
+      void getTrigrams(const char* begin, const char* end, std::vector<unsigned>& result) const;
+      void decodeBucket(unsigned b, std::vector<size_type>& result) const;
+      bool matches(size_type n, const std::string& expr) const;
+      void scan(const std::string& expr, Results& results, size_type limit) const;
+
+    public:
+      TitleIndex()
+        : bucketBits(0)
+        { }
+
+      /// Appends a title. Call build() after adding the last title.
+      void add(const std::string& title, size_type idx);
+      /// Creates the trigram buckets of the added titles.
+      void build();
+
+      size_type size() const    { return offsets.size(); }
+      bool empty() const        { return offsets.empty(); }
+
+      std::string getTitle(size_type n) const
+        { return std::string(titles.data() + offsets[n]); }
+      size_type getArticleIndex(size_type n) const
+        { return articles[n]; }
+
+      /// Returns the approximate number of bytes used by the index.
+      size_type getMemoryUsage() const;
+
+      /// Appends the article indexes of the titles, which contain expr, to
+      /// results, but not more than limit.
+      void search(const std::string& expr, Results& results,
+                  size_type limit = std::numeric_limits<size_type>::max()) const;
+
+      /// A title similar to a search expression: edit distance and
+      /// number of the title in the index.
+      typedef std::pair<unsigned, size_type> SimilarType;
+      typedef std::vector<SimilarType> SimilarResults;
+
+      /// Finds up to limit titles, which differ from expr by at most
+      /// maxDistance inserted, deleted or replaced characters, ignoring
+      /// ascii letter case. The closest titles come first.
+      ///
+      /// Candidates must share enough trigrams with expr. The work is
+      /// bounded by the postings of the trigrams of expr: very common
+      /// trigrams are skipped and only the maxCandidates titles sharing
+      /// most trigrams are compared with expr.
+      /// Expressions shorter than 3 characters find nothing.
+      void findSimilar(const std::string& expr, SimilarResults& results,
+                       size_type limit = 10, unsigned maxDistance = 2) const;
+
+      static const size_type maxCandidates = 10000;
+      /// Buckets with more bytes of postings are skipped by findSimilar.
+      static const size_type maxBucketSize = 1 << 18;
+
+      void write(std::ostream& out) const;
+      void read(std::istream& in);
+  };
+
+}
+
+#endif // ZIM_TITLEINDEX_H
@@ -46,6 +46,19 @@ namespace zim
         virtual std::string getRedirectAid() const;
         virtual std::string getParameter() const;
 
+        // Returns true, if the data of the article is passed with getData()
+        // instead of ArticleSource::getData. These articles are packed into
+        // clusters in the order, in which they are fetched, so that the
+        // source is not read a second time. The blob needs to be valid
+        // until the next article is fetched.
+        virtual bool hasData() const;
+        virtual Blob getData() const;
+
+        // Returns a key for grouping articles into clusters, when the
+        // clusters are grouped by hint. Articles with the same key share
+        // clusters, e.g. the pages of a section or the resources of a page.
+        virtual std::string getClusterHint() const;
+
         // returns the next category id, to which the article is assigned to
         virtual std::string getNextCategory();
     };
@@ -58,12 +71,67 @@ namespace zim
         virtual std::string getTitle() const = 0;
     };
 
+    /**
+       The data of an article handed over to the writer by
+       ArticleSource::takeData without copying it.
+
+       It is either a buffer, which the source passes by swapping, or a
+       range of a file, which the writer reads itself. Blobs from a file,
+       which are not compressed, are copied from the file to the zim file,
+       by the kernel where possible, and compressed ones are mapped into
+       memory.
+     */
+    class ArticleData
+    {
+        std::string buffer;
+        std::string fname;
+        offset_type offset;
+        size_type size;
+
+      public:
+        ArticleData()
+          : offset(0),
+            size(0)
+          { }
+
+        /// Takes the content of data, which is left empty.
+        void take(std::string& data)
+        {
+          fname.clear();
+          buffer.clear();
+          buffer.swap(data);
+        }
+
+        /// Passes size bytes of the file fname starting at offset. The
+        /// file must not change until the zim file is created.
+        void setFile(const std::string& fname_, offset_type offset_, size_type size_)
+        {
+          buffer.clear();
+          fname = fname_;
+          offset = offset_;
+          size = size_;
+        }
+
+        bool isFile() const                     { return !fname.empty(); }
+        const std::string& getBuffer() const    { return buffer; }
+        const std::string& getFilename() const  { return fname; }
+        offset_type getOffset() const           { return offset; }
+        size_type getSize() const               { return isFile() ? size : buffer.size(); }
+    };
+
     class ArticleSource
     {
       public:
         virtual void setFilename(const std::string& fname) { }
         virtual const Article* getNextArticle() = 0;
         virtual Blob getData(const std::string& aid) = 0;
+
+        // Passes the data of an article to the writer and returns true.
+        // Unlike getData, the source need not keep a copy of the data
+        // until the next call. The default returns false, so that the
+        // writer uses getData.
+        virtual bool takeData(const std::string& aid, ArticleData& data);
+
         virtual Uuid getUuid();
         virtual std::string getMainPage();
         virtual std::string getLayoutPage();
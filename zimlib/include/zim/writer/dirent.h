@@ -31,16 +31,25 @@ namespace zim
         std::string aid;
         std::string redirectAid;
         size_type idx;
+        size_type clusterGroup;
         bool compress;
+        bool packed;
 
       public:
-        Dirent() {}
+        Dirent()
+          : clusterGroup(0),
+            packed(false)
+          {}
 
         Dirent(const std::string& aid_)
-          : aid(aid_)
+          : aid(aid_),
+            clusterGroup(0),
+            packed(false)
           {}
 
         Dirent(char ns, const std::string& url)
+          : clusterGroup(0),
+            packed(false)
         { setUrl(ns, url); }
 
         void setAid(const std::string&  aid_)      { aid = aid_; }
@@ -52,8 +61,16 @@ namespace zim
         void setIdx(size_type idx_)      { idx = idx_; }
         size_type getIdx() const         { return idx; }
 
+        /// blobs of different groups are packed into different clusters
+        void setClusterGroup(size_type g)  { clusterGroup = g; }
+        size_type getClusterGroup() const  { return clusterGroup; }
+
         void setCompress(bool sw = true)  { compress = sw; }
         bool isCompress() const           { return compress; }
+
+        /// true, if the data is already in a cluster
+        void setPacked(bool sw = true)    { packed = sw; }
+        bool isPacked() const             { return packed; }
     };
 
     inline bool compareUrl(const Dirent& d1, const Dirent& d2)
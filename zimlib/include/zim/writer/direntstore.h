@@ -0,0 +1,139 @@
+/*
+ * Copyright (C) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * is provided AS IS, WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, and
+ * NON-INFRINGEMENT.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ */
+
+#ifndef ZIM_WRITER_DIRENTSTORE_H
+#define ZIM_WRITER_DIRENTSTORE_H
+
+#include <zim/writer/dirent.h>
+#include <zim/writer/stringarena.h>
+#include <vector>
+
+namespace zim
+{
+  namespace writer
+  {
+    /**
+       Compact in-memory storage of the dirents of a zim file under
+       construction.
+
+       Each dirent is a fixed size record, which references its strings in
+       a StringArena. The aid, the title and the url are stored only once,
+       if they are equal, which is the common case. A record needs about 44
+       bytes plus the strings, where a Dirent needs about 200 bytes plus a
+       heap allocation for every string, which does not fit into the
+       std::string object.
+
+       The strings of a dirent cannot be changed once it is added; get()
+       returns a copy of the dirent and update() stores its other fields
+       back.
+     */
+    class DirentStore
+    {
+      public:
+        typedef zim::size_type size_type;
+
+      private:
+        typedef StringArena::Handle Handle;
+
+        struct Entry
+        {
+          Handle aid;
+          Handle url;
+          Handle title;
+          Handle parameter;
+          Handle redirectAid;
+          size_type version;
+          size_type clusterNumber;  // redirect index of redirects
+          size_type blobNumber;
+          size_type idx;
+          size_type clusterGroup;
+          uint16_t mimeType;
+          char ns;
+          unsigned char flags;
+        };
+
+        enum
+        {
+          flagCompress = 1,
+          flagPacked = 2
+        };
+
+        StringArena strings;
+        std::vector<Entry> entries;
+
+        static void setFields(Entry& e, const Dirent& dirent);
+
+      public:
+        void push_back(const Dirent& dirent);
+
+        /// Returns a copy of the n-th dirent.
+        Dirent get(size_type n) const;
+        /// Copies all fields but the strings from dirent to the n-th dirent.
+        void update(size_type n, const Dirent& dirent)
+          { setFields(entries[n], dirent); }
+
+        size_type size() const   { return entries.size(); }
+        bool empty() const       { return entries.empty(); }
+
+        /// Moves the dirent number order[i] to position i for all i. The
+        /// permutation order is used as work space.
+        void permute(std::vector<size_type>& order);
+        /// Keeps the first n dirents.
+        void resize(size_type n)   { entries.resize(n); }
+
+        void clear();
+
+        // fast access to the fields needed while sorting and writing
+        char getNamespace(size_type n) const     { return entries[n].ns; }
+        bool isRedirect(size_type n) const
+          { return entries[n].mimeType == Dirent::redirectMimeType; }
+        size_type getIdx(size_type n) const { return entries[n].idx; }
+        void setIdx(size_type n, size_type idx)  { entries[n].idx = idx; }
+        void setRedirect(size_type n, size_type idx)
+        {
+          entries[n].mimeType = Dirent::redirectMimeType;
+          entries[n].clusterNumber = idx;
+          entries[n].blobNumber = 0;
+        }
+
+        bool isArticle(size_type n) const
+          { return entries[n].mimeType < Dirent::deletedMimeType; }
+        uint16_t getMimeType(size_type n) const  { return entries[n].mimeType; }
+        void setMimeType(size_type n, uint16_t mimeType)
+          { entries[n].mimeType = mimeType; }
+
+        /// Returns the size of the n-th dirent in the zim file.
+        size_type getDirentSize(size_type n) const;
+
+        std::string getAid(size_type n) const          { return strings.get(entries[n].aid); }
+        std::string getUrl(size_type n) const          { return strings.get(entries[n].url); }
+        std::string getTitle(size_type n) const        { return strings.get(entries[n].title); }
+        std::string getRedirectAid(size_type n) const  { return strings.get(entries[n].redirectAid); }
+
+        bool isAid(size_type n, const std::string& aid) const
+          { return strings.equals(entries[n].aid, aid); }
+
+        /// Returns the number of bytes used by the records and strings.
+        size_type getMemoryUsage() const
+          { return entries.capacity() * sizeof(Entry) + strings.getMemoryUsage(); }
+    };
+  }
+}
+
+#endif // ZIM_WRITER_DIRENTSTORE_H
@@ -0,0 +1,98 @@
+/*
+ * Copyright (C) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * is provided AS IS, WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, and
+ * NON-INFRINGEMENT.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ */
+
+#ifndef ZIM_WRITER_STRINGARENA_H
+#define ZIM_WRITER_STRINGARENA_H
+
+#include <string>
+#include <vector>
+#include <zim/zim.h>
+#include <zim/noncopyable.h>
+
+namespace zim
+{
+  namespace writer
+  {
+    /**
+       Bump allocator for many small strings, which live until the arena
+       is cleared.
+
+       The strings are appended to chunks of chunkSize bytes, each preceded
+       by its length in 7 bit groups, and are referenced by their 32 bit
+       offset. A chunk is never reallocated, so a growing arena does not
+       copy the strings, and there is no per string allocation overhead.
+       The empty string is always at offset 0.
+     */
+    class StringArena : private NonCopyable
+    {
+      public:
+        typedef uint32_t Handle;
+
+        static const unsigned chunkBits = 22;
+        static const size_type chunkSize = 1 << chunkBits;
+        static const Handle empty = 0;
+
+      private:
+        std::vector<char*> chunks;
+        size_type used;       // in the last chunk
+        size_type count;
+
+        const char* decode(Handle h, size_type& size) const;
+
+      public:
+        StringArena();
+        ~StringArena();
+
+        /// Appends a copy of the string and returns its offset. Throws
+        /// std::runtime_error, if the arena is full.
+        Handle add(const char* data, size_type size);
+        Handle add(const std::string& str)
+          { return add(str.data(), str.size()); }
+
+        std::string get(Handle h) const
+        {
+          size_type size;
+          const char* data = decode(h, size);
+          return std::string(data, size);
+        }
+
+        size_type getSize(Handle h) const
+        {
+          size_type size;
+          decode(h, size);
+          return size;
+        }
+
+        /// Returns true, if the string at h equals str.
+        bool equals(Handle h, const std::string& str) const;
+
+        /// Releases all strings.
+        void clear();
+
+        /// number of strings added since the last clear()
+        size_type size() const   { return count; }
+
+        /// Returns the number of bytes allocated for the strings.
+        size_type getMemoryUsage() const
+          { return chunks.size() * chunkSize; }
+    };
+  }
+}
+
+#endif // ZIM_WRITER_STRINGARENA_H
@@ -22,6 +22,8 @@
 
 #include <zim/writer/articlesource.h>
 #include <zim/writer/dirent.h>
+#include <zim/writer/direntstore.h>
+#include <zim/cluster.h>
 #include <vector>
 #include <map>
 #include <sstream>
@@ -31,10 +33,13 @@ namespace zim
 {
   namespace writer
   {
+    class ClusterWriter;
+    class DedupTable;
+
     class ZimCreator
     {
       public:
-        typedef std::vector<Dirent> DirentsType;
+        typedef DirentStore DirentsType;
         typedef std::vector<size_type> SizeVectorType;
         typedef std::vector<offset_type> OffsetsType;
         typedef std::map<std::string, uint16_t> MimeTypes;
@@ -42,8 +47,36 @@ namespace zim
         typedef std::vector<zim::ArticleGeoPoint> ArticleGeoPointsType;
         typedef ArticleGeoPointsType::iterator ArticleGeoPointIterator;
 
+        /// How blobs are assigned to clusters.
+        enum ClusterStrategy
+        {
+          clusterByUrl,       ///< in url order
+          clusterByMimeType,  ///< in url order, one cluster per mime type
+          clusterByHint,      ///< in url order, one cluster per Article::getClusterHint()
+          clusterByTitle      ///< in title order
+        };
+
       private:
+        // open clusters by cluster group and compression flag
+        typedef std::pair<size_type, bool> ClusterKey;
+        struct OpenCluster
+        {
+          Cluster cluster;
+          size_type id;
+          size_type lastUsed;   // number of the last blob added
+        };
+        typedef std::map<ClusterKey, OpenCluster> OpenClusters;
+        typedef std::map<std::string, size_type> ClusterHints;
+
         unsigned minChunkSize;
+        unsigned compressionThreads;
+        unsigned maxDirentMemory;
+        bool deduplicate;
+        ClusterStrategy clusterStrategy;
+        bool adaptiveCompression;
+        unsigned compressionBudget;
+        unsigned minDecodeSpeed;
+        unsigned blockSize;
 
         Fileheader header;
 
@@ -57,25 +90,73 @@ namespace zim
         uint16_t nextMimeIdx;
         CompressionType compression;
         bool isEmpty;
+        offset_type mimeListStart;
+        offset_type clustersStart;    // 0 until the first cluster is started
         offset_type clustersSize;
 
+        // The zim file and the clusters, which are filled, during create().
+        // Compressed and uncompressed blobs and blobs of different cluster
+        // groups are packed into separate clusters. Dirents get a
+        // provisional cluster id, when a cluster is started, and
+        // clusterNumbers maps it to the cluster number once the cluster
+        // is written.
+        std::ostream* zimfile;
+        ClusterWriter* clusterWriter;
+        OpenClusters openClusters;
+        SizeVectorType clusterNumbers;
+        ClusterHints clusterHints;
+        size_type countPacked;
+
+        // blobs already written and the last cluster read back from the
+        // zim file to compare a blob with
+        DedupTable* dedupTable;
+        size_type countDuplicates;
+        std::istream* zimReader;
+        Cluster* readCluster;
+        size_type readClusterNumber;
+
+        // used, when the dirents are kept in temporary files
+        std::string tmpBasename;
+        size_type countDirents;
+        offset_type direntsSize;
+        std::vector<uint16_t> mimeMapping;
+        SizeVectorType redirectTargets;
+
+        std::string direntsTmpName() const   { return tmpBasename + ".dirents.tmp"; }
+        std::string clusteredTmpName() const { return tmpBasename + ".clustered.tmp"; }
+
+        Dirent createDirent(const Article& article);
         void createDirents(ArticleSource& src);
+        void createDirentsExternal(ArticleSource& src);
         void createTitleIndex(ArticleSource& src);
-        void createClusters(ArticleSource& src, const std::string& tmpfname);
+        void writeMimeTypes(std::ostream& out);
+        void createClusters(ArticleSource& src);
+        void addArticleData(const Article& article, Dirent& dirent, size_type seq);
+        void addDirentData(ArticleSource& src, Dirent& dirent);
+        void packBlob(Dirent& dirent, const Blob& blob, const ArticleData* file = 0);
+        void addCluster(OpenClusters::iterator it);
+        size_type getClusterGroup(const Article& article, uint16_t mimeType);
+        void setClusterNumber(Dirent& dirent) const;
+        bool isSameBlob(const Blob& blob, size_type id, size_type blobNumber);
+        bool readBlobRange(offset_type clusterOffset, size_type blobNumber,
+                           offset_type& pos, size_type& size);
+        bool isSameData(const Blob& blob, offset_type pos);
         void addGeoPoint(Blob const& blob, size_t index);
         void createGeoIndex();
         void createGeoIndexPart(ArticleGeoPointIterator begin, ArticleGeoPointIterator end, unsigned depth = 0);
         void fillHeader(ArticleSource& src);
-        void write(const std::string& fname, const std::string& tmpfname);
+        void write(std::ostream& out);
+        void writeChecksum(std::ostream& zimfile, const std::string& zimfname);
 
         static int32_t parseCoordinateMicroDegrees(const char*& text);
 
         size_type clusterCount() const        { return clusterOffsets.size(); }
-        size_type articleCount() const        { return dirents.size(); }
+        size_type articleCount() const        { return countDirents; }
         offset_type mimeListSize() const;
-        offset_type mimeListPos() const       { return Fileheader::size; }
+        offset_type mimeListPos() const       { return mimeListStart; }
         offset_type urlPtrSize() const        { return articleCount() * sizeof(offset_type); }
-        offset_type urlPtrPos() const         { return mimeListPos() + mimeListSize(); }
+        offset_type clustersPos() const       { return clustersStart; }
+        offset_type urlPtrPos() const         { return clustersPos() + clustersSize; }
         offset_type titleIdxSize() const      { return articleCount() * sizeof(size_type); }
         offset_type titleIdxPos() const       { return urlPtrPos() + urlPtrSize(); }
         offset_type geoIdxSize() const        { return geoIndex.str().size(); }
@@ -84,18 +165,82 @@ namespace zim
         offset_type indexPos() const          { return geoIdxPos() + geoIdxSize(); }
         offset_type clusterPtrSize() const    { return clusterCount() * sizeof(offset_type); }
         offset_type clusterPtrPos() const     { return indexPos() + indexSize(); }
-        offset_type checksumPos() const       { return clusterPtrPos() + clusterPtrSize() + clustersSize; }
+        offset_type checksumPos() const       { return clusterPtrPos() + clusterPtrSize(); }
 
         uint16_t getMimeTypeIdx(const std::string& mimeType);
         const std::string& getMimeType(uint16_t mimeTypeIdx) const;
 
       public:
+        /// Space left for the mime type list before the clusters of
+        /// articles, which are packed while they are fetched.
+        static const offset_type mimeListReserve = 4096;
+
+        /// Number of clusters filled at the same time, when the blobs are
+        /// grouped. When another group is started, the least recently used
+        /// open cluster is written.
+        static const unsigned maxOpenClusters = 16;
+
+        /// Blobs passed as a file range, which are not compressed and at
+        /// least this large, are copied from the file into a cluster of
+        /// their own.
+        static const size_type minFileClusterSize = 64 * 1024;
+
         ZimCreator();
         ZimCreator(int& argc, char* argv[]);
 
         unsigned getMinChunkSize()    { return minChunkSize; }
         void setMinChunkSize(int s)   { minChunkSize = s; }
 
+        /// Returns the number of threads compressing clusters and sorting
+        /// the directory entries; 0 means, that the clusters are compressed
+        /// while they are written and everything is sorted in one thread.
+        unsigned getCompressionThreads() const    { return compressionThreads; }
+        void setCompressionThreads(unsigned n)    { compressionThreads = n; }
+
+        /// Returns the memory in MB used for sorting the directory entries.
+        /// When it is exceeded, they are sorted in temporary files next to
+        /// the zim file. 0 means, that all entries are kept in memory.
+        unsigned getMaxDirentMemory() const       { return maxDirentMemory; }
+        void setMaxDirentMemory(unsigned mb)      { maxDirentMemory = mb; }
+
+        /// Returns true, if blobs with identical content are stored once
+        /// and shared by their directory entries.
+        bool getDeduplicate() const               { return deduplicate; }
+        void setDeduplicate(bool sw = true)       { deduplicate = sw; }
+
+        /// Returns the strategy for assigning blobs to clusters. Grouping
+        /// similar blobs improves compression and keeps blobs read together
+        /// in the same cluster. Articles packed while fetching (see
+        /// Article::hasData) are always packed in the order they are
+        /// fetched; title order needs the directory entries in memory and
+        /// falls back to url order otherwise.
+        ClusterStrategy getClusterStrategy() const    { return clusterStrategy; }
+        void setClusterStrategy(ClusterStrategy s)    { clusterStrategy = s; }
+
+        /// Returns true, if the compression of each cluster is chosen by
+        /// compressing a sample with the available codecs and levels
+        /// instead of using one compression for all clusters.
+        bool getAdaptiveCompression() const       { return adaptiveCompression; }
+        void setAdaptiveCompression(bool sw = true)   { adaptiveCompression = sw; }
+
+        /// Returns the cpu seconds, which adaptive compression may spend
+        /// sampling and compressing; 0 means unlimited. Once the budget is
+        /// used up, the fastest codec is used.
+        unsigned getCompressionBudget() const     { return compressionBudget; }
+        void setCompressionBudget(unsigned s)     { compressionBudget = s; }
+
+        /// Returns the minimum decompression speed in MB/s of the codecs
+        /// chosen by adaptive compression; 0 means any speed.
+        unsigned getMinDecodeSpeed() const        { return minDecodeSpeed; }
+        void setMinDecodeSpeed(unsigned mbs)      { minDecodeSpeed = mbs; }
+
+        /// Returns the size in kB of the independently compressed blocks
+        /// of a cluster; 0 compresses each cluster as a whole. Readers
+        /// decompress only the blocks covering a blob, but smaller blocks
+        /// compress worse.
+        unsigned getBlockSize() const             { return blockSize; }
+        void setBlockSize(unsigned kb)            { blockSize = kb; }
+
         void create(const std::string& fname, ArticleSource& src);
     };
 
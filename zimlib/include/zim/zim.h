@@ -123,6 +123,10 @@ namespace zim
     zimcompLzma
   };
 
+  /// Set in the compression byte of a cluster, which is compressed in
+  /// independent blocks instead of a single stream.
+  static const char zimcompBlocks = 0x10;
+
   static const char MimeHtmlTemplate[] = "text/x-zim-htmltemplate";
 }
 
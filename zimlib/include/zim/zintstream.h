@@ -94,5 +94,27 @@ namespace zim
               && (_ostream == 0 || *_ostream); }
   };
 
+  /// Writes value zint compressed to out, which needs room for 5 bytes.
+  /// Returns a pointer past the last written byte.
+  char* encodeZInt(char* out, size_type value);
+
+  /// Returns the number of bytes needed for value zint compressed.
+  unsigned zintSize(size_type value);
+
+  /**
+     Decodes all zint compressed values in the range [begin, end) into out,
+     which must have room for end - begin values. Returns the number of
+     decoded values. Throws std::runtime_error, when the data is invalid.
+
+     This is much faster than reading the values one by one from a
+     ZIntStream. Groups of short values are decoded with SSE4.1 when the
+     processor supports it.
+   */
+  size_type decodeZInts(const char* begin, const char* end, size_type* out);
+
+  /// Decodes count zint compressed values starting at begin into out and
+  /// returns a pointer past the last decoded byte.
+  const char* decodeZInts(const char* begin, const char* end, size_type* out, size_type count);
+
 }
 #endif  //  ZIM_ZINTSTREAM_H
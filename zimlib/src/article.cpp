@@ -31,8 +31,7 @@ namespace zim
   size_type Article::getArticleSize() const
   {
     Dirent dirent = getDirent();
-    return file.getCluster(dirent.getClusterNumber())
-               .getBlobSize(dirent.getBlobNumber());
+    return file.getBlobSize(dirent.getClusterNumber(), dirent.getBlobNumber());
   }
 
   namespace
@@ -21,32 +21,15 @@
 
 namespace zim
 {
-  ArticleSearch::Results ArticleSearch::search(const std::string& expr)
+  ArticleSearch::Results ArticleSearch::search(const std::string& expr, size_type limit)
   {
-    Results ret;
-
-  // TODO: implement title-cache
-#if 0
-    if (titles.empty())
-    {
-      for (File::const_iterator it = articleFile.begin(); it != articleFile.end(); ++it)
-      {
-        if (article.isMainArticle()
-          && article.getLibraryMimeType() == zim::Dirent::zimMimeTextHtml
-          && article.getNamespace() == 'A')
-        {
-          titles.push_back(article.getTitle());
-        }
-      }
-    }
-#endif
+    TitleIndex::Results indexes;
+    articleFile.getTitleIndex(ns).search(expr, indexes, limit);
 
-    for (File::const_iterator it = articleFile.begin(); it != articleFile.end(); ++it)
-    {
-      std::string title = it->getTitle();
-      if (title.find(expr) != std::string::npos)
-        ret.push_back(*it);
-    }
+    Results ret;
+    ret.reserve(indexes.size());
+    for (TitleIndex::Results::const_iterator it = indexes.begin(); it != indexes.end(); ++it)
+      ret.push_back(articleFile.getArticle(*it));
     return ret;
   }
 }
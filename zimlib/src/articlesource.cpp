@@ -18,6 +18,7 @@
  */
 
 #include <zim/writer/articlesource.h>
+#include <zim/blob.h>
 
 namespace zim
 {
@@ -63,11 +64,31 @@ namespace zim
       return std::string();
     }
 
+    bool Article::hasData() const
+    {
+      return false;
+    }
+
+    Blob Article::getData() const
+    {
+      return Blob();
+    }
+
+    std::string Article::getClusterHint() const
+    {
+      return std::string();
+    }
+
     std::string Article::getNextCategory()
     {
       return std::string();
     }
 
+    bool ArticleSource::takeData(const std::string& /*aid*/, ArticleData& /*data*/)
+    {
+      return false;
+    }
+
     Uuid ArticleSource::getUuid()
     {
       return Uuid::generate();
@@ -0,0 +1,163 @@
+/*
+ * Copyright (C) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * is provided AS IS, WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, and
+ * NON-INFRINGEMENT.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ */
+
+#include <zim/autocomplete.h>
+#include <algorithm>
+#include "log.h"
+
+log_define("zim.autocomplete")
+
+namespace zim
+{
+  namespace
+  {
+    template <typename EntryType>
+    class KeyLess
+    {
+      public:
+        bool operator() (const EntryType& e1, const EntryType& e2) const
+          { return e1.key < e2.key; }
+    };
+
+    // orders the entries of a prefix group, most popular first
+    template <typename EntryType>
+    class PopularityLess
+    {
+        const std::vector<EntryType>& entries;
+
+      public:
+        explicit PopularityLess(const std::vector<EntryType>& entries_)
+          : entries(entries_)
+          { }
+
+        bool operator() (size_type n1, size_type n2) const
+        {
+          const EntryType& e1 = entries[n1];
+          const EntryType& e2 = entries[n2];
+          return e1.score > e2.score
+              || (e1.score == e2.score && (e1.length < e2.length
+              || (e1.length == e2.length && e1.idx < e2.idx)));
+        }
+    };
+
+    typedef std::pair<std::string, size_type> PrefixGroupType;  // prefix, group
+
+  }
+
+  void Autocomplete::add(const std::string& title, size_type idx, size_type score)
+  {
+    EntryType e;
+    e.key = title.substr(0, maxPrefixLength);
+    e.length = title.size();
+    e.idx = idx;
+    e.score = score;
+    entries.push_back(e);
+  }
+
+  void Autocomplete::build()
+  {
+    log_debug("build completions of " << entries.size() << " titles");
+
+    // titles with a common prefix are adjacent in key order
+    std::stable_sort(entries.begin(), entries.end(), KeyLess<EntryType>());
+
+    std::vector<PrefixGroupType> groups;
+    std::vector<std::vector<size_type> > groupCompletions;
+    std::vector<size_type> group;
+    PopularityLess<EntryType> popularityLess(entries);
+
+    for (unsigned len = 1; len <= maxPrefixLength; ++len)
+    {
+      size_type n = 0;
+      while (n < entries.size())
+      {
+        if (entries[n].key.size() < len)
+        {
+          ++n;
+          continue;
+        }
+
+        group.clear();
+        const std::string& key = entries[n].key;
+        size_type e = n;
+        for ( ; e < entries.size() && entries[e].key.size() >= len
+                && entries[e].key.compare(0, len, key, 0, len) == 0; ++e)
+          group.push_back(e);
+
+        size_type count = std::min(static_cast<size_type>(group.size()), static_cast<size_type>(k));
+        std::partial_sort(group.begin(), group.begin() + count, group.end(), popularityLess);
+
+        groups.push_back(PrefixGroupType(key.substr(0, len), groupCompletions.size()));
+        groupCompletions.push_back(std::vector<size_type>());
+        std::vector<size_type>& c = groupCompletions.back();
+        for (size_type i = 0; i < count; ++i)
+          c.push_back(entries[group[i]].idx);
+
+        n = e;
+      }
+    }
+
+    std::sort(groups.begin(), groups.end());
+
+    prefixes.clear();
+    starts.clear();
+    completions.clear();
+    prefixes.reserve(groups.size());
+    starts.reserve(groups.size() + 1);
+    for (std::vector<PrefixGroupType>::const_iterator it = groups.begin(); it != groups.end(); ++it)
+    {
+      prefixes.push_back(it->first);
+      starts.push_back(completions.size());
+      const std::vector<size_type>& c = groupCompletions[it->second];
+      completions.insert(completions.end(), c.begin(), c.end());
+    }
+    starts.push_back(completions.size());
+
+    std::vector<EntryType>().swap(entries);
+
+    log_debug(prefixes.size() << " prefixes with " << completions.size() << " completions in " << getMemoryUsage() << " bytes");
+  }
+
+  size_type Autocomplete::getMemoryUsage() const
+  {
+    size_type size = sizeof(*this)
+                   + prefixes.capacity() * sizeof(std::string)
+                   + starts.capacity() * sizeof(size_type)
+                   + completions.capacity() * sizeof(size_type);
+    for (std::vector<std::string>::const_iterator it = prefixes.begin(); it != prefixes.end(); ++it)
+      size += it->capacity();
+    return size;
+  }
+
+  bool Autocomplete::find(const std::string& prefix, Results& results, unsigned limit) const
+  {
+    if (!covers(prefix))
+      return false;
+
+    std::vector<std::string>::const_iterator it = std::lower_bound(prefixes.begin(), prefixes.end(), prefix);
+    if (it == prefixes.end() || *it != prefix)
+      return true;
+
+    size_type p = it - prefixes.begin();
+    size_type end = std::min(starts[p + 1], starts[p] + limit);
+    results.insert(results.end(), completions.begin() + starts[p], completions.begin() + end);
+    return true;
+  }
+
+}
@@ -20,8 +20,11 @@
 #include <zim/cluster.h>
 #include <zim/blob.h>
 #include <zim/endian.h>
+#include "clusterblocks.h"
+#include "ptrstream.h"
 #include <stdlib.h>
 #include <sstream>
+#include <algorithm>
 
 #include "log.h"
 
@@ -48,6 +51,112 @@ log_define("zim.cluster")
 
 namespace zim
 {
+  namespace
+  {
+#ifdef ENABLE_LZMA
+    /**
+     * read lzma preset from environment
+     * ZIM_LZMA_LEVEL is a number followed optionally by a
+     * suffix 'e'. The number gives the preset and the suffix tells,
+     * if LZMA_PRESET_EXTREME should be set.
+     * e.g.:
+     *   ZIM_LZMA_LEVEL=9   => 9
+     *   ZIM_LZMA_LEVEL=3e  => 3 + extreme
+     */
+    uint32_t getLzmaPreset()
+    {
+      uint32_t lzmaPreset = 3 | LZMA_PRESET_EXTREME;
+      const char* e = ::getenv("ZIM_LZMA_LEVEL");
+      if (e)
+      {
+        char flag = '\0';
+        std::istringstream s(e);
+        s >> lzmaPreset >> flag;
+        if (flag == 'e')
+          lzmaPreset |= LZMA_PRESET_EXTREME;
+      }
+      return lzmaPreset;
+    }
+
+    // the environment is read, when the first cluster is written, and not
+    // for every cluster
+    uint32_t defaultLzmaPreset()
+    {
+      static const uint32_t preset = getLzmaPreset();
+      return preset;
+    }
+
+    uint32_t lzmaPreset(int level)
+    {
+      return level < 0 ? defaultLzmaPreset() : static_cast<uint32_t>(level);
+    }
+#endif
+
+#ifdef ENABLE_ZLIB
+    int zlibLevel(int level)
+    {
+      return level < 0 ? Z_DEFAULT_COMPRESSION : level;
+    }
+#endif
+
+#ifdef ENABLE_BZIP2
+    int bzip2BlockSize(int level)
+    {
+      return level < 1 ? 9 : std::min(level, 9);
+    }
+#endif
+
+    // compresses size bytes of data as one stream
+    void compressBlock(std::ostream& out, CompressionType compression, int level,
+                       const char* data, size_type size)
+    {
+      switch (compression)
+      {
+        case zimcompZip:
+          {
+#ifdef ENABLE_ZLIB
+            zim::DeflateStream os(out, zlibLevel(level));
+            os.exceptions(std::ios::failbit | std::ios::badbit);
+            os.write(data, size);
+            os.end();
+#else
+            throw std::runtime_error("zlib not enabled in this library");
+#endif
+            break;
+          }
+
+        case zimcompBzip2:
+          {
+#ifdef ENABLE_BZIP2
+            zim::Bzip2Stream os(out, bzip2BlockSize(level));
+            os.exceptions(std::ios::failbit | std::ios::badbit);
+            os.write(data, size);
+            os.end();
+#else
+            throw std::runtime_error("bzip2 not enabled in this library");
+#endif
+            break;
+          }
+
+        case zimcompLzma:
+          {
+#ifdef ENABLE_LZMA
+            zim::LzmaStream os(out, lzmaPreset(level));
+            os.exceptions(std::ios::failbit | std::ios::badbit);
+            os.write(data, size);
+            os.end();
+#else
+            throw std::runtime_error("lzma not enabled in this library");
+#endif
+            break;
+          }
+
+        default:
+          throw std::runtime_error("invalid compression of cluster block");
+      }
+    }
+  }
+
   Cluster::Cluster()
     : impl(0)
     { }
@@ -60,7 +169,9 @@ namespace zim
   }
 
   ClusterImpl::ClusterImpl()
-    : compression(zimcompDefault)
+    : compression(zimcompDefault),
+      compressionLevel(-1),
+      blockSize(0)
   {
     offsets.push_back(0);
   }
@@ -158,6 +269,24 @@ namespace zim
     addBlob(Blob(data, size));
   }
 
+  char* ClusterImpl::resizeBlob(size_type size)
+  {
+    log_debug1("resizeBlob(" << size << ')');
+    offsets.clear();
+    offsets.push_back(0);
+    offsets.push_back(size);
+    data.resize(size);
+    return size > 0 ? &(data[0]) : 0;
+  }
+
+  void ClusterImpl::readBlob(std::istream& in, size_type size)
+  {
+    log_debug1("readBlob(" << size << ')');
+    char* p = resizeBlob(size);
+    if (size > 0)
+      in.read(p, size);
+  }
+
   Blob Cluster::getBlob(size_type n) const
   {
     return impl->getBlob(n);
@@ -169,6 +298,35 @@ namespace zim
 
     char c;
     in.get(c);
+
+    if (c & zimcompBlocks)
+    {
+      ClusterBlocks blocks;
+      blocks.readIndex(in, static_cast<CompressionType>(c & ~zimcompBlocks));
+      if (in.fail())
+        return in;
+
+      log_debug("uncompress " << blocks.getCount() << " blocks");
+      std::vector<char> data;
+      blocks.readBlocks(in, data);
+      if (in.fail())
+        return in;
+      if (data.empty())
+      {
+        log_error("empty cluster compressed in blocks");
+        in.setstate(std::ios::failbit);
+        return in;
+      }
+
+      ptrstream is(&data[0], &data[0] + data.size());
+      clusterImpl.read(is);
+      if (is.fail())
+        in.setstate(std::ios::failbit);
+      clusterImpl.setCompression(blocks.getCompression());
+      clusterImpl.setBlockSize(blocks.getBlockSize());
+      return in;
+    }
+
     clusterImpl.setCompression(static_cast<CompressionType>(c));
 
     switch (static_cast<CompressionType>(c))
@@ -235,6 +393,32 @@ namespace zim
   {
     log_trace("write cluster");
 
+    size_type blockSize = clusterImpl.getBlockSize();
+    if (clusterImpl.isCompressed() && blockSize > 0 && clusterImpl.getSize() > blockSize)
+    {
+      std::ostringstream u;
+      clusterImpl.write(u);
+      std::string data = u.str();
+
+      ClusterBlocks blocks(clusterImpl.getCompression(), blockSize, data.size());
+      std::vector<std::string> compressed;
+      for (size_type pos = 0; pos < data.size(); pos += blockSize)
+      {
+        std::ostringstream b;
+        compressBlock(b, clusterImpl.getCompression(), clusterImpl.getCompressionLevel(),
+                      data.data() + pos, std::min(blockSize, static_cast<size_type>(data.size() - pos)));
+        compressed.push_back(b.str());
+        blocks.addBlock(compressed.back().size());
+      }
+
+      log_debug("compressed " << data.size() << " bytes in " << blocks.getCount() << " blocks");
+      out.put(static_cast<char>(clusterImpl.getCompression() | zimcompBlocks));
+      blocks.writeIndex(out);
+      for (std::vector<std::string>::const_iterator it = compressed.begin(); it != compressed.end(); ++it)
+        out.write(it->data(), it->size());
+      return out;
+    }
+
     out.put(static_cast<char>(clusterImpl.getCompression()));
 
     switch(clusterImpl.getCompression())
@@ -248,10 +432,10 @@ namespace zim
         {
 #ifdef ENABLE_ZLIB
           log_debug("compress data (zlib)");
-          zim::DeflateStream os(out);
+          zim::DeflateStream os(out, zlibLevel(clusterImpl.getCompressionLevel()));
           os.exceptions(std::ios::failbit | std::ios::badbit);
           clusterImpl.write(os);
-          os.flush();
+          os.end();
 #else
           throw std::runtime_error("zlib not enabled in this library");
 #endif
@@ -262,7 +446,7 @@ namespace zim
         {
 #ifdef ENABLE_BZIP2
           log_debug("compress data (bzip2)");
-          zim::Bzip2Stream os(out);
+          zim::Bzip2Stream os(out, bzip2BlockSize(clusterImpl.getCompressionLevel()));
           os.exceptions(std::ios::failbit | std::ios::badbit);
           clusterImpl.write(os);
           os.end();
@@ -275,28 +459,9 @@ namespace zim
       case zimcompLzma:
         {
 #ifdef ENABLE_LZMA
-          uint32_t lzmaPreset = 3 | LZMA_PRESET_EXTREME;
-          /**
-           * read lzma preset from environment
-           * ZIM_LZMA_PRESET is a number followed optionally by a
-           * suffix 'e'. The number gives the preset and the suffix tells,
-           * if LZMA_PRESET_EXTREME should be set.
-           * e.g.:
-           *   ZIM_LZMA_LEVEL=9   => 9
-           *   ZIM_LZMA_LEVEL=3e  => 3 + extreme
-           */
-          const char* e = ::getenv("ZIM_LZMA_LEVEL");
-          if (e)
-          {
-            char flag = '\0';
-            std::istringstream s(e);
-            s >> lzmaPreset >> flag;
-            if (flag == 'e')
-              lzmaPreset |= LZMA_PRESET_EXTREME;
-          }
-
-          log_debug("compress data (lzma, " << std::hex << lzmaPreset << ")");
-          zim::LzmaStream os(out, lzmaPreset);
+          uint32_t preset = lzmaPreset(clusterImpl.getCompressionLevel());
+          log_debug("compress data (lzma, " << std::hex << preset << ")");
+          zim::LzmaStream os(out, preset);
           os.exceptions(std::ios::failbit | std::ios::badbit);
           clusterImpl.write(os);
           os.end();
@@ -0,0 +1,300 @@
+/*
+ * Copyright (C) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * is provided AS IS, WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, and
+ * NON-INFRINGEMENT.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ */
+
+#include "clusterblocks.h"
+#include "envvalue.h"
+#include "mutex.h"
+#include "ptrstream.h"
+#include "threadpool.h"
+#include <zim/endian.h>
+#include <zim/error.h>
+#include <algorithm>
+#include "log.h"
+
+#include "config.h"
+
+#ifdef ENABLE_ZLIB
+#include <zim/inflatestream.h>
+#endif
+
+#ifdef ENABLE_BZIP2
+#include <zim/bunzip2stream.h>
+#endif
+
+#ifdef ENABLE_LZMA
+#include <zim/unlzmastream.h>
+#endif
+
+log_define("zim.cluster.blocks")
+
+namespace zim
+{
+  namespace
+  {
+    void writeNumber(std::ostream& out, size_type n)
+    {
+      n = fromLittleEndian(&n);
+      out.write(reinterpret_cast<const char*>(&n), sizeof(n));
+    }
+
+    bool readNumber(std::istream& in, size_type& n)
+    {
+      in.read(reinterpret_cast<char*>(&n), sizeof(n));
+      n = fromLittleEndian(&n);
+      return !in.fail();
+    }
+
+    template <typename DecompressStream>
+    void decompressStream(const char* data, size_type size, char* out, size_type outSize)
+    {
+      ptrstream in(const_cast<char*>(data), const_cast<char*>(data + size));
+      DecompressStream is(in);
+      is.read(out, outSize);
+      if (static_cast<size_type>(is.gcount()) != outSize)
+        throw ZimFileFormatError("error decompressing cluster block");
+    }
+
+    // Clusters with fewer blocks are decompressed in the calling thread.
+    const size_type minParallelBlocks = 4;
+
+    pthread_once_t poolOnce = PTHREAD_ONCE_INIT;
+    ThreadPool* pool = 0;
+
+    // The pool is shared by all readers of the process and lives until it
+    // ends, so that reading a cluster does not start any threads.
+    void createPool()
+    {
+      unsigned threads = envValue("ZIM_DECOMPRESS_THREADS", 4);
+      if (threads <= 1)
+        return;
+
+      try
+      {
+        pool = new ThreadPool(threads);
+      }
+      catch (const std::exception& e)
+      {
+        log_warn("decompress blocks without threads: " << e.what());
+      }
+    }
+
+    ThreadPool* decompressPool()
+    {
+      pthread_once(&poolOnce, createPool);
+      return pool;
+    }
+
+    // counts the tasks of one cluster, which are not finished yet
+    class TaskCount
+    {
+        Mutex mutex;
+        Condition finished;
+        size_type count;
+
+      public:
+        explicit TaskCount(size_type count_)
+          : count(count_)
+          { }
+
+        void done()
+        {
+          MutexLock lock(mutex);
+          if (--count == 0)
+            finished.signal();
+        }
+
+        void wait()
+        {
+          MutexLock lock(mutex);
+          while (count > 0)
+            finished.wait(mutex);
+        }
+    };
+
+    class DecompressTask : public ThreadPool::Task
+    {
+        const ClusterBlocks& blocks;
+        size_type n;
+        const char* data;
+        char* out;
+        std::string& error;
+        TaskCount& count;
+
+      public:
+        DecompressTask(const ClusterBlocks& blocks_, size_type n_,
+                       const char* data_, char* out_, std::string& error_,
+                       TaskCount& count_)
+          : blocks(blocks_),
+            n(n_),
+            data(data_),
+            out(out_),
+            error(error_),
+            count(count_)
+          { }
+
+        void run()
+        {
+          try
+          {
+            blocks.decompress(n, data, out);
+          }
+          catch (const std::exception& e)
+          {
+            error = e.what();
+          }
+          count.done();
+        }
+    };
+  }
+
+  void ClusterBlocks::writeIndex(std::ostream& out) const
+  {
+    writeNumber(out, blockSize);
+    writeNumber(out, size);
+    for (std::vector<size_type>::const_iterator it = ends.begin(); it != ends.end(); ++it)
+      writeNumber(out, *it);
+  }
+
+  void ClusterBlocks::readIndex(std::istream& in, CompressionType compression_)
+  {
+    compression = compression_;
+    ends.clear();
+
+    if (!readNumber(in, blockSize) || !readNumber(in, size))
+      return;
+
+    if (blockSize == 0)
+    {
+      log_error("invalid block size 0");
+      in.setstate(std::ios::failbit);
+      return;
+    }
+
+    size_type count = size == 0 ? 0 : (size - 1) / blockSize + 1;
+    log_debug("cluster of " << size << " bytes in " << count << " blocks of " << blockSize << " bytes");
+
+    // The ends are read in chunks instead of one by one, so that the stream
+    // does not need a buffer for them, but a damaged count does not
+    // allocate more than the file has.
+    const size_type chunk = 1024;
+    while (ends.size() < count)
+    {
+      size_type begin = ends.size();
+      ends.resize(std::min(count, begin + chunk));
+      in.read(reinterpret_cast<char*>(&ends[begin]), (ends.size() - begin) * sizeof(size_type));
+      if (in.fail())
+      {
+        ends.clear();
+        return;
+      }
+
+      for (size_type n = begin; n < ends.size(); ++n)
+      {
+        ends[n] = fromLittleEndian(&ends[n]);
+        if (ends[n] < getBlockBegin(n))
+        {
+          log_error("invalid end " << ends[n] << " of block " << n);
+          in.setstate(std::ios::failbit);
+          return;
+        }
+      }
+    }
+  }
+
+  void ClusterBlocks::decompress(size_type n, const char* data, char* out) const
+  {
+    size_type size = getBlockEnd(n) - getBlockBegin(n);
+    size_type outSize = getUncompressedSize(n);
+
+    switch (compression)
+    {
+      case zimcompZip:
+#ifdef ENABLE_ZLIB
+        decompressStream<InflateStream>(data, size, out, outSize);
+#else
+        throw std::runtime_error("zlib not enabled in this library");
+#endif
+        break;
+
+      case zimcompBzip2:
+#ifdef ENABLE_BZIP2
+        decompressStream<Bunzip2Stream>(data, size, out, outSize);
+#else
+        throw std::runtime_error("bzip2 not enabled in this library");
+#endif
+        break;
+
+      case zimcompLzma:
+#ifdef ENABLE_LZMA
+        decompressStream<UnlzmaStream>(data, size, out, outSize);
+#else
+        throw std::runtime_error("lzma not enabled in this library");
+#endif
+        break;
+
+      default:
+        throw ZimFileFormatError("invalid compression of cluster block");
+    }
+  }
+
+  void ClusterBlocks::readBlocks(std::istream& in, std::vector<char>& data) const
+  {
+    std::vector<char> compressed(ends.empty() ? 0 : ends.back());
+    if (!compressed.empty())
+      in.read(&compressed[0], compressed.size());
+    if (in.fail())
+      return;
+
+    data.resize(size);
+    if (size == 0)
+      return;
+
+    ThreadPool* pool = ends.size() < minParallelBlocks ? 0 : decompressPool();
+    if (!pool)
+    {
+      for (size_type n = 0; n < ends.size(); ++n)
+        decompress(n, &compressed[getBlockBegin(n)], &data[n * blockSize]);
+      return;
+    }
+
+    log_debug("decompress " << ends.size() << " blocks in " << pool->size() << " threads");
+
+    // the calling thread decompresses the first block itself
+    std::vector<std::string> errors(ends.size());
+    TaskCount count(ends.size() - 1);
+    for (size_type n = 1; n < ends.size(); ++n)
+      pool->add(new DecompressTask(*this, n, &compressed[getBlockBegin(n)],
+                                   &data[n * blockSize], errors[n], count));
+
+    try
+    {
+      decompress(0, &compressed[0], &data[0]);
+    }
+    catch (const std::exception& e)
+    {
+      errors[0] = e.what();
+    }
+    count.wait();
+
+    for (std::vector<std::string>::const_iterator it = errors.begin(); it != errors.end(); ++it)
+      if (!it->empty())
+        throw ZimFileFormatError(*it);
+  }
+
+}
@@ -0,0 +1,104 @@
+/*
+ * Copyright (C) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * is provided AS IS, WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, and
+ * NON-INFRINGEMENT.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ */
+
+#ifndef ZIM_CLUSTERBLOCKS_H
+#define ZIM_CLUSTERBLOCKS_H
+
+#include <zim/zim.h>
+#include <iosfwd>
+#include <vector>
+
+namespace zim
+{
+  /**
+     Index of a cluster, which is compressed in independent blocks.
+
+     The compression byte of such a cluster has zimcompBlocks set. It is
+     followed by the block size, the size of the uncompressed cluster and
+     the end of each compressed block, counted from the start of the first
+     block, all as 32 bit little endian numbers. Then come the blocks.
+
+     The uncompressed cluster - the offsets followed by the blob data, as
+     in a cluster without compression - is cut into pieces of the block
+     size, the last one maybe shorter, and each piece is compressed on its
+     own. So a reader may decompress just the blocks covering a blob or
+     all blocks in parallel.
+   */
+  class ClusterBlocks
+  {
+      CompressionType compression;
+      size_type blockSize;
+      size_type size;
+      std::vector<size_type> ends;
+
+    public:
+      ClusterBlocks()
+        : compression(zimcompNone),
+          blockSize(0),
+          size(0)
+        { }
+
+      ClusterBlocks(CompressionType compression_, size_type blockSize_, size_type size_)
+        : compression(compression_),
+          blockSize(blockSize_),
+          size(size_)
+        { }
+
+      CompressionType getCompression() const  { return compression; }
+      size_type getBlockSize() const          { return blockSize; }
+      /// Returns the size of the uncompressed cluster.
+      size_type getSize() const               { return size; }
+      size_type getCount() const              { return ends.size(); }
+
+      /// Returns the number of bytes following the compression byte up to
+      /// the first block.
+      size_type getIndexSize() const
+        { return (2 + ends.size()) * sizeof(size_type); }
+
+      /// Returns the start and end of the compressed block n counted from
+      /// the first block.
+      size_type getBlockBegin(size_type n) const  { return n == 0 ? 0 : ends[n - 1]; }
+      size_type getBlockEnd(size_type n) const    { return ends[n]; }
+
+      /// Returns the number of bytes of the uncompressed cluster in block n.
+      size_type getUncompressedSize(size_type n) const
+        { return n + 1 < ends.size() ? blockSize : size - n * blockSize; }
+
+      /// Appends a block of compressedSize bytes to the index.
+      void addBlock(size_type compressedSize)
+        { ends.push_back(getBlockBegin(ends.size()) + compressedSize); }
+
+      /// Writes the index without the compression byte.
+      void writeIndex(std::ostream& out) const;
+      /// Reads the index, which follows the compression byte. The failbit
+      /// of in is set, when it is not valid.
+      void readIndex(std::istream& in, CompressionType compression);
+
+      /// Decompresses block n from the compressed data into out, which
+      /// needs room for getUncompressedSize(n) bytes.
+      void decompress(size_type n, const char* data, char* out) const;
+
+      /// Reads the blocks following the index from in and decompresses
+      /// them into data. The blocks of larger clusters are decompressed in
+      /// parallel by ZIM_DECOMPRESS_THREADS threads shared by all readers.
+      void readBlocks(std::istream& in, std::vector<char>& data) const;
+  };
+}
+
+#endif // ZIM_CLUSTERBLOCKS_H
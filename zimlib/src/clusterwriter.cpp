@@ -0,0 +1,248 @@
+/*
+ * Copyright (C) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * is provided AS IS, WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, and
+ * NON-INFRINGEMENT.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ */
+
+#include "clusterwriter.h"
+#include "threadpool.h"
+#include "codecselector.h"
+#include "filerange.h"
+#include <zim/cluster.h>
+#include <zim/endian.h>
+#include <sstream>
+#include <algorithm>
+#include <stdexcept>
+#include <fcntl.h>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+#include "log.h"
+
+log_define("zim.writer.clusterwriter")
+
+namespace zim
+{
+  namespace writer
+  {
+    class ClusterWriter::CompressTask : public ThreadPool::Task
+    {
+        ClusterWriter& writer;
+        size_type n;
+        Cluster cluster;
+
+      public:
+        CompressTask(ClusterWriter& writer_, size_type n_, const Cluster& cluster_)
+          : writer(writer_),
+            n(n_),
+            cluster(cluster_)
+          { }
+
+        void run()
+        {
+          try
+          {
+            std::ostringstream data;
+            writer.compress(cluster, data);
+            if (!data)
+              throw std::runtime_error("failed to compress cluster");
+            cluster.clear();
+
+            std::string s = data.str();
+            writer.finished(n, s);
+          }
+          catch (const std::exception& e)
+          {
+            writer.failed(e.what());
+          }
+        }
+    };
+
+    ClusterWriter::ClusterWriter(std::ostream& out_, std::vector<offset_type>& offsets_,
+                                 unsigned threads, unsigned maxInFlight_)
+      : out(out_),
+        offsets(offsets_),
+        pool(0),
+        selector(0),
+        maxInFlight(maxInFlight_ > 0 ? maxInFlight_ : 2 * threads),
+        outFd(-1),
+        added(0),
+        written(0)
+    {
+      if (threads > 0)
+      {
+        pool = new ThreadPool(threads);
+        log_debug("compress clusters with " << pool->size() << " threads, max " << maxInFlight << " clusters in flight");
+      }
+    }
+
+    ClusterWriter::~ClusterWriter()
+    {
+      delete pool;
+      if (outFd >= 0)
+        ::close(outFd);
+    }
+
+    void ClusterWriter::setOutputFile(const std::string& fname)
+    {
+      if (outFd >= 0)
+        ::close(outFd);
+      outFd = openFile(fname, O_WRONLY);
+      if (outFd < 0)
+      {
+        log_warn("failed to open \"" << fname << "\"; copy file clusters through the stream");
+      }
+    }
+
+    unsigned ClusterWriter::getCountThreads() const
+    {
+      return pool ? pool->size() : 0;
+    }
+
+    void ClusterWriter::finished(size_type n, std::string& data)
+    {
+      MutexLock lock(mutex);
+      results[n].swap(data);
+      compressed.signal();
+    }
+
+    void ClusterWriter::failed(const std::string& msg)
+    {
+      MutexLock lock(mutex);
+      if (error.empty())
+        error = msg;
+      compressed.signal();
+    }
+
+    void ClusterWriter::writeCompressed(size_type count)
+    {
+      // writes the compressed clusters in order until at least count
+      // clusters are written; clusters already compressed are written too
+      while (true)
+      {
+        FileClustersType::iterator f = fileClusters.find(written);
+        if (f != fileClusters.end())
+        {
+          writeFile(f->second);
+          fileClusters.erase(f);
+          ++written;
+          continue;
+        }
+
+        std::string data;
+
+        {
+          MutexLock lock(mutex);
+          if (!error.empty())
+            throw std::runtime_error(error);
+
+          ResultsType::iterator it = results.find(written);
+          if (it == results.end())
+          {
+            if (written >= count)
+              return;
+            compressed.wait(mutex);
+            continue;
+          }
+
+          data.swap(it->second);
+          results.erase(it);
+        }
+
+        offsets.push_back(out.tellp());
+        out.write(data.data(), data.size());
+        ++written;
+      }
+    }
+
+    void ClusterWriter::compress(Cluster& cluster, std::ostream& data)
+    {
+      if (selector && cluster.isCompressed())
+        selector->select(cluster);
+      data << cluster;
+    }
+
+    void ClusterWriter::writeFile(const FileCluster& file)
+    {
+      log_debug("write file cluster of " << file.size << " bytes from \"" << file.fname << '"');
+
+      offsets.push_back(out.tellp());
+      out.put(static_cast<char>(zimcompNone));
+
+      size_type o[2];
+      o[0] = 2 * sizeof(size_type);
+      o[1] = o[0] + file.size;
+      o[0] = fromLittleEndian(&o[0]);
+      o[1] = fromLittleEndian(&o[1]);
+      out.write(reinterpret_cast<const char*>(o), sizeof(o));
+
+      copyFileRange(file.fname, file.offset, file.size, out, outFd);
+    }
+
+    void ClusterWriter::add(const Cluster& cluster)
+    {
+      if (pool == 0)
+      {
+        offsets.push_back(out.tellp());
+        Cluster c(cluster);
+        compress(c, out);
+        ++added;
+        ++written;
+        return;
+      }
+
+      writeCompressed(added >= maxInFlight ? added + 1 - maxInFlight : 0);
+      pool->add(new CompressTask(*this, added, cluster));
+      ++added;
+    }
+
+    void ClusterWriter::addFile(const std::string& fname, offset_type offset, size_type size)
+    {
+      FileCluster file;
+      file.fname = fname;
+      file.offset = offset;
+      file.size = size;
+
+      if (pool == 0)
+      {
+        writeFile(file);
+        ++added;
+        ++written;
+        return;
+      }
+
+      // nothing is compressed, so the cluster is just queued in order
+      fileClusters[added] = file;
+      ++added;
+    }
+
+    void ClusterWriter::flush()
+    {
+      if (pool)
+        writeCompressed(added);
+    }
+
+    void ClusterWriter::flush(size_type count)
+    {
+      if (pool)
+        writeCompressed(std::min(count, added));
+    }
+
+  }
+}
@@ -0,0 +1,124 @@
+/*
+ * Copyright (C) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * is provided AS IS, WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, and
+ * NON-INFRINGEMENT.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ */
+
+#ifndef ZIM_CLUSTERWRITER_H
+#define ZIM_CLUSTERWRITER_H
+
+#include <zim/zim.h>
+#include <zim/noncopyable.h>
+#include "mutex.h"
+#include <iosfwd>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace zim
+{
+  class Cluster;
+  class ThreadPool;
+
+  namespace writer
+  {
+    class CodecSelector;
+
+    /**
+       Writes clusters to a stream and records their offsets.
+
+       With threads > 0, the clusters are compressed by a thread pool while
+       the caller assembles the next ones. The compressed clusters are
+       written in the order, in which they were added, so the output does
+       not depend on the number of threads. Not more than maxInFlight
+       clusters are queued or waiting to be written; add() blocks until
+       there is room for another one.
+
+       With a CodecSelector, the compression of each compressed cluster is
+       chosen, when the cluster is compressed.
+
+       A blob may also be added as a range of a file. It is written as an
+       uncompressed cluster of its own, copying the bytes from the file,
+       when it is the cluster's turn.
+     */
+    class ClusterWriter : private NonCopyable
+    {
+        class CompressTask;
+        friend class CompressTask;
+
+        typedef std::map<size_type, std::string> ResultsType;  // cluster number => compressed cluster
+
+        struct FileCluster
+        {
+          std::string fname;
+          offset_type offset;
+          size_type size;
+        };
+        typedef std::map<size_type, FileCluster> FileClustersType;
+
+        std::ostream& out;
+        std::vector<offset_type>& offsets;
+        ThreadPool* pool;
+        CodecSelector* selector;
+        unsigned maxInFlight;
+        int outFd;
+        FileClustersType fileClusters;
+        size_type added;
+        size_type written;
+
+        Mutex mutex;
+        Condition compressed;
+        ResultsType results;
+        std::string error;
+
+        void finished(size_type n, std::string& data);
+        void failed(const std::string& msg);
+        void writeCompressed(size_type count);
+        void compress(Cluster& cluster, std::ostream& out);
+        void writeFile(const FileCluster& file);
+
+      public:
+        ClusterWriter(std::ostream& out, std::vector<offset_type>& offsets,
+                      unsigned threads, unsigned maxInFlight = 0);
+        /// Waits for the running compressions without writing the results.
+        ~ClusterWriter();
+
+        /// Sets the selector, which chooses the compression of clusters,
+        /// which are not stored uncompressed. 0 keeps their compression.
+        void setCodecSelector(CodecSelector* s)   { selector = s; }
+        /// Opens the file written by the output stream, so that the data of
+        /// file clusters is copied by the kernel where possible.
+        void setOutputFile(const std::string& fname);
+
+        /// Queues a cluster. The cluster must not be modified afterwards.
+        void add(const Cluster& cluster);
+        /// Queues an uncompressed cluster with a single blob, which is size
+        /// bytes of file fname starting at offset.
+        void addFile(const std::string& fname, offset_type offset, size_type size);
+        /// Writes all added clusters.
+        void flush();
+        /// Writes the added clusters until count clusters are written.
+        void flush(size_type count);
+
+        /// Returns the number of clusters added, which is also the number
+        /// of the next cluster.
+        size_type count() const    { return added; }
+        unsigned getCountThreads() const;
+    };
+  }
+}
+
+#endif // ZIM_CLUSTERWRITER_H
@@ -0,0 +1,236 @@
+/*
+ * Copyright (C) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * is provided AS IS, WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, and
+ * NON-INFRINGEMENT.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ */
+
+#include "codecselector.h"
+#include <zim/cluster.h>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <time.h>
+#include "config.h"
+#include "log.h"
+
+log_define("zim.writer.codecselector")
+
+namespace zim
+{
+  namespace writer
+  {
+    namespace
+    {
+      // clusters shrinking by less are not compressed
+      const double minRatio = 1.05;
+      // a faster decompressing candidate may be that much larger
+      const double sizeTolerance = 1.02;
+      const unsigned countSlices = 4;
+    }
+
+    const size_type CodecSelector::defaultSampleSize;
+
+    CodecSelector::CodecSelector(double minDecodeSpeed_, double budget_, size_type sampleSize_)
+      : minDecodeSpeed(minDecodeSpeed_),
+        budget(budget_),
+        sampleSize(sampleSize_ > 0 ? sampleSize_ : defaultSampleSize),
+        spent(0),
+        counts(zimcompLzma + 1, 0),
+        countFallback(0)
+    {
+#ifdef ENABLE_ZLIB
+      candidates.push_back(Candidate(zimcompZip, 6));
+#endif
+#ifdef ENABLE_LZMA
+      candidates.push_back(Candidate(zimcompLzma, 3));
+      candidates.push_back(Candidate(zimcompLzma, 6));
+#endif
+#ifdef ENABLE_BZIP2
+      candidates.push_back(Candidate(zimcompBzip2, 9));
+#endif
+    }
+
+    double CodecSelector::threadTime()
+    {
+      struct timespec ts;
+      if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) != 0)
+        return 0;
+      return ts.tv_sec + ts.tv_nsec / 1e9;
+    }
+
+    void CodecSelector::choose(Cluster& cluster, CompressionType compression, int level, bool fallback)
+    {
+      cluster.setCompression(compression);
+      cluster.setCompressionLevel(level);
+
+      MutexLock lock(mutex);
+      ++counts[compression];
+      if (fallback)
+        ++countFallback;
+    }
+
+    void CodecSelector::select(Cluster& cluster)
+    {
+      size_type total = cluster.dataSize();
+      if (candidates.empty() || total == 0)
+      {
+        choose(cluster, zimcompNone, -1, false);
+        return;
+      }
+
+      double remaining = 0;
+      if (budget > 0)
+      {
+        MutexLock lock(mutex);
+        remaining = budget - spent;
+      }
+
+      if (budget > 0 && remaining <= 0)
+      {
+        log_debug("cpu budget of " << budget << "s used up; use first candidate");
+        choose(cluster, candidates[0].compression, candidates[0].level, true);
+        return;
+      }
+
+      double t0 = threadTime();
+
+      // sample slices spread over the data
+      std::string data;
+      if (total <= sampleSize)
+        data.assign(cluster.getBlobPtr(0), total);
+      else
+      {
+        size_type slice = sampleSize / countSlices;
+        for (unsigned n = 0; n < countSlices; ++n)
+          data.append(cluster.getBlobPtr(0) + (total - slice) / (countSlices - 1) * n, slice);
+      }
+
+      Cluster sample;
+      sample.addBlob(data.data(), data.size());
+
+      int best = -1;
+      bool overBudget = false;
+      size_type bestSize = 0;
+      double bestSpeed = 0;
+      std::vector<size_type> sizes(candidates.size());
+      std::vector<double> speeds(candidates.size());
+      std::vector<double> estimates(candidates.size());
+      for (unsigned n = 0; n < candidates.size(); ++n)
+      {
+        sample.setCompression(candidates[n].compression);
+        sample.setCompressionLevel(candidates[n].level);
+
+        double c0 = threadTime();
+        std::ostringstream out;
+        out << sample;
+        double c1 = threadTime();
+
+        std::istringstream in(out.str());
+        Cluster decoded;
+        in >> decoded;
+        double c2 = threadTime();
+
+        if (!out || !in)
+          throw std::runtime_error("failed to compress sample");
+
+        sizes[n] = out.str().size();
+        speeds[n] = c2 > c1 ? data.size() / (c2 - c1) / 1e6 : 1e9;
+
+        double estimate = estimates[n] = (c1 - c0) * total / data.size();
+        log_debug("candidate " << candidates[n].compression << '/' << candidates[n].level
+            << ": " << data.size() << " => " << sizes[n] << " bytes, decode "
+            << speeds[n] << " MB/s, estimated " << estimate << "s for " << total << " bytes");
+
+        if (minDecodeSpeed > 0 && speeds[n] < minDecodeSpeed)
+          continue;
+
+        if (budget > 0 && estimate > remaining)
+        {
+          overBudget = true;
+          continue;
+        }
+
+        if (best < 0 || sizes[n] < bestSize)
+        {
+          best = n;
+          bestSize = sizes[n];
+          bestSpeed = speeds[n];
+        }
+      }
+
+      // prefer a candidate decompressing faster, if it is nearly as good
+      if (best >= 0)
+      {
+        size_type limit = static_cast<size_type>(bestSize * sizeTolerance);
+        for (unsigned n = 0; n < candidates.size(); ++n)
+        {
+          if (sizes[n] <= limit && speeds[n] > bestSpeed
+            && (minDecodeSpeed <= 0 || speeds[n] >= minDecodeSpeed))
+          {
+            best = n;
+            bestSpeed = speeds[n];
+          }
+        }
+      }
+
+      // the compression of the cluster is charged, when it is chosen, so
+      // that clusters compressed in parallel see it already
+      double t = threadTime() - t0;
+      if (best >= 0 && data.size() >= minRatio * sizes[best])
+        t += estimates[best];
+      addTime(t);
+
+      if (best < 0)
+      {
+        if (overBudget)
+          choose(cluster, candidates[0].compression, candidates[0].level, true);
+        else
+          choose(cluster, zimcompNone, -1, false);
+      }
+      else if (data.size() < minRatio * sizes[best])
+        choose(cluster, zimcompNone, -1, false);
+      else
+        choose(cluster, candidates[best].compression, candidates[best].level, false);
+
+      log_debug("cluster of " << total << " bytes: compression " << cluster.getCompression() << " level " << cluster.getCompressionLevel());
+    }
+
+    void CodecSelector::addTime(double seconds)
+    {
+      MutexLock lock(mutex);
+      spent += seconds;
+    }
+
+    double CodecSelector::getTime() const
+    {
+      MutexLock lock(mutex);
+      return spent;
+    }
+
+    size_type CodecSelector::getCount(CompressionType compression) const
+    {
+      MutexLock lock(mutex);
+      return compression < counts.size() ? counts[compression] : 0;
+    }
+
+    size_type CodecSelector::getCountFallback() const
+    {
+      MutexLock lock(mutex);
+      return countFallback;
+    }
+
+  }
+}
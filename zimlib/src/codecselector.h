@@ -0,0 +1,107 @@
+/*
+ * Copyright (C) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * is provided AS IS, WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, and
+ * NON-INFRINGEMENT.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ */
+
+#ifndef ZIM_CODECSELECTOR_H
+#define ZIM_CODECSELECTOR_H
+
+#include <zim/zim.h>
+#include <zim/noncopyable.h>
+#include "mutex.h"
+#include <vector>
+
+namespace zim
+{
+  class Cluster;
+
+  namespace writer
+  {
+    /**
+       Chooses the compression and level for each cluster.
+
+       A sample of the cluster, up to sampleSize bytes taken from 4 places,
+       is compressed and decompressed with every candidate. The candidate
+       with the smallest result is chosen among those decompressing at
+       least minDecodeSpeed MB/s; another candidate within 2% of its size
+       is preferred, when it decompresses faster. A cluster is written
+       uncompressed, when it shrinks by less than 5%.
+
+       With a budget, the cpu time spent sampling and compressing is
+       limited. The time to compress a cluster is estimated from its sample
+       and charged, when the candidate is chosen. Candidates, which would
+       exceed the remaining budget, are skipped, and when the budget is
+       used up, the clusters are compressed with the first candidate, which
+       is the fastest, without sampling.
+
+       The methods may be called by several compressing threads.
+     */
+    class CodecSelector : private NonCopyable
+    {
+      public:
+        struct Candidate
+        {
+          CompressionType compression;
+          int level;
+
+          Candidate(CompressionType compression_, int level_)
+            : compression(compression_),
+              level(level_)
+            { }
+        };
+
+        static const size_type defaultSampleSize = 64 * 1024;
+
+      private:
+        std::vector<Candidate> candidates;
+        double minDecodeSpeed;
+        double budget;
+        size_type sampleSize;
+
+        mutable Mutex mutex;
+        double spent;
+        std::vector<size_type> counts;    // clusters by compression type
+        size_type countFallback;
+
+        void choose(Cluster& cluster, CompressionType compression, int level, bool fallback);
+
+      public:
+        /// Creates a selector with the candidates compiled into the
+        /// library, fastest first. A minDecodeSpeed or budget of 0 means
+        /// no limit.
+        explicit CodecSelector(double minDecodeSpeed = 0, double budget = 0,
+                               size_type sampleSize = defaultSampleSize);
+
+        const std::vector<Candidate>& getCandidates() const    { return candidates; }
+        void setCandidates(const std::vector<Candidate>& c)    { candidates = c; }
+
+        /// Sets the compression and level of a cluster.
+        void select(Cluster& cluster);
+        /// Charges cpu time to the budget.
+        void addTime(double seconds);
+
+        double getTime() const;
+        size_type getCount(CompressionType compression) const;
+        size_type getCountFallback() const;
+
+        /// Returns the cpu time in seconds used by the calling thread.
+        static double threadTime();
+    };
+  }
+}
+
+#endif // ZIM_CODECSELECTOR_H
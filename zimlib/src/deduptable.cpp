@@ -0,0 +1,123 @@
+/*
+ * Copyright (C) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * is provided AS IS, WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, and
+ * NON-INFRINGEMENT.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ */
+
+#include "deduptable.h"
+#include <string.h>
+
+namespace zim
+{
+  namespace writer
+  {
+    const size_type DedupTable::npos;
+
+    namespace
+    {
+      // an unused slot has no blob of size 0 in cluster npos
+      bool isEmpty(const DedupTable::Entry& e)
+      {
+        return e.cluster == DedupTable::npos;
+      }
+
+      uint64_t mix(uint64_t h)
+      {
+        h ^= h >> 33;
+        h *= 0xff51afd7ed558ccdULL;
+        h ^= h >> 33;
+        return h;
+      }
+    }
+
+    uint64_t DedupTable::hash(const char* data, size_type size)
+    {
+      uint64_t h = 0xcbf29ce484222325ULL ^ size;
+      size_type n = 0;
+      for ( ; n + 8 <= size; n += 8)
+      {
+        uint64_t w;
+        memcpy(&w, data + n, 8);
+        h = (h ^ mix(w)) * 0x9e3779b97f4a7c15ULL;
+      }
+
+      uint64_t w = 0;
+      for ( ; n < size; ++n)
+        w = (w << 8) | static_cast<unsigned char>(data[n]);
+      h = (h ^ mix(w)) * 0x9e3779b97f4a7c15ULL;
+
+      return mix(h);
+    }
+
+    size_type DedupTable::probe(uint64_t hash, size_type size, size_type slot) const
+    {
+      size_type mask = slots.size() - 1;
+      for ( ; !isEmpty(slots[slot]); slot = (slot + 1) & mask)
+      {
+        if (slots[slot].hash == hash && slots[slot].size == size)
+          return slot;
+      }
+      return npos;
+    }
+
+    size_type DedupTable::first(uint64_t hash, size_type size) const
+    {
+      if (slots.empty())
+        return npos;
+      return probe(hash, size, static_cast<size_type>(hash) & (slots.size() - 1));
+    }
+
+    size_type DedupTable::next(size_type slot, uint64_t hash, size_type size) const
+    {
+      return probe(hash, size, (slot + 1) & (slots.size() - 1));
+    }
+
+    void DedupTable::insert(uint64_t hash, size_type size, size_type cluster, size_type blob)
+    {
+      if ((count + 1) * 2 > slots.size())
+        grow();
+
+      size_type mask = slots.size() - 1;
+      size_type slot = static_cast<size_type>(hash) & mask;
+      while (!isEmpty(slots[slot]))
+        slot = (slot + 1) & mask;
+
+      Entry& e = slots[slot];
+      e.hash = hash;
+      e.size = size;
+      e.cluster = cluster;
+      e.blob = blob;
+      ++count;
+    }
+
+    void DedupTable::grow()
+    {
+      Entry empty;
+      empty.hash = 0;
+      empty.size = 0;
+      empty.cluster = npos;
+      empty.blob = 0;
+
+      std::vector<Entry> old(slots.empty() ? 1024 : slots.size() * 2, empty);
+      old.swap(slots);
+      count = 0;
+
+      for (std::vector<Entry>::const_iterator it = old.begin(); it != old.end(); ++it)
+        if (!isEmpty(*it))
+          insert(it->hash, it->size, it->cluster, it->blob);
+    }
+  }
+}
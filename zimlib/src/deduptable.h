@@ -0,0 +1,82 @@
+/*
+ * Copyright (C) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * is provided AS IS, WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, and
+ * NON-INFRINGEMENT.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ */
+
+#ifndef ZIM_DEDUPTABLE_H
+#define ZIM_DEDUPTABLE_H
+
+#include <zim/zim.h>
+#include <vector>
+
+namespace zim
+{
+  namespace writer
+  {
+    /**
+       Hash table of the blobs written to a zim file, used to find blobs
+       with identical content.
+
+       Each slot holds the hash and size of a blob and its cluster and blob
+       number in 24 bytes. Different blobs may have the same hash, so the
+       caller compares the content of every candidate before sharing it.
+       Collisions are resolved by linear probing and the table doubles,
+       when it is half full.
+     */
+    class DedupTable
+    {
+      public:
+        struct Entry
+        {
+          uint64_t hash;
+          size_type size;
+          size_type cluster;
+          size_type blob;
+        };
+
+        static const size_type npos = static_cast<size_type>(-1);
+
+      private:
+        std::vector<Entry> slots;
+        size_type count;
+
+        size_type probe(uint64_t hash, size_type size, size_type slot) const;
+        void grow();
+
+      public:
+        DedupTable()
+          : count(0)
+          { }
+
+        static uint64_t hash(const char* data, size_type size);
+
+        /// Returns the slot of the first blob with hash and size or npos.
+        size_type first(uint64_t hash, size_type size) const;
+        /// Returns the slot of the next blob with hash and size after the
+        /// given slot or npos.
+        size_type next(size_type slot, uint64_t hash, size_type size) const;
+
+        const Entry& operator[] (size_type slot) const  { return slots[slot]; }
+
+        void insert(uint64_t hash, size_type size, size_type cluster, size_type blob);
+
+        size_type size() const    { return count; }
+    };
+  }
+}
+
+#endif // ZIM_DEDUPTABLE_H
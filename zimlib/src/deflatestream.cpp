@@ -114,7 +114,9 @@ namespace zim
     stream.next_in = reinterpret_cast<Bytef*>(&obuffer[0]);
     stream.avail_in = pptr() - &obuffer[0];
     char zbuffer[8192];
-    while (stream.avail_in > 0)
+    // deflate keeps output, which does not fit into zbuffer, so repeat
+    // until there is room left, even when all input is consumed
+    do
     {
       // initialize zbuffer
       stream.next_out = (Bytef*)zbuffer;
@@ -130,7 +132,7 @@ namespace zim
         if (n < count)
           return -1;
       }
-    };
+    } while (stream.avail_in > 0 || stream.avail_out == 0);
 
     // reset outbuffer
     setp(&obuffer[0], &obuffer[0] + obuffer.size());
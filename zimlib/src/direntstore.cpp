@@ -0,0 +1,121 @@
+/*
+ * Copyright (C) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * is provided AS IS, WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, and
+ * NON-INFRINGEMENT.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ */
+
+#include <zim/writer/direntstore.h>
+
+namespace zim
+{
+  namespace writer
+  {
+    void DirentStore::setFields(Entry& e, const Dirent& dirent)
+    {
+      e.version = dirent.getVersion();
+      if (dirent.isRedirect())
+      {
+        e.clusterNumber = dirent.getRedirectIndex();
+        e.blobNumber = 0;
+      }
+      else
+      {
+        e.clusterNumber = dirent.getClusterNumber();
+        e.blobNumber = dirent.getBlobNumber();
+      }
+      e.idx = dirent.getIdx();
+      e.clusterGroup = dirent.getClusterGroup();
+      e.mimeType = dirent.getMimeType();
+      e.flags = (dirent.isArticle() && dirent.isCompress() ? flagCompress : 0)
+              | (dirent.isPacked() ? flagPacked : 0);
+    }
+
+    void DirentStore::push_back(const Dirent& dirent)
+    {
+      Entry e;
+      e.ns = dirent.getNamespace();
+      e.url = strings.add(dirent.getUrl());
+      e.aid = dirent.getAid() == dirent.getUrl() ? e.url : strings.add(dirent.getAid());
+      e.title = dirent.getTitle() == dirent.getUrl() ? e.url : strings.add(dirent.getTitle());
+      e.parameter = strings.add(dirent.getParameter());
+      e.redirectAid = strings.add(dirent.getRedirectAid());
+      setFields(e, dirent);
+      entries.push_back(e);
+    }
+
+    Dirent DirentStore::get(size_type n) const
+    {
+      const Entry& e = entries[n];
+
+      Dirent dirent;
+      dirent.setUrl(e.ns, strings.get(e.url));
+      if (e.title != e.url)
+        dirent.setTitle(strings.get(e.title));
+      dirent.setParameter(strings.get(e.parameter));
+      dirent.setAid(strings.get(e.aid));
+      dirent.setRedirectAid(strings.get(e.redirectAid));
+      dirent.setVersion(e.version);
+      dirent.setIdx(e.idx);
+      dirent.setClusterGroup(e.clusterGroup);
+      dirent.setCompress((e.flags & flagCompress) != 0);
+      dirent.setPacked((e.flags & flagPacked) != 0);
+      dirent.setArticle(e.mimeType, e.clusterNumber, e.blobNumber);
+      if (dirent.isRedirect())
+        dirent.setRedirect(e.clusterNumber);
+      return dirent;
+    }
+
+    DirentStore::size_type DirentStore::getDirentSize(size_type n) const
+    {
+      const Entry& e = entries[n];
+      size_type ret = (isRedirect(n) ? 12 : 16)
+                    + strings.getSize(e.url) + strings.getSize(e.parameter) + 2;
+      if (e.title != e.url)
+        ret += strings.getSize(e.title);
+      return ret;
+    }
+
+    void DirentStore::permute(std::vector<size_type>& order)
+    {
+      // Each position is filled from the entry, which belongs there,
+      // following the cycles of the permutation, so every entry is copied
+      // once.
+      for (size_type i = 0; i < order.size(); ++i)
+      {
+        if (order[i] == i)
+          continue;
+
+        Entry e = entries[i];
+        size_type k = i;
+        while (order[k] != i)
+        {
+          size_type next = order[k];
+          entries[k] = entries[next];
+          order[k] = k;
+          k = next;
+        }
+        entries[k] = e;
+        order[k] = k;
+      }
+    }
+
+    void DirentStore::clear()
+    {
+      std::vector<Entry>().swap(entries);
+      strings.clear();
+    }
+  }
+}
@@ -0,0 +1,292 @@
+/*
+ * Copyright (C) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * is provided AS IS, WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, and
+ * NON-INFRINGEMENT.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ */
+
+#include "extsort.h"
+#include <zim/endian.h>
+#include <algorithm>
+#include <fstream>
+#include <stdexcept>
+#include <stdio.h>
+#include "log.h"
+
+log_define("zim.writer.extsort")
+
+namespace zim
+{
+  namespace writer
+  {
+    void writeRecord(std::ostream& out, const std::string& data)
+    {
+      char size[4];
+      toLittleEndian(static_cast<uint32_t>(data.size()), size);
+      out.write(size, 4);
+      out.write(data.data(), data.size());
+    }
+
+    bool readRecord(std::istream& in, std::string& data)
+    {
+      char size[4];
+      if (!in.read(size, 4))
+        return false;
+
+      data.resize(fromLittleEndian(reinterpret_cast<const uint32_t*>(size)));
+      if (!data.empty() && !in.read(&data[0], data.size()))
+        throw std::runtime_error("incomplete record in temporary file");
+      return true;
+    }
+
+    namespace
+    {
+      // smallest and largest read ahead buffer of a run while merging
+      const size_type minRunBuffer = 4096;
+      const size_type maxRunBuffer = 1 << 20;
+    }
+
+    struct ExternalSorter::Run
+    {
+      offset_type pos;        // next byte to read from the temporary file
+      offset_type end;        // end of the run in the temporary file
+      size_type remaining;
+      size_type bufferSize;
+      std::string buffer;
+      std::string::size_type bufferPos;
+      std::string key;
+      std::string data;
+    };
+
+    // orders run readers by their current key and then by run number, so
+    // that the heap returns the smallest key of the earliest run first
+    class ExternalSorter::RunGreater
+    {
+        const std::vector<Run*>& runReaders;
+
+      public:
+        explicit RunGreater(const std::vector<Run*>& runReaders_)
+          : runReaders(runReaders_)
+          { }
+
+        bool operator() (size_type r1, size_type r2) const
+        {
+          int c = runReaders[r1]->key.compare(runReaders[r2]->key);
+          return c > 0 || (c == 0 && r1 > r2);
+        }
+    };
+
+    ExternalSorter::ExternalSorter(const std::string& tmpfname_, size_type memoryLimit_, unsigned threads_)
+      : tmpfname(tmpfname_),
+        memoryLimit(memoryLimit_),
+        threads(threads_),
+        memoryUsed(0),
+        runfile(0),
+        runInput(0),
+        pos(0)
+    {
+    }
+
+    ExternalSorter::~ExternalSorter()
+    {
+      for (std::vector<Run*>::iterator it = runReaders.begin(); it != runReaders.end(); ++it)
+        delete *it;
+
+      delete runfile;
+      delete runInput;
+
+      if (!runs.empty())
+        ::remove(tmpfname.c_str());
+    }
+
+    void ExternalSorter::add(const std::string& key, const std::string& d)
+    {
+      keys.add(key, dataOffsets.size());
+      dataOffsets.push_back(data.size());
+      data += d;
+
+      memoryUsed += key.size() + d.size() + sizeof(SortKeys::Entry) + sizeof(size_type);
+      if (memoryUsed >= memoryLimit)
+        writeRun();
+    }
+
+    void ExternalSorter::add(char ns, const std::string& key, const std::string& d)
+    {
+      keys.add(ns, key, dataOffsets.size());
+      dataOffsets.push_back(data.size());
+      data += d;
+
+      memoryUsed += key.size() + 1 + d.size() + sizeof(SortKeys::Entry) + sizeof(size_type);
+      if (memoryUsed >= memoryLimit)
+        writeRun();
+    }
+
+    void ExternalSorter::writeRun()
+    {
+      if (keys.size() == 0)
+        return;
+
+      if (runfile == 0)
+      {
+        runfile = new std::ofstream(tmpfname.c_str(), std::ios::out | std::ios::trunc | std::ios::binary);
+        if (!*runfile)
+          throw std::runtime_error("failed to create temporary file " + tmpfname);
+      }
+
+      log_debug("write run " << runs.size() << " with " << keys.size() << " records to " << tmpfname);
+
+      keys.sort(threads);
+      dataOffsets.push_back(data.size());
+
+      runs.push_back(std::pair<offset_type, size_type>(runfile->tellp(), keys.size()));
+      for (size_type n = 0; n < keys.size(); ++n)
+      {
+        size_type r = keys.getNumber(n);
+        writeRecord(*runfile, keys.getKey(n));
+        writeRecord(*runfile, data.substr(dataOffsets[r], dataOffsets[r + 1] - dataOffsets[r]));
+      }
+
+      if (!*runfile)
+        throw std::runtime_error("failed to write temporary file " + tmpfname);
+
+      keys.clear();
+      data.clear();
+      dataOffsets.clear();
+      memoryUsed = 0;
+    }
+
+    void ExternalSorter::readRunData(Run& run, char* data, size_type size)
+    {
+      while (size > 0)
+      {
+        if (run.bufferPos >= run.buffer.size())
+        {
+          size_type n = static_cast<size_type>(std::min(static_cast<offset_type>(run.bufferSize), run.end - run.pos));
+          if (n == 0)
+            throw std::runtime_error("incomplete record in temporary file");
+
+          run.buffer.resize(n);
+          runInput->seekg(run.pos);
+          if (!runInput->read(&run.buffer[0], n))
+            throw std::runtime_error("failed to read temporary file " + tmpfname);
+          run.pos += n;
+          run.bufferPos = 0;
+        }
+
+        size_type n = std::min(size, static_cast<size_type>(run.buffer.size() - run.bufferPos));
+        std::copy(run.buffer.data() + run.bufferPos, run.buffer.data() + run.bufferPos + n, data);
+        run.bufferPos += n;
+        data += n;
+        size -= n;
+      }
+    }
+
+    void ExternalSorter::readRunRecord(Run& run, std::string& data)
+    {
+      char size[4];
+      readRunData(run, size, 4);
+      data.resize(fromLittleEndian(reinterpret_cast<const uint32_t*>(size)));
+      if (!data.empty())
+        readRunData(run, &data[0], data.size());
+    }
+
+    bool ExternalSorter::readRun(size_type r)
+    {
+      Run& run = *runReaders[r];
+      if (run.remaining == 0)
+        return false;
+
+      readRunRecord(run, run.key);
+      readRunRecord(run, run.data);
+
+      --run.remaining;
+      return true;
+    }
+
+    void ExternalSorter::sort()
+    {
+      if (runs.empty())
+      {
+        // everything fits into memory
+        keys.sort(threads);
+        dataOffsets.push_back(data.size());
+        pos = 0;
+        return;
+      }
+
+      writeRun();
+      offset_type fileEnd = runfile->tellp();
+      delete runfile;
+      runfile = 0;
+
+      log_debug("merge " << runs.size() << " runs of " << tmpfname);
+
+      runInput = new std::ifstream(tmpfname.c_str(), std::ios::in | std::ios::binary);
+      if (!*runInput)
+        throw std::runtime_error("failed to read temporary file " + tmpfname);
+
+      size_type bufferSize = std::min(std::max(memoryLimit / static_cast<size_type>(runs.size()), minRunBuffer), maxRunBuffer);
+
+      RunGreater runGreater(runReaders);
+      for (size_type r = 0; r < runs.size(); ++r)
+      {
+        Run* run = new Run();
+        runReaders.push_back(run);
+        run->pos = runs[r].first;
+        run->end = r + 1 < runs.size() ? runs[r + 1].first : fileEnd;
+        run->remaining = runs[r].second;
+        run->bufferSize = bufferSize;
+        run->bufferPos = 0;
+
+        if (readRun(r))
+        {
+          heap.push_back(r);
+          std::push_heap(heap.begin(), heap.end(), runGreater);
+        }
+      }
+    }
+
+    bool ExternalSorter::next(std::string& key, std::string& d)
+    {
+      if (runs.empty())
+      {
+        if (pos >= keys.size())
+          return false;
+
+        size_type r = keys.getNumber(pos);
+        key = keys.getKey(pos);
+        d.assign(data, dataOffsets[r], dataOffsets[r + 1] - dataOffsets[r]);
+        ++pos;
+        return true;
+      }
+
+      if (heap.empty())
+        return false;
+
+      RunGreater runGreater(runReaders);
+      std::pop_heap(heap.begin(), heap.end(), runGreater);
+      size_type r = heap.back();
+      key.swap(runReaders[r]->key);
+      d.swap(runReaders[r]->data);
+
+      if (readRun(r))
+        std::push_heap(heap.begin(), heap.end(), runGreater);
+      else
+        heap.pop_back();
+
+      return true;
+    }
+  }
+}
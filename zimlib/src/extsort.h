@@ -0,0 +1,97 @@
+/*
+ * Copyright (C) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * is provided AS IS, WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, and
+ * NON-INFRINGEMENT.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ */
+
+#ifndef ZIM_EXTSORT_H
+#define ZIM_EXTSORT_H
+
+#include <zim/noncopyable.h>
+#include "sortkeys.h"
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+namespace zim
+{
+  namespace writer
+  {
+    /// Writes a length prefixed record.
+    void writeRecord(std::ostream& out, const std::string& data);
+    /// Reads a record written by writeRecord. Returns false at the end of
+    /// the stream.
+    bool readRecord(std::istream& in, std::string& data);
+
+    /**
+       Sorts records of a key and some data, which may not fit into memory.
+
+       Records are collected in memory until memoryLimit bytes are used.
+       Then they are sorted and written as a run to a temporary file. After
+       sort(), next() returns all records in key order by merging the runs.
+       Records with equal keys are returned in the order, in which they
+       were added. When everything fits into memory, no file is created.
+
+       The runs are merged through one file descriptor. Each run is read
+       ahead into a buffer of its share of memoryLimit, so that any number
+       of runs can be merged at once.
+     */
+    class ExternalSorter : private NonCopyable
+    {
+        struct Run;
+        class RunGreater;
+
+        std::string tmpfname;
+        size_type memoryLimit;
+        unsigned threads;
+
+        SortKeys keys;
+        std::string data;
+        std::vector<size_type> dataOffsets;
+        size_type memoryUsed;
+
+        std::ofstream* runfile;
+        std::vector<std::pair<offset_type, size_type> > runs;  // offset and count of records
+        std::ifstream* runInput;
+        std::vector<Run*> runReaders;
+        std::vector<size_type> heap;    // run readers with records left
+        size_type pos;                  // next record in memory, when there are no runs
+
+        void writeRun();
+        void readRunData(Run& run, char* data, size_type size);
+        void readRunRecord(Run& run, std::string& data);
+        bool readRun(size_type r);
+
+      public:
+        ExternalSorter(const std::string& tmpfname, size_type memoryLimit, unsigned threads);
+        /// Removes the temporary file.
+        ~ExternalSorter();
+
+        void add(const std::string& key, const std::string& data);
+        /// Adds a record with the namespace char prepended to key.
+        void add(char ns, const std::string& key, const std::string& data);
+
+        /// Finishes adding and prepares next().
+        void sort();
+        /// Returns the next record in key order; false after the last one.
+        bool next(std::string& key, std::string& data);
+
+        size_type getCountRuns() const  { return runs.size(); }
+    };
+  }
+}
+
+#endif // ZIM_EXTSORT_H
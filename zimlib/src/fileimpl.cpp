@@ -24,12 +24,14 @@
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <sstream>
+#include <fstream>
 #include <errno.h>
 #include <cstring>
 #include "config.h"
 #include "log.h"
 #include "envvalue.h"
-#include "md5stream.h"
+#include "md5file.h"
+#include "clusterblocks.h"
 
 log_define("zim.file.impl")
 
@@ -37,6 +39,8 @@ namespace zim
 {
   namespace
   {
+    const char titleIndexMagic[] = "ZIMTIDX1";
+
     template <typename T>
     T readFromLittleEndian(zim::ifstream& in, const char* errorMsg)
     {
@@ -54,7 +58,8 @@ namespace zim
   FileImpl::FileImpl(const char* fname)
     : zimFile(fname),
       direntCache(envValue("ZIM_DIRENTCACHE", DIRENT_CACHE_SIZE)),
-      clusterCache(envValue("ZIM_CLUSTERCACHE", CLUSTER_CACHE_SIZE))
+      clusterCache(envValue("ZIM_CLUSTERCACHE", CLUSTER_CACHE_SIZE)),
+      blockCache(envValue("ZIM_BLOCKCACHE", 16))
   {
     log_trace("read file \"" << fname << '"');
 
@@ -99,6 +104,7 @@ namespace zim
 
     if (header.hasGeoIdx())
     {
+      zimFile.seekg(header.getGeoIdxPos());
       uint32_t indexCount = readFromLittleEndian<uint32_t>(zimFile, "invalid geo index header");
       for (unsigned i = 0; i < indexCount + 1; ++i)
       {
@@ -217,6 +223,192 @@ namespace zim
     return cluster;
   }
 
+  // Finds the position and size of a blob in an uncompressed cluster by
+  // reading just its two offsets. Returns false, if the cluster is compressed.
+  bool FileImpl::getBlobRange(offset_type clusterOffset, size_type blobIdx, offset_type& pos, size_type& size, ClusterBlocks& blocks)
+  {
+    zimFile.seekg(clusterOffset);
+    char c;
+    zimFile.get(c);
+    if (zimFile.fail())
+      throw ZimFileFormatError("error reading cluster header");
+
+    if (c & zimcompBlocks)
+    {
+      blocks.readIndex(zimFile, static_cast<CompressionType>(c & ~zimcompBlocks));
+      if (zimFile.fail())
+        throw ZimFileFormatError("error reading cluster block index");
+      return false;
+    }
+
+    CompressionType compression = static_cast<CompressionType>(c);
+    if (compression != zimcompDefault && compression != zimcompNone)
+      return false;
+
+    size_type offsets[2];
+    zimFile.read(reinterpret_cast<char*>(offsets), sizeof(size_type));
+    if (zimFile.fail())
+      throw ZimFileFormatError("error reading cluster header");
+
+    if (isBigEndian())
+      offsets[0] = fromLittleEndian(&offsets[0]);
+    size_type count = offsets[0] / sizeof(size_type);
+    if (count == 0 || blobIdx >= count - 1)
+      throw ZimFileFormatError("blob index out of range");
+
+    zimFile.seekg(clusterOffset + 1 + sizeof(size_type) * blobIdx);
+    zimFile.read(reinterpret_cast<char*>(offsets), sizeof(offsets));
+    if (zimFile.fail())
+      throw ZimFileFormatError("error reading blob offsets");
+
+    if (isBigEndian())
+    {
+      offsets[0] = fromLittleEndian(&offsets[0]);
+      offsets[1] = fromLittleEndian(&offsets[1]);
+    }
+    if (offsets[1] < offsets[0])
+      throw ZimFileFormatError("invalid blob offsets");
+
+    pos = clusterOffset + 1 + offsets[0];
+    size = offsets[1] - offsets[0];
+    return true;
+  }
+
+  Cluster FileImpl::getBlock(size_type clusterIdx, offset_type clusterOffset, const ClusterBlocks& blocks, size_type n)
+  {
+    BlockKey key(clusterIdx, n);
+    Cluster block = blockCache.get(key);
+    if (block)
+      return block;
+
+    size_type size = blocks.getBlockEnd(n) - blocks.getBlockBegin(n);
+    log_debug("decompress block " << n << " of cluster " << clusterIdx << ", " << size << " bytes");
+    if (size == 0)
+      throw ZimFileFormatError("empty cluster block");
+
+    std::vector<char> compressed(size);
+    zimFile.seekg(clusterOffset + 1 + blocks.getIndexSize() + blocks.getBlockBegin(n));
+    zimFile.read(&compressed[0], size);
+    if (zimFile.fail())
+      throw ZimFileFormatError("error reading cluster block");
+
+    blocks.decompress(n, &compressed[0], block.resizeBlob(blocks.getUncompressedSize(n)));
+    blockCache.put(key, block);
+    return block;
+  }
+
+  void FileImpl::readBlocks(size_type clusterIdx, offset_type clusterOffset, const ClusterBlocks& blocks,
+                            size_type begin, size_type end, char* out)
+  {
+    if (end > blocks.getSize())
+      throw ZimFileFormatError("read past the end of cluster");
+
+    while (begin < end)
+    {
+      size_type n = begin / blocks.getBlockSize();
+      size_type blockBegin = n * blocks.getBlockSize();
+      Cluster block = getBlock(clusterIdx, clusterOffset, blocks, n);
+      size_type e = std::min(end - blockBegin, block.getBlobSize(0));
+      const char* data = block.getBlobPtr(0);
+      out = std::copy(data + (begin - blockBegin), data + e, out);
+      begin = blockBegin + e;
+    }
+  }
+
+  void FileImpl::getBlockedBlobRange(size_type clusterIdx, offset_type clusterOffset, const ClusterBlocks& blocks,
+                                     size_type blobIdx, size_type& begin, size_type& end)
+  {
+    size_type offsets[2];
+    readBlocks(clusterIdx, clusterOffset, blocks, 0, sizeof(size_type), reinterpret_cast<char*>(offsets));
+    if (isBigEndian())
+      offsets[0] = fromLittleEndian(&offsets[0]);
+    size_type count = offsets[0] / sizeof(size_type);
+    if (count == 0 || blobIdx >= count - 1)
+      throw ZimFileFormatError("blob index out of range");
+
+    readBlocks(clusterIdx, clusterOffset, blocks, sizeof(size_type) * blobIdx,
+               sizeof(size_type) * (blobIdx + 2), reinterpret_cast<char*>(offsets));
+    if (isBigEndian())
+    {
+      offsets[0] = fromLittleEndian(&offsets[0]);
+      offsets[1] = fromLittleEndian(&offsets[1]);
+    }
+    if (offsets[1] < offsets[0])
+      throw ZimFileFormatError("invalid blob offsets");
+
+    begin = offsets[0];
+    end = offsets[1];
+  }
+
+  Blob FileImpl::getBlob(size_type clusterIdx, size_type blobIdx)
+  {
+    log_trace("getBlob(" << clusterIdx << ", " << blobIdx << ')');
+
+    if (clusterIdx >= getCountClusters())
+      throw ZimFileFormatError("cluster index out of range");
+
+    Cluster* cached = clusterCache.getptr(clusterIdx);
+    if (cached)
+      return cached->getBlob(blobIdx);
+
+    offset_type clusterOffset = getClusterOffset(clusterIdx);
+    offset_type pos;
+    size_type size;
+    ClusterBlocks blocks;
+    if (getBlobRange(clusterOffset, blobIdx, pos, size, blocks))
+    {
+      log_debug("read blob " << blobIdx << " of uncompressed cluster " << clusterIdx << " from offset " << pos << " size " << size);
+      if (size == 0)
+        return Blob();
+
+      Cluster cluster;
+      zimFile.seekg(pos);
+      cluster.readBlob(zimFile, size);
+      if (zimFile.fail())
+        throw ZimFileFormatError("error reading blob data");
+
+      return cluster.getBlob(0);
+    }
+
+    if (blocks.getCount() == 0)
+      return getCluster(clusterIdx).getBlob(blobIdx);
+
+    size_type begin, end;
+    getBlockedBlobRange(clusterIdx, clusterOffset, blocks, blobIdx, begin, end);
+    log_debug("read blob " << blobIdx << " of cluster " << clusterIdx << " from blocks " << begin / blocks.getBlockSize() << " to " << (end - 1) / blocks.getBlockSize());
+    if (begin == end)
+      return Blob();
+
+    Cluster cluster;
+    readBlocks(clusterIdx, clusterOffset, blocks, begin, end, cluster.resizeBlob(end - begin));
+    return cluster.getBlob(0);
+  }
+
+  size_type FileImpl::getBlobSize(size_type clusterIdx, size_type blobIdx)
+  {
+    if (clusterIdx >= getCountClusters())
+      throw ZimFileFormatError("cluster index out of range");
+
+    Cluster* cached = clusterCache.getptr(clusterIdx);
+    if (cached)
+      return cached->getBlobSize(blobIdx);
+
+    offset_type clusterOffset = getClusterOffset(clusterIdx);
+    offset_type pos;
+    size_type size;
+    ClusterBlocks blocks;
+    if (getBlobRange(clusterOffset, blobIdx, pos, size, blocks))
+      return size;
+
+    if (blocks.getCount() == 0)
+      return getCluster(clusterIdx).getBlobSize(blobIdx);
+
+    size_type begin, end;
+    getBlockedBlobRange(clusterIdx, clusterOffset, blocks, blobIdx, begin, end);
+    return end - begin;
+  }
+
+
   offset_type FileImpl::getOffset(offset_type ptrOffset, size_type idx)
   {
     zimFile.seekg(ptrOffset + sizeof(offset_type) * idx);
@@ -270,6 +462,8 @@ namespace zim
     size_type lower = 0;
     size_type upper = getCountArticles();
     log_debug("namespace " << ch << " lower=" << lower << " upper=" << upper);
+    if (upper > 0 && getDirent(0).getNamespace() > ch)
+      upper = 0;
     while (upper - lower > 1)
     {
       size_type m = lower + (upper - lower) / 2;
@@ -317,6 +511,228 @@ namespace zim
     return mimeTypes[idx];
   }
 
+  template <typename T>
+  T& FileImpl::getPerNamespace(std::map<char, T>& cache, char ns, void (FileImpl::*create)(char, T&))
+  {
+    typename std::map<char, T>::iterator it = cache.find(ns);
+    if (it == cache.end())
+    {
+      it = cache.insert(typename std::map<char, T>::value_type(ns, T())).first;
+      try
+      {
+        (this->*create)(ns, it->second);
+      }
+      catch (...)
+      {
+        cache.erase(it);
+        throw;
+      }
+    }
+
+    return it->second;
+  }
+
+  void FileImpl::readNamespaceTitles(char ns, NamespaceTitles& result)
+  {
+    log_debug("read titles of namespace " << ns);
+
+    size_type l = getNamespaceBeginOffset(ns);
+    size_type u = getNamespaceEndOffset(ns);
+    if (l >= u)
+      return;
+
+    // the directory entries are read in url order, which is the order in
+    // the file
+    std::vector<offset_type> urlPtr;
+    readUrlPointers(l, u, urlPtr);
+
+    result.titles.resize(u - l);
+    result.isArticle.resize(u - l);
+    result.redirects.resize(u - l);
+    for (size_type idx = l; idx < u; ++idx)
+    {
+      zimFile.seekg(urlPtr[idx - l]);
+      Dirent dirent;
+      zimFile >> dirent;
+      if (!zimFile)
+        throw ZimFileFormatError("failed to read directory entry");
+
+      result.titles[idx - l] = dirent.getTitle();
+      result.isArticle[idx - l] = dirent.isArticle();
+      if (dirent.isRedirect()
+          && dirent.getRedirectIndex() >= l && dirent.getRedirectIndex() < u)
+        ++result.redirects[dirent.getRedirectIndex() - l];
+    }
+  }
+
+  const TitleDictionary& FileImpl::getTitleDictionary(char ns)
+  {
+    return getPerNamespace(titleDictionaries, ns, &FileImpl::readTitleDictionary);
+  }
+
+  void FileImpl::readTitleDictionary(char ns, TitleDictionary& dict)
+  {
+    log_debug("read title dictionary of namespace " << ns);
+
+    size_type l = getNamespaceBeginOffset(ns);
+    size_type u = getNamespaceEndOffset(ns);
+    if (l >= u)
+      return;
+
+    // the articles of a namespace occupy the same range in the url and in
+    // the title index
+    size_type n = u - l;
+    std::vector<size_type> titleIdx(n);
+    zimFile.seekg(header.getTitleIdxPos() + sizeof(size_type) * l);
+    zimFile.read(reinterpret_cast<char*>(&titleIdx[0]), sizeof(size_type) * n);
+
+    if (!zimFile)
+      throw ZimFileFormatError("error reading title index");
+
+    NamespaceTitles titles;
+    readNamespaceTitles(ns, titles);
+    for (size_type i = 0; i < n; ++i)
+    {
+      size_type idx = isBigEndian() ? fromLittleEndian(&titleIdx[i]) : titleIdx[i];
+      if (idx < l || idx >= u)
+        throw ZimFileFormatError("title index out of namespace range");
+
+      dict.add(titles.titles[idx - l], idx);
+    }
+
+    log_debug("title dictionary of namespace " << ns << " has " << dict.size() << " titles in " << dict.getMemoryUsage() << " bytes");
+  }
+
+  void FileImpl::readUrlPointers(size_type begin, size_type end, std::vector<offset_type>& result)
+  {
+    result.resize(end - begin);
+    if (result.empty())
+      return;
+
+    zimFile.setBufsize(16384);
+    zimFile.seekg(header.getUrlPtrPos() + sizeof(offset_type) * begin);
+    zimFile.read(reinterpret_cast<char*>(&result[0]), sizeof(offset_type) * result.size());
+
+    if (!zimFile)
+      throw ZimFileFormatError("error reading url pointer list");
+
+    if (isBigEndian())
+      for (std::vector<offset_type>::iterator it = result.begin(); it != result.end(); ++it)
+        *it = fromLittleEndian(&*it);
+  }
+
+  const TitleIndex& FileImpl::getTitleIndex(char ns)
+  {
+    return getPerNamespace(titleIndexes, ns, &FileImpl::createTitleIndex);
+  }
+
+  void FileImpl::createTitleIndex(char ns, TitleIndex& index)
+  {
+    if (!readTitleIndexFile(ns, index))
+      buildTitleIndex(ns, index);
+  }
+
+  std::string FileImpl::getTitleIndexFilename(char ns) const
+  {
+    return filename + '.' + ns + ".titleidx";
+  }
+
+  void FileImpl::writeTitleIndex(char ns)
+  {
+    const TitleIndex& index = getTitleIndex(ns);
+
+    std::string fname = getTitleIndexFilename(ns);
+    log_info("write title index to \"" << fname << '"');
+
+    std::ofstream out(fname.c_str());
+    out.write(titleIndexMagic, 8);
+    out.write(header.getUuid().data, header.getUuid().size());
+    out.put(ns);
+    index.write(out);
+
+    if (!out)
+      throw std::runtime_error("failed to write title index \"" + fname + '"');
+  }
+
+  bool FileImpl::readTitleIndexFile(char ns, TitleIndex& index)
+  {
+    std::string fname = getTitleIndexFilename(ns);
+    std::ifstream in(fname.c_str());
+    if (!in)
+      return false;
+
+    char magic[8];
+    char uuid[16];
+    char fns = '\0';
+    in.read(magic, 8);
+    in.read(uuid, 16);
+    in.get(fns);
+    if (!in || std::memcmp(magic, titleIndexMagic, 8) != 0
+      || Uuid(uuid) != header.getUuid() || fns != ns)
+    {
+      log_warn("title index \"" << fname << "\" does not match zim file - ignored");
+      return false;
+    }
+
+    try
+    {
+      index.read(in);
+
+      size_type l = getNamespaceBeginOffset(ns);
+      size_type u = getNamespaceEndOffset(ns);
+      for (size_type n = 0; n < index.size(); ++n)
+        if (index.getArticleIndex(n) < l || index.getArticleIndex(n) >= u)
+          throw std::runtime_error("article index out of namespace range");
+    }
+    catch (const std::exception& e)
+    {
+      log_warn("failed to read title index \"" << fname << "\": " << e.what());
+      index = TitleIndex();
+      return false;
+    }
+
+    log_debug("title index of namespace " << ns << " read from \"" << fname << "\"; " << index.size() << " titles");
+    return true;
+  }
+
+  void FileImpl::buildTitleIndex(char ns, TitleIndex& index)
+  {
+    log_debug("build title index of namespace " << ns);
+
+    size_type l = getNamespaceBeginOffset(ns);
+    NamespaceTitles titles;
+    readNamespaceTitles(ns, titles);
+    for (size_type n = 0; n < titles.titles.size(); ++n)
+      if (titles.isArticle[n])
+        index.add(titles.titles[n], l + n);
+
+    index.build();
+
+    log_debug("title index of namespace " << ns << " has " << index.size() << " titles in " << index.getMemoryUsage() << " bytes");
+  }
+
+  const Autocomplete& FileImpl::getAutocomplete(char ns)
+  {
+    return getPerNamespace(autocompletes, ns, &FileImpl::buildAutocomplete);
+  }
+
+  void FileImpl::buildAutocomplete(char ns, Autocomplete& autocomplete)
+  {
+    log_debug("build autocompletion of namespace " << ns);
+
+    // the articles are ranked by the number of redirects to them
+    size_type l = getNamespaceBeginOffset(ns);
+    NamespaceTitles titles;
+    readNamespaceTitles(ns, titles);
+    for (size_type n = 0; n < titles.titles.size(); ++n)
+      if (titles.isArticle[n])
+        autocomplete.add(titles.titles[n], l + n, titles.redirects[n]);
+
+    autocomplete.build();
+
+    log_debug("autocompletion of namespace " << ns << " has " << autocomplete.getCountPrefixes() << " prefixes in " << autocomplete.getMemoryUsage() << " bytes");
+  }
+
   bool FileImpl::findArticlesByGeoArea(const GeoPoint& min, const GeoPoint& max, size_t maxResults, unsigned index, std::vector<ArticleGeoPoint>& results)
   {
     zimFile.seekg(header.getGeoIdxPos() + geoIndices[index]);
@@ -350,27 +766,22 @@ namespace zim
     return hexdigest;
   }
 
-  bool FileImpl::verify()
+  bool FileImpl::verify(Progress* progress)
   {
     if (!header.hasChecksum())
       return false;
 
-    Md5stream md5;
-
-    zimFile.seekg(0);
-    char ch;
-    for (offset_type n = 0; n < header.getChecksumPos() && zimFile.get(ch); ++n)
-      md5 << ch;
-
     unsigned char chksumFile[16];
     unsigned char chksumCalc[16];
 
+    zimFile.seekg(header.getChecksumPos());
     zimFile.read(reinterpret_cast<char*>(chksumFile), 16);
 
     if (!zimFile)
       throw ZimFileFormatError("failed to read checksum from zim file");
 
-    md5.getDigest(chksumCalc);
+    md5File(zimFile.getParts(), header.getChecksumPos(), chksumCalc, progress);
+
     if (std::memcmp(chksumFile, chksumCalc, 16) != 0)
       throw ZimFileFormatError("invalid checksum in zim file");
 
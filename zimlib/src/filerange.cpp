@@ -0,0 +1,186 @@
+/*
+ * Copyright (C) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * is provided AS IS, WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, and
+ * NON-INFRINGEMENT.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ */
+
+#include "filerange.h"
+#include "config.h"
+#include "log.h"
+#include <algorithm>
+#include <iostream>
+#include <stdexcept>
+#include <vector>
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#include <sys/mman.h>
+#endif
+
+#ifndef O_LARGEFILE
+#define O_LARGEFILE 0
+#endif
+
+#ifndef O_BINARY
+#define O_BINARY 0
+#endif
+
+log_define("zim.filerange")
+
+namespace zim
+{
+  namespace
+  {
+    class InputFile
+    {
+        int fd;
+
+      public:
+        explicit InputFile(const std::string& fname)
+          : fd(openFile(fname, O_RDONLY))
+        {
+          if (fd < 0)
+            throw std::runtime_error("failed to open file \"" + fname + '"');
+        }
+
+        ~InputFile()
+          { ::close(fd); }
+
+        int getFd() const
+          { return fd; }
+
+        void read(const std::string& fname, offset_type offset, char* data, size_type size) const
+        {
+          while (size > 0)
+          {
+#if defined(HAVE_PREAD64)
+            ssize_t n = ::pread64(fd, data, size, offset);
+#elif defined(_WIN32)
+            ssize_t n = ::_lseeki64(fd, offset, SEEK_SET) < 0 ? -1 : ::read(fd, data, size);
+#else
+            ssize_t n = ::pread(fd, data, size, offset);
+#endif
+            if (n <= 0)
+              throw std::runtime_error("failed to read file \"" + fname + '"');
+            data += n;
+            offset += n;
+            size -= n;
+          }
+        }
+    };
+  }
+
+  int openFile(const std::string& fname, int flags)
+  {
+#ifdef HAVE_OPEN64
+    return ::open64(fname.c_str(), flags | O_LARGEFILE | O_BINARY);
+#else
+    return ::open(fname.c_str(), flags | O_LARGEFILE | O_BINARY);
+#endif
+  }
+
+  FileRange::FileRange(const std::string& fname, offset_type offset, size_type size)
+    : map(0),
+      mapSize(0),
+      ptr(0),
+      len(size)
+  {
+    if (size == 0)
+    {
+      ptr = buffer.data();
+      return;
+    }
+
+    InputFile in(fname);
+
+#ifndef _WIN32
+    offset_type pageSize = ::sysconf(_SC_PAGESIZE);
+    offset_type start = offset - offset % pageSize;
+    mapSize = size + (offset - start);
+#ifdef HAVE_MMAP64
+    map = ::mmap64(0, mapSize, PROT_READ, MAP_PRIVATE, in.getFd(), start);
+#else
+    map = ::mmap(0, mapSize, PROT_READ, MAP_PRIVATE, in.getFd(), start);
+#endif
+    if (map != MAP_FAILED)
+    {
+      ptr = static_cast<const char*>(map) + (offset - start);
+      return;
+    }
+
+    log_debug("mmap of \"" << fname << "\" failed; read " << size << " bytes");
+    map = 0;
+#endif
+
+    buffer.resize(size);
+    in.read(fname, offset, &buffer[0], size);
+    ptr = buffer.data();
+  }
+
+  FileRange::~FileRange()
+  {
+#ifndef _WIN32
+    if (map)
+      ::munmap(map, mapSize);
+#endif
+  }
+
+  void copyFileRange(const std::string& fname, offset_type offset, size_type size,
+                     std::ostream& out, int outFd)
+  {
+    InputFile in(fname);
+
+#ifdef HAVE_COPY_FILE_RANGE
+    if (outFd >= 0 && size > 0)
+    {
+      out.flush();
+      loff_t inPos = offset;
+      loff_t outPos = static_cast<offset_type>(out.tellp());
+      while (size > 0)
+      {
+        ssize_t n = ::copy_file_range(in.getFd(), &inPos, outFd, &outPos, size, 0);
+        if (n <= 0)
+        {
+          // e.g. not supported by the file systems; copy the rest below
+          log_debug("copy_file_range failed: " << (n < 0 ? errno : 0));
+          break;
+        }
+        size -= n;
+      }
+
+      offset = inPos;
+      out.seekp(outPos);
+    }
+#endif
+
+    std::vector<char> buffer(std::min(size, static_cast<size_type>(64 * 1024)));
+    while (size > 0)
+    {
+      size_type n = std::min(size, static_cast<size_type>(buffer.size()));
+      in.read(fname, offset, &buffer[0], n);
+      out.write(&buffer[0], n);
+      offset += n;
+      size -= n;
+    }
+  }
+
+}
@@ -0,0 +1,62 @@
+/*
+ * Copyright (C) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * is provided AS IS, WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, and
+ * NON-INFRINGEMENT.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ */
+
+#ifndef ZIM_FILERANGE_H
+#define ZIM_FILERANGE_H
+
+#include <zim/zim.h>
+#include <zim/noncopyable.h>
+#include <iosfwd>
+#include <string>
+
+namespace zim
+{
+  /**
+     A range of a file mapped into memory. Where mmap is not available,
+     the range is read into a buffer.
+   */
+  class FileRange : private NonCopyable
+  {
+      std::string buffer;
+      void* map;
+      size_type mapSize;
+      const char* ptr;
+      size_type len;
+
+    public:
+      FileRange(const std::string& fname, offset_type offset, size_type size);
+      ~FileRange();
+
+      const char* data() const  { return ptr; }
+      size_type size() const    { return len; }
+  };
+
+  /// Opens a file with the given open flags, supporting large files.
+  /// Returns -1 on failure.
+  int openFile(const std::string& fname, int flags);
+
+  /// Appends size bytes of file fname starting at offset to out. When
+  /// outFd is an open descriptor of the file written by out, out is flushed
+  /// and the bytes are copied by the kernel with copy_file_range, where
+  /// available, without passing through user space.
+  void copyFileRange(const std::string& fname, offset_type offset, size_type size,
+                     std::ostream& out, int outFd = -1);
+}
+
+#endif // ZIM_FILERANGE_H
@@ -21,6 +21,7 @@
 #include "log.h"
 #include "config.h"
 #include <sstream>
+#include <algorithm>
 #include <stdexcept>
 #include <errno.h>
 #include <string.h>
@@ -102,14 +103,12 @@ std::streambuf::int_type streambuf::overflow(std::streambuf::int_type ch)
   return traits_type::eof();
 }
 
-std::streambuf::int_type streambuf::underflow()
+int streambuf::readFile(char* p, size_t size)
 {
-  log_debug("underflow; bufsize=" << buffer.size());
-
   int n;
   do
   {
-    n = ::read(currentFile->fd, &buffer[0], buffer.size());
+    n = ::read(currentFile->fd, p, size);
     if (n < 0)
     {
       std::ostringstream msg;
@@ -129,17 +128,60 @@ std::streambuf::int_type streambuf::underflow()
       }
 
       if (it == files.end())
-        return traits_type::eof();
+        return 0;
 
       setCurrentFile((*it)->fname, 0);
     }
   } while (n == 0);
 
+  return n;
+}
+
+std::streambuf::int_type streambuf::underflow()
+{
+  log_debug("underflow; bufsize=" << buffer.size());
+
+  int n = readFile(&buffer[0], buffer.size());
+  if (n == 0)
+    return traits_type::eof();
+
   char* p = &buffer[0];
   setg(p, p, p + n);
   return traits_type::to_int_type(*gptr());
 }
 
+std::streamsize streambuf::xsgetn(char* s, std::streamsize n)
+{
+  // take what is left in the buffer and read the rest directly into s,
+  // unless it fits into the buffer
+  std::streamsize count = std::min(n, static_cast<std::streamsize>(egptr() - gptr()));
+  std::copy(gptr(), gptr() + count, s);
+  setg(eback(), gptr() + count, egptr());
+
+  while (count < n)
+  {
+    if (static_cast<size_t>(n - count) < buffer.size())
+    {
+      if (traits_type::eq_int_type(underflow(), traits_type::eof()))
+        break;
+      std::streamsize c = std::min(n - count, static_cast<std::streamsize>(egptr() - gptr()));
+      std::copy(gptr(), gptr() + c, s + count);
+      setg(eback(), gptr() + c, egptr());
+      count += c;
+    }
+    else
+    {
+      log_debug("read " << n - count << " bytes unbuffered");
+      int c = readFile(s + count, n - count);
+      if (c == 0)
+        break;
+      count += c;
+    }
+  }
+
+  return count;
+}
+
 int streambuf::sync()
 {
   return traits_type::eof();
@@ -288,6 +330,14 @@ zim::offset_type streambuf::fsize() const
   return o;
 }
 
+streambuf::PartsType streambuf::getParts() const
+{
+  PartsType parts;
+  for (FilesType::const_iterator it = files.begin(); it != files.end(); ++it)
+    parts.push_back(PartsType::value_type((*it)->fname, (*it)->fsize));
+  return parts;
+}
+
 time_t streambuf::getMTime() const
 {
   if (mtime || files.empty())
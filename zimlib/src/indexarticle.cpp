@@ -21,6 +21,7 @@
 #include <zim/zintstream.h>
 #include <sstream>
 #include <stdexcept>
+#include <algorithm>
 #include "log.h"
 #include "ptrstream.h"
 
@@ -28,6 +29,12 @@ log_define("zim.indexarticle")
 
 namespace zim
 {
+  //////////////////////////////////////////////////////////////////////
+  // IndexArticle
+  //
+  const unsigned IndexArticle::blockFormatFlag;
+  const unsigned IndexArticle::blockSize;
+
   bool IndexArticle::noOffset = false;
 
   void IndexArticle::readEntries()
@@ -37,11 +44,21 @@ namespace zim
 
     log_debug("read entries for article " << getUrl());
 
+    for (unsigned c = 0; c < 4; ++c)
+    {
+      counts[c] = 0;
+      blocksDecoded[c] = true;
+    }
+
     if (getParameter().empty())
       readEntriesB();
     else
       readEntriesZ();
 
+    if (!blockFormat)
+      for (unsigned c = 0; c < 4; ++c)
+        counts[c] = entries[c].size();
+
     categoriesRead = true;
   }
 
@@ -55,6 +72,12 @@ namespace zim
 
     log_debug("flags: h" << std::hex << flagfield);
 
+    if (flagfield & blockFormatFlag)
+    {
+      readBlocks(extra, flagfield);
+      return;
+    }
+
     unsigned offset = 0;
     for (unsigned c = 0; c <= 3; ++c)
     {
@@ -73,8 +96,6 @@ namespace zim
         else
           entry.pos = 0;
 
-        unsigned pos = entry.pos;
-
         if (!s)
           throw std::runtime_error("invalid index entry");
 
@@ -83,13 +104,18 @@ namespace zim
 
         log_debug("read data from offset " << offset << " len " << len);
         zim::Blob b = getData();
-        ptrstream data(const_cast<char*>(b.data() + offset), const_cast<char*>(b.data() + offset + len));
-        ZIntStream zdata(data);
+        if (offset + len > b.size())
+          throw std::runtime_error("invalid index entry");
+
+        std::vector<size_type> values(len);
+        size_type count = decodeZInts(b.data() + offset, b.data() + offset + len, values.empty() ? 0 : &values[0]);
 
-        unsigned index;
+        // the deltas start from 0, not from the first entry
         unsigned indexOffset = 0;
-        while (zdata.get(index))
+        unsigned pos = 0;
+        for (size_type n = 0; n < count; )
         {
+          unsigned index = values[n++];
           entry.index = indexOffset + index;
 
           if (!noOffset)
@@ -97,11 +123,14 @@ namespace zim
 
           if (getNamespace() == 'X')
           {
-            unsigned p;
-            if (!zdata.get(p))
+            if (n >= count)
               throw std::runtime_error("invalid index entry");
-            pos += p;
-            entry.pos = p;
+
+            // like the index, the position is a delta, as long as the
+            // article does not change
+            unsigned p = values[n++];
+            pos = !noOffset && index == 0 ? pos + p : p;
+            entry.pos = pos;
           }
           else
             entry.pos = 0;
@@ -117,6 +146,201 @@ namespace zim
 
   }
 
+  void IndexArticle::readBlocks(ZIntStream& extra, unsigned flagfield)
+  {
+    blockFormat = true;
+
+    zim::Blob b = getData();
+    unsigned offset = 0;
+    for (unsigned c = 0; c <= 3; ++c, flagfield >>= 1)
+    {
+      if (!(flagfield & 1))
+        continue;
+
+      unsigned len, count;
+      if (!extra.get(len) || !extra.get(count) || offset + len > b.size())
+        throw std::runtime_error("invalid index entry");
+
+      log_debug("category " << c << " has " << count << " entries in " << len << " bytes");
+
+      // read skip entries
+      unsigned numBlocks = (count + blockSize - 1) / blockSize;
+      std::vector<size_type> skip(numBlocks * 2);
+      const char* blockData = numBlocks == 0 ? b.data() + offset
+        : decodeZInts(b.data() + offset, b.data() + offset + len, &skip[0], numBlocks * 2);
+
+      unsigned maxIndex = 0;
+      unsigned blockOffset = 0;
+      for (unsigned n = 0; n < numBlocks; ++n)
+      {
+        Block block;
+        maxIndex += skip[n * 2];
+        block.maxIndex = maxIndex;
+        block.size = skip[n * 2 + 1];
+        block.offset = blockOffset;
+        block.count = n + 1 < numBlocks ? blockSize : count - n * blockSize;
+        blockOffset += block.size;
+        blocks[c].push_back(block);
+      }
+
+      // the skip entries are followed by the blocks
+      unsigned dataOffset = static_cast<unsigned>(blockData - b.data());
+      if (dataOffset + blockOffset > offset + len)
+        throw std::runtime_error("invalid index block size");
+
+      for (BlocksType::iterator it = blocks[c].begin(); it != blocks[c].end(); ++it)
+        it->offset += dataOffset;
+
+      counts[c] = count;
+      blocksDecoded[c] = false;
+      offset += len;
+    }
+  }
+
+  void IndexArticle::readBlock(unsigned cat, unsigned block, EntriesType& result)
+  {
+    const Block& b = blocks[cat][block];
+
+    log_debug("read block " << block << " of category " << cat << " with " << b.count << " entries");
+
+    zim::Blob data = getData();
+    std::vector<size_type> values(b.count * 2);
+    if (b.count > 0)
+      decodeZInts(data.data() + b.offset, data.data() + b.offset + b.size, &values[0], b.count * 2);
+
+    EntriesType::size_type first = result.size();
+    result.resize(first + b.count);
+
+    unsigned index = block > 0 ? blocks[cat][block - 1].maxIndex : 0;
+    for (unsigned n = 0; n < b.count; ++n)
+    {
+      index += values[n];
+      result[first + n].index = index;
+    }
+
+    for (unsigned n = 0; n < b.count; ++n)
+    {
+      unsigned pos = values[b.count + n];
+      if (n > 0 && result[first + n].index == result[first + n - 1].index)
+        pos += result[first + n - 1].pos;
+      result[first + n].pos = pos;
+    }
+  }
+
+  void IndexArticle::decodeBlocks(unsigned cat)
+  {
+    if (blocksDecoded[cat])
+      return;
+
+    entries[cat].reserve(counts[cat]);
+    for (unsigned n = 0; n < blocks[cat].size(); ++n)
+      readBlock(cat, n, entries[cat]);
+
+    blocksDecoded[cat] = true;
+  }
+
+  void IndexArticle::writeBlocks(std::ostream& out, const EntriesType& entries)
+  {
+    std::ostringstream skip;
+    std::ostringstream blocks;
+    ZIntStream zskip(skip);
+
+    size_type lastidx = 0;
+    for (EntriesType::size_type b = 0; b < entries.size(); b += blockSize)
+    {
+      EntriesType::size_type e = std::min(b + blockSize, entries.size());
+
+      std::ostringstream block;
+      ZIntStream zblock(block);
+
+      size_type idx = lastidx;
+      for (EntriesType::size_type n = b; n < e; ++n)
+      {
+        zblock.put(entries[n].index - idx);
+        idx = entries[n].index;
+      }
+
+      for (EntriesType::size_type n = b; n < e; ++n)
+      {
+        size_type pos = entries[n].pos;
+        if (n > b && entries[n].index == entries[n - 1].index)
+          pos -= entries[n - 1].pos;  // same article as previous
+        zblock.put(pos);
+      }
+
+      zskip.put(idx - lastidx)
+           .put(block.str().size());
+      blocks << block.str();
+      lastidx = idx;
+    }
+
+    out << skip.str() << blocks.str();
+  }
+
+  //////////////////////////////////////////////////////////////////////
+  // IndexArticle::Cursor
+  //
+  IndexArticle::Cursor::Cursor(IndexArticle& article_, unsigned cat_)
+    : article(&article_),
+      cat(cat_),
+      block(0),
+      current(0)
+  {
+    article->readEntries();
+    if (article->blockFormat)
+      readBlock();
+  }
+
+  void IndexArticle::Cursor::readBlock()
+  {
+    blockEntries.clear();
+    current = 0;
+    if (block < article->blocks[cat].size())
+      article->readBlock(cat, block, blockEntries);
+  }
+
+  IndexArticle::Cursor& IndexArticle::Cursor::operator++()
+  {
+    if (++current >= entries().size() && article->blockFormat
+        && block < article->blocks[cat].size())
+    {
+      ++block;
+      readBlock();
+    }
+    return *this;
+  }
+
+  namespace
+  {
+    bool entryIndexLess(const IndexArticle::Entry& e, unsigned index)
+    {
+      return e.index < index;
+    }
+  }
+
+  bool IndexArticle::Cursor::skipTo(unsigned index)
+  {
+    if (end())
+      return false;
+
+    if (article->blockFormat && entries().back().index < index)
+    {
+      // skip blocks, which do not contain the index, without decoding them
+      const BlocksType& blocks = article->blocks[cat];
+      unsigned b = block + 1;
+      while (b < blocks.size() && blocks[b].maxIndex < index)
+        ++b;
+      block = b;
+      readBlock();
+      if (end())
+        return false;
+    }
+
+    const EntriesType& e = entries();
+    current = std::lower_bound(e.begin() + current, e.end(), index, entryIndexLess) - e.begin();
+    return !end();
+  }
+
   namespace
   {
     class Eof { };
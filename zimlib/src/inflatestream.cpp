@@ -138,6 +138,10 @@ namespace zim
 
       setg(obuffer(), obuffer(), obuffer() + obuffer_size() - stream.avail_out);
 
+      // the data following the end of the stream is not ours
+      if (ret == Z_STREAM_END && gptr() == egptr())
+        return traits_type::eof();
+
     } while (gptr() == egptr());
 
     return sgetc();
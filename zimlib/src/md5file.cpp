@@ -0,0 +1,289 @@
+/*
+ * Copyright (C) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * is provided AS IS, WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, and
+ * NON-INFRINGEMENT.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ */
+
+#include "md5file.h"
+#include "md5.h"
+#include "mutex.h"
+#include <zim/progress.h>
+#include <zim/noncopyable.h>
+#include <algorithm>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+#include <errno.h>
+#include <string.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include "log.h"
+#include "config.h"
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+#ifndef O_LARGEFILE
+#define O_LARGEFILE 0
+#endif
+
+#ifndef O_BINARY
+#define O_BINARY 0
+#endif
+
+log_define("zim.md5file")
+
+namespace zim
+{
+  namespace
+  {
+    class PartReader : private NonCopyable
+    {
+        const streambuf::PartsType& parts;
+        std::vector<int> fds;
+
+      public:
+        explicit PartReader(const streambuf::PartsType& parts_);
+        ~PartReader();
+
+        /// Reads exactly size bytes at offset off of the concatenated parts.
+        void read(char* data, unsigned size, offset_type off);
+    };
+
+    PartReader::PartReader(const streambuf::PartsType& parts_)
+      : parts(parts_)
+    {
+      for (streambuf::PartsType::const_iterator it = parts.begin(); it != parts.end(); ++it)
+      {
+#ifdef HAVE_OPEN64
+        int fd = ::open64(it->first.c_str(), O_RDONLY | O_LARGEFILE | O_BINARY);
+#else
+        int fd = ::open(it->first.c_str(), O_RDONLY | O_LARGEFILE | O_BINARY);
+#endif
+        if (fd < 0)
+        {
+          std::ostringstream msg;
+          msg << "error " << errno << " opening file \"" << it->first << "\": " << strerror(errno);
+          throw std::runtime_error(msg.str());
+        }
+        fds.push_back(fd);
+      }
+    }
+
+    PartReader::~PartReader()
+    {
+      for (std::vector<int>::iterator it = fds.begin(); it != fds.end(); ++it)
+        ::close(*it);
+    }
+
+    void PartReader::read(char* data, unsigned size, offset_type off)
+    {
+      unsigned p = 0;
+      while (p < parts.size() && off >= parts[p].second)
+        off -= parts[p++].second;
+
+      while (size > 0)
+      {
+        if (p >= parts.size())
+          throw std::runtime_error("unexpected end of file");
+
+        offset_type count = std::min(static_cast<offset_type>(size), parts[p].second - off);
+#if defined(_WIN32)
+        int n = ::_lseeki64(fds[p], off, SEEK_SET) < 0 ? -1 : ::read(fds[p], data, count);
+#elif defined(HAVE_PREAD64)
+        ssize_t n = ::pread64(fds[p], data, count, off);
+#else
+        ssize_t n = ::pread(fds[p], data, count, off);
+#endif
+        if (n < 0 && errno == EINTR)
+          continue;
+
+        if (n <= 0)
+        {
+          std::ostringstream msg;
+          if (n < 0)
+            msg << "error " << errno << " reading from file \"" << parts[p].first << "\": " << strerror(errno);
+          else
+            msg << "unexpected end of file \"" << parts[p].first << '"';
+          throw std::runtime_error(msg.str());
+        }
+
+        data += n;
+        size -= n;
+        off += n;
+        if (off >= parts[p].second)
+        {
+          off = 0;
+          ++p;
+        }
+      }
+    }
+
+    // Reads the blocks into a ring of buffers in a separate thread. A slot
+    // is filled by the reader and emptied by the hashing thread.
+    class BlockReader : private NonCopyable
+    {
+        static const unsigned countBuffers = 4;
+
+        PartReader reader;
+        offset_type size;
+
+        Mutex mutex;
+        Condition changed;
+        std::vector<char> buffers[countBuffers];
+        unsigned sizes[countBuffers];
+        bool filled[countBuffers];
+        bool stop;
+        std::string error;
+
+        pthread_t thread;
+
+        static void* start(void* blockReader);
+        void run();
+
+      public:
+        BlockReader(const streambuf::PartsType& parts, offset_type size);
+        /// Stops reading and waits for the reader thread.
+        ~BlockReader();
+
+        /// Waits for block number n and returns its data and size.
+        const char* get(unsigned long n, unsigned& blockSize);
+        /// Returns the slot of block number n to the reader.
+        void release(unsigned long n);
+    };
+
+    BlockReader::BlockReader(const streambuf::PartsType& parts, offset_type size_)
+      : reader(parts),
+        size(size_),
+        stop(false)
+    {
+      for (unsigned n = 0; n < countBuffers; ++n)
+      {
+        buffers[n].resize(md5FileBlockSize);
+        sizes[n] = 0;
+        filled[n] = false;
+      }
+
+      if (pthread_create(&thread, 0, start, this) != 0)
+        throw std::runtime_error("failed to create thread");
+    }
+
+    BlockReader::~BlockReader()
+    {
+      {
+        MutexLock lock(mutex);
+        stop = true;
+        changed.broadcast();
+      }
+
+      pthread_join(thread, 0);
+    }
+
+    void* BlockReader::start(void* blockReader)
+    {
+      static_cast<BlockReader*>(blockReader)->run();
+      return 0;
+    }
+
+    void BlockReader::run()
+    {
+      try
+      {
+        unsigned long n = 0;
+        for (offset_type off = 0; off < size; off += md5FileBlockSize, ++n)
+        {
+          unsigned slot = n % countBuffers;
+
+          {
+            MutexLock lock(mutex);
+            while (filled[slot] && !stop)
+              changed.wait(mutex);
+            if (stop)
+              return;
+          }
+
+          unsigned count = static_cast<unsigned>(std::min(size - off, static_cast<offset_type>(md5FileBlockSize)));
+          reader.read(&buffers[slot][0], count, off);
+
+          MutexLock lock(mutex);
+          sizes[slot] = count;
+          filled[slot] = true;
+          changed.broadcast();
+        }
+      }
+      catch (const std::exception& e)
+      {
+        MutexLock lock(mutex);
+        error = e.what();
+        changed.broadcast();
+      }
+    }
+
+    const char* BlockReader::get(unsigned long n, unsigned& blockSize)
+    {
+      unsigned slot = n % countBuffers;
+
+      MutexLock lock(mutex);
+      while (!filled[slot] && error.empty())
+        changed.wait(mutex);
+
+      if (!filled[slot])
+        throw std::runtime_error(error);
+
+      blockSize = sizes[slot];
+      return &buffers[slot][0];
+    }
+
+    void BlockReader::release(unsigned long n)
+    {
+      MutexLock lock(mutex);
+      filled[n % countBuffers] = false;
+      changed.broadcast();
+    }
+  }
+
+  void md5File(const streambuf::PartsType& parts, offset_type size,
+               unsigned char digest[16], Progress* progress)
+  {
+    log_debug("calculate md5 of " << size << " bytes in " << parts.size() << " parts");
+
+    zim_MD5_CTX context;
+    zim_MD5Init(&context);
+
+    if (size > 0)
+    {
+      BlockReader blockReader(parts, size);
+
+      offset_type done = 0;
+      for (unsigned long n = 0; done < size; ++n)
+      {
+        unsigned blockSize;
+        const char* data = blockReader.get(n, blockSize);
+        zim_MD5Update(&context, reinterpret_cast<const unsigned char*>(data), blockSize);
+        blockReader.release(n);
+
+        done += blockSize;
+        if (progress)
+          progress->progress(done, size);
+      }
+    }
+
+    zim_MD5Final(digest, &context);
+  }
+}
@@ -0,0 +1,44 @@
+/*
+ * Copyright (C) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * is provided AS IS, WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, and
+ * NON-INFRINGEMENT.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ */
+
+#ifndef ZIM_MD5FILE_H
+#define ZIM_MD5FILE_H
+
+#include <zim/fstream.h>
+
+namespace zim
+{
+  class Progress;
+
+  /**
+     Calculates the md5 digest of the first size bytes of a file, which may
+     be split into parts.
+
+     A reader thread reads blocks of md5FileBlockSize bytes at aligned
+     positions with positional reads into a small ring of buffers, while the
+     calling thread hashes the blocks already read. So hashing and disk I/O
+     overlap and the speed is limited by the slower one of them.
+   */
+  void md5File(const streambuf::PartsType& parts, offset_type size,
+               unsigned char digest[16], Progress* progress = 0);
+
+  static const unsigned md5FileBlockSize = 1024 * 1024;
+}
+
+#endif // ZIM_MD5FILE_H
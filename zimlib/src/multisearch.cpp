@@ -0,0 +1,333 @@
+/*
+ * Copyright (C) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * is provided AS IS, WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, and
+ * NON-INFRINGEMENT.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ */
+
+#include <zim/multisearch.h>
+#include "threadpool.h"
+#include "mutex.h"
+#include "envvalue.h"
+#include <algorithm>
+#include <sys/time.h>
+#include "log.h"
+
+log_define("zim.multisearch")
+
+namespace zim
+{
+  namespace
+  {
+    // a file of the library
+    struct LibraryFile
+    {
+      File articlefile;
+      File indexfile;
+      Mutex mutex;      // held while a search uses the files
+
+      LibraryFile(const File& articlefile_, const File& indexfile_)
+        : articlefile(articlefile_),
+          indexfile(indexfile_)
+        { }
+    };
+
+    // State of one query shared by the caller and the searches of the
+    // files. It is deleted by the last of them to finish.
+    class Query
+    {
+        Mutex mutex;
+        Condition finished;
+        unsigned refs;
+        size_type pending;
+        bool abandoned;
+
+      public:
+        const std::string expr;
+        const unsigned limit;
+        const bool hasDeadline;
+        const struct timespec deadline;
+        std::vector<Search::Results> results;
+        std::vector<bool> done;
+
+        Query(const std::string& expr_, unsigned limit_, size_type files,
+              bool hasDeadline_, const struct timespec& deadline_)
+          : refs(files + 1),
+            pending(files),
+            abandoned(false),
+            expr(expr_),
+            limit(limit_),
+            hasDeadline(hasDeadline_),
+            deadline(deadline_),
+            results(files),
+            done(files, false)
+          { }
+
+        bool expired() const;
+
+        /// Stores the results of a file unless the caller gave up waiting.
+        /// The files of the results must be locked.
+        void setResults(size_type fileNo, Search::Results& r);
+        /// Waits until all files are searched or the deadline passes.
+        void wait();
+
+        /// Called by the search of a file, when it is finished.
+        void fileFinished();
+        /// Called by the caller after reading the results.
+        void release();
+    };
+
+    bool Query::expired() const
+    {
+      if (!hasDeadline)
+        return false;
+
+      struct timeval tv;
+      gettimeofday(&tv, 0);
+      return tv.tv_sec > deadline.tv_sec
+          || (tv.tv_sec == deadline.tv_sec && tv.tv_usec * 1000 >= deadline.tv_nsec);
+    }
+
+    void Query::setResults(size_type fileNo, Search::Results& r)
+    {
+      MutexLock lock(mutex);
+      if (!abandoned)
+      {
+        results[fileNo].setTotalCount(r.getTotalCount());
+        results[fileNo].swap(r);
+        done[fileNo] = true;
+      }
+    }
+
+    void Query::wait()
+    {
+      MutexLock lock(mutex);
+      while (pending > 0)
+      {
+        if (!hasDeadline)
+          finished.wait(mutex);
+        else if (!finished.wait(mutex, deadline) && pending > 0)
+        {
+          log_debug("deadline passed with " << pending << " files pending");
+          break;
+        }
+      }
+
+      // from now on the results are read by the caller only
+      abandoned = true;
+    }
+
+    void Query::fileFinished()
+    {
+      bool last;
+      {
+        MutexLock lock(mutex);
+        --pending;
+        finished.signal();
+        last = (--refs == 0);
+      }
+
+      if (last)
+        delete this;
+    }
+
+    void Query::release()
+    {
+      bool last;
+      {
+        MutexLock lock(mutex);
+        last = (--refs == 0);
+      }
+
+      if (last)
+        delete this;
+    }
+
+    class SearchTask : public ThreadPool::Task
+    {
+        Query* query;
+        LibraryFile* file;
+        size_type fileNo;
+
+      public:
+        SearchTask(Query* query_, LibraryFile* file_, size_type fileNo_)
+          : query(query_),
+            file(file_),
+            fileNo(fileNo_)
+          { }
+
+        ~SearchTask()
+          { query->fileFinished(); }
+
+        void run();
+    };
+
+    void SearchTask::run()
+    {
+      MutexLock lock(file->mutex);
+
+      if (query->expired())
+      {
+        log_debug("skip file " << fileNo << " after the deadline");
+        return;
+      }
+
+      Search::Results results;
+      try
+      {
+        Search(file->articlefile, file->indexfile).search(results, query->expr, query->limit);
+      }
+      catch (const std::exception& e)
+      {
+        log_warn("search in \"" << file->articlefile.getFilename() << "\" failed: " << e.what());
+        return;
+      }
+
+      query->setResults(fileNo, results);
+
+      // results, which came too late, are released while the file is locked
+      results.clear();
+    }
+
+    // position in the results of one file
+    typedef std::pair<size_type, size_type> MergePosType;  // file, result
+
+    // orders the heads of the per file results, best on top of the heap
+    class MergeLess
+    {
+        const std::vector<Search::Results>& results;
+
+      public:
+        explicit MergeLess(const std::vector<Search::Results>& results_)
+          : results(results_)
+          { }
+
+        bool operator() (const MergePosType& p1, const MergePosType& p2) const
+        {
+          double pr1 = results[p1.first][p1.second].getPriority();
+          double pr2 = results[p2.first][p2.second].getPriority();
+          return pr1 < pr2 || (pr1 == pr2 && p1.first > p2.first);
+        }
+    };
+  }
+
+  class MultiSearchImpl
+  {
+    public:
+      std::vector<LibraryFile*> files;
+      ThreadPool* pool;
+
+      explicit MultiSearchImpl(unsigned threads)
+        : pool(new ThreadPool(threads))
+        { }
+
+      ~MultiSearchImpl()
+      {
+        // wait for the searches before the files go away
+        delete pool;
+        for (std::vector<LibraryFile*>::iterator it = files.begin(); it != files.end(); ++it)
+          delete *it;
+      }
+  };
+
+  MultiSearch::MultiSearch(unsigned threads)
+    : impl(new MultiSearchImpl(threads > 0 ? threads : envValue("ZIM_SEARCHTHREADS", 4)))
+  {
+  }
+
+  MultiSearch::~MultiSearch()
+  {
+    delete impl;
+  }
+
+  void MultiSearch::add(const File& zimfile)
+  {
+    add(zimfile, zimfile);
+  }
+
+  void MultiSearch::add(const File& articlefile, const File& indexfile)
+  {
+    impl->files.push_back(new LibraryFile(articlefile, indexfile));
+  }
+
+  size_type MultiSearch::size() const
+  {
+    return impl->files.size();
+  }
+
+  unsigned MultiSearch::getCountThreads() const
+  {
+    return impl->pool->size();
+  }
+
+  size_type MultiSearch::search(Results& results, const std::string& expr, unsigned limit, unsigned timeout)
+  {
+    log_debug("search \"" << expr << "\" in " << impl->files.size() << " files; limit " << limit << " timeout " << timeout << "ms");
+
+    struct timespec deadline;
+    deadline.tv_sec = 0;
+    deadline.tv_nsec = 0;
+    if (timeout > 0)
+    {
+      struct timeval tv;
+      gettimeofday(&tv, 0);
+      unsigned long usec = tv.tv_usec + (timeout % 1000) * 1000ul;
+      deadline.tv_sec = tv.tv_sec + timeout / 1000 + usec / 1000000;
+      deadline.tv_nsec = (usec % 1000000) * 1000;
+    }
+
+    Query* query = new Query(expr, limit, impl->files.size(), timeout > 0, deadline);
+    for (size_type n = 0; n < impl->files.size(); ++n)
+      impl->pool->add(new SearchTask(query, impl->files[n], n));
+
+    query->wait();
+
+    // merge the per file results, which are ordered by priority already
+    std::vector<MergePosType> heap;
+    size_type totalCount = 0;
+    size_type countDone = 0;
+    for (size_type n = 0; n < query->results.size(); ++n)
+    {
+      if (!query->done[n])
+        continue;
+      ++countDone;
+      totalCount += query->results[n].getTotalCount();
+      if (!query->results[n].empty())
+        heap.push_back(MergePosType(n, 0));
+    }
+
+    MergeLess mergeLess(query->results);
+    std::make_heap(heap.begin(), heap.end(), mergeLess);
+
+    results.setExpression(expr);
+    results.setTotalCount(totalCount);
+    while (!heap.empty() && results.size() < limit)
+    {
+      std::pop_heap(heap.begin(), heap.end(), mergeLess);
+      MergePosType& p = heap.back();
+      results.push_back(query->results[p.first][p.second]);
+      if (++p.second < query->results[p.first].size())
+        std::push_heap(heap.begin(), heap.end(), mergeLess);
+      else
+        heap.pop_back();
+    }
+
+    log_debug(results.size() << " results from " << countDone << " of " << impl->files.size() << " files");
+
+    query->release();
+    return countDone;
+  }
+
+}
@@ -0,0 +1,83 @@
+/*
+ * Copyright (C) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * is provided AS IS, WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, and
+ * NON-INFRINGEMENT.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ */
+
+#ifndef ZIM_MUTEX_H
+#define ZIM_MUTEX_H
+
+#include <zim/noncopyable.h>
+#include <pthread.h>
+#include <time.h>
+
+namespace zim
+{
+  class Mutex : private NonCopyable
+  {
+      friend class Condition;
+      pthread_mutex_t mutex;
+
+    public:
+      Mutex()
+        { pthread_mutex_init(&mutex, 0); }
+      ~Mutex()
+        { pthread_mutex_destroy(&mutex); }
+
+      void lock()
+        { pthread_mutex_lock(&mutex); }
+      void unlock()
+        { pthread_mutex_unlock(&mutex); }
+  };
+
+  class MutexLock : private NonCopyable
+  {
+      Mutex& mutex;
+
+    public:
+      explicit MutexLock(Mutex& mutex_)
+        : mutex(mutex_)
+        { mutex.lock(); }
+      ~MutexLock()
+        { mutex.unlock(); }
+  };
+
+  class Condition : private NonCopyable
+  {
+      pthread_cond_t cond;
+
+    public:
+      Condition()
+        { pthread_cond_init(&cond, 0); }
+      ~Condition()
+        { pthread_cond_destroy(&cond); }
+
+      /// Waits for a signal. The mutex must be locked.
+      void wait(Mutex& mutex)
+        { pthread_cond_wait(&cond, &mutex.mutex); }
+      /// Waits for a signal until the absolute time abstime (see
+      /// gettimeofday). Returns false on timeout.
+      bool wait(Mutex& mutex, const struct timespec& abstime)
+        { return pthread_cond_timedwait(&cond, &mutex.mutex, &abstime) == 0; }
+
+      void signal()
+        { pthread_cond_signal(&cond); }
+      void broadcast()
+        { pthread_cond_broadcast(&cond); }
+  };
+}
+
+#endif // ZIM_MUTEX_H
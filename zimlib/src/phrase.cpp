@@ -0,0 +1,149 @@
+/*
+ * Copyright (C) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * is provided AS IS, WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, and
+ * NON-INFRINGEMENT.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ */
+
+#include "phrase.h"
+#include <algorithm>
+
+namespace zim
+{
+  namespace
+  {
+    // The postings of a word in all categories merged by article index.
+    class WordPostings
+    {
+        std::vector<IndexArticle::Cursor> cursors;
+
+      public:
+        explicit WordPostings(IndexArticle& article)
+        {
+          if (article.getTotalCount() == 0)
+            return;
+          for (unsigned cat = 0; cat < 4; ++cat)
+            if (article.getCategoryCount(cat) > 0)
+              cursors.push_back(IndexArticle::Cursor(article, cat));
+        }
+
+        /// Moves to the first article not less than index and returns its
+        /// index or false, when there is none.
+        bool skipTo(unsigned index, unsigned& found)
+        {
+          bool any = false;
+          for (std::vector<IndexArticle::Cursor>::iterator it = cursors.begin(); it != cursors.end(); ++it)
+          {
+            if (it->skipTo(index) && (!any || (*it)->index < found))
+            {
+              found = (*it)->index;
+              any = true;
+            }
+          }
+          return any;
+        }
+
+        /// Appends the sorted positions in article index and moves past it.
+        void getPositions(unsigned index, std::vector<unsigned>& positions)
+        {
+          positions.clear();
+          for (std::vector<IndexArticle::Cursor>::iterator it = cursors.begin(); it != cursors.end(); ++it)
+            for ( ; !it->end() && (*it)->index == index; ++*it)
+              positions.push_back((*it)->pos);
+          std::sort(positions.begin(), positions.end());
+        }
+    };
+  }
+
+  bool matchPhrase(const std::vector<std::string>& words,
+                   const std::vector<std::vector<unsigned> >& positions, unsigned gap)
+  {
+    // ends of the matches of the phrase up to the current word
+    std::vector<unsigned> ends;
+    for (std::vector<unsigned>::const_iterator it = positions[0].begin(); it != positions[0].end(); ++it)
+      ends.push_back(*it + words[0].size());
+
+    for (unsigned w = 1; w < words.size() && !ends.empty(); ++w)
+    {
+      std::vector<unsigned> next;
+      for (std::vector<unsigned>::const_iterator it = positions[w].begin(); it != positions[w].end(); ++it)
+      {
+        // the closest preceding end must not be too far away
+        std::vector<unsigned>::const_iterator e = std::lower_bound(ends.begin(), ends.end(), *it);
+        if (e != ends.begin() && *it - *(e - 1) <= gap)
+          next.push_back(*it + words[w].size());
+      }
+      ends.swap(next);
+    }
+
+    return !ends.empty();
+  }
+
+  void findPhrase(std::vector<IndexArticle>& articles, const std::vector<std::string>& words,
+                  unsigned gap, const std::vector<unsigned>* candidates, std::vector<unsigned>& result)
+  {
+    std::vector<WordPostings> postings;
+    for (std::vector<IndexArticle>::iterator it = articles.begin(); it != articles.end(); ++it)
+      postings.push_back(WordPostings(*it));
+
+    std::vector<std::vector<unsigned> > positions(words.size());
+    std::vector<unsigned>::const_iterator c;
+    if (candidates)
+      c = candidates->begin();
+
+    unsigned target = 0;
+    while (true)
+    {
+      // move all words to the same article, skipping the articles, which
+      // lack one of them
+      bool aligned = false;
+      while (!aligned)
+      {
+        aligned = true;
+
+        if (candidates)
+        {
+          c = std::lower_bound(c, candidates->end(), target);
+          if (c == candidates->end())
+            return;
+          if (*c > target)
+            target = *c;
+        }
+
+        for (std::vector<WordPostings>::iterator it = postings.begin(); it != postings.end(); ++it)
+        {
+          unsigned found = 0;
+          if (!it->skipTo(target, found))
+            return;
+          if (found > target)
+          {
+            target = found;
+            aligned = false;
+            break;
+          }
+        }
+      }
+
+      for (unsigned w = 0; w < postings.size(); ++w)
+        postings[w].getPositions(target, positions[w]);
+
+      if (matchPhrase(words, positions, gap))
+        result.push_back(target);
+
+      ++target;
+    }
+  }
+
+}
@@ -0,0 +1,42 @@
+/*
+ * Copyright (C) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * is provided AS IS, WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, and
+ * NON-INFRINGEMENT.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ */
+
+#ifndef ZIM_PHRASE_H
+#define ZIM_PHRASE_H
+
+#include <zim/indexarticle.h>
+#include <string>
+#include <vector>
+
+namespace zim
+{
+  /// Returns true, if the words occur in order in an article, each
+  /// starting at most gap bytes after the end of the previous one.
+  /// positions holds the sorted start positions of each word.
+  bool matchPhrase(const std::vector<std::string>& words,
+                   const std::vector<std::vector<unsigned> >& positions, unsigned gap);
+
+  /// Intersects the postings of the words of a phrase and returns the
+  /// sorted indexes of the articles, which contain the phrase. When
+  /// candidates is given, only these articles are checked.
+  void findPhrase(std::vector<IndexArticle>& articles, const std::vector<std::string>& words,
+                  unsigned gap, const std::vector<unsigned>* candidates, std::vector<unsigned>& result);
+}
+
+#endif // ZIM_PHRASE_H
@@ -22,8 +22,13 @@
 #include <zim/indexarticle.h>
 #include <sstream>
 #include "log.h"
+#include "searchcache.h"
+#include "snippet.h"
+#include "phrase.h"
 #include <map>
+#include <set>
 #include <math.h>
+#include <algorithm>
 #include <cctype>
 #include <stdexcept>
 
@@ -43,6 +48,127 @@ namespace zim
                && s1.getArticle().getTitle() > s2.getArticle().getTitle());
         }
     };
+
+    // priority and article index of a candidate
+    typedef std::pair<double, size_type> RankType;
+
+    // Orders ranks by priority. Ties are broken by the article index, so
+    // that the selection does not need the title.
+    class RankGt
+    {
+      public:
+        bool operator() (const RankType& r1, const RankType& r2) const
+        {
+          return r1.first > r2.first
+              || (r1.first == r2.first && r1.second < r2.second);
+        }
+    };
+
+    // Rank at least that many matches, when a query is cached, so that
+    // paging through the first results does not search again.
+    const unsigned minCacheDepth = 100;
+
+    // a word of a query and the weight added by leading '+'
+    struct QueryWord
+    {
+      std::string word;
+      unsigned addweight;
+    };
+
+    // Words in quotes form a phrase: each word must start at most gap
+    // bytes after the end of the previous one.
+    struct Phrase
+    {
+      std::vector<std::string> words;
+      unsigned gap;
+    };
+
+    // Splits expr into lower case words. A quoted group of words ("a b")
+    // is a phrase; with a suffix ~n ("a b"~n) the words may be up to n
+    // bytes apart.
+    void parseQuery(const std::string& expr, std::vector<QueryWord>& words, std::vector<Phrase>& phrases)
+    {
+      std::istringstream ssearch(expr);
+      std::string token;
+      bool inPhrase = false;
+      unsigned phraseWeight = 0;
+
+      while (ssearch >> token)
+      {
+        unsigned addweight = 0;
+        if (!inPhrase)
+        {
+          while (token.size() > 0 && token.at(0) == '+')
+          {
+            ++addweight;
+            token.erase(0, 1);
+          }
+
+          if (token.size() > 0 && token.at(0) == '"')
+          {
+            token.erase(0, 1);
+            inPhrase = true;
+            phraseWeight = addweight;
+            phrases.push_back(Phrase());
+            phrases.back().gap = Search::getPhraseGap();
+          }
+        }
+        else
+          addweight = phraseWeight;
+
+        bool endPhrase = false;
+        if (inPhrase)
+        {
+          std::string::size_type q = token.rfind('"');
+          if (q != std::string::npos)
+          {
+            if (q + 1 < token.size() && token.at(q + 1) == '~')
+            {
+              std::istringstream gap(token.substr(q + 2));
+              unsigned g;
+              if (gap >> g)
+                phrases.back().gap = g;
+            }
+            token.erase(q);
+            endPhrase = true;
+          }
+        }
+
+        if (token.empty())
+        {
+          log_warn("empty token");
+        }
+        else
+        {
+          for (std::string::iterator it = token.begin(); it != token.end(); ++it)
+            *it = std::tolower(*it);
+
+          QueryWord w;
+          w.word = token;
+          w.addweight = addweight;
+          words.push_back(w);
+
+          if (inPhrase)
+            phrases.back().words.push_back(token);
+        }
+
+        if (endPhrase)
+          inPhrase = false;
+      }
+
+      // a phrase of no words does not restrict anything
+      for (std::vector<Phrase>::iterator it = phrases.begin(); it != phrases.end(); )
+        if (it->words.empty())
+          it = phrases.erase(it);
+        else
+          ++it;
+    }
+
+    void appendFileKey(std::ostream& out, const File& file)
+    {
+      out << '\0' << file.getFilename() << '\0' << file.getFileheader().getUuid()
+          << '\0' << file.getMTime();
+    }
   }
 
   double SearchResult::getPriority() const
@@ -67,14 +193,6 @@ namespace zim
                                 + Search::getWeightPlus() * itw->second.addweight)
                         + Search::getWeightOccOff()
                         + Search::getWeightPlus() * itw->second.addweight;
-
-        std::string title = article.getTitle();
-        for (std::string::iterator it = title.begin(); it != title.end(); ++it)
-          *it = std::tolower(*it);
-
-        //std::string::size_type p = title.find(itw->first);
-        //if (p != std::string::npos)
-          //priority *= Search::getWeightTitle() / (p + 1) / title.size();
       }
 
       log_debug("priority1: " << priority);
@@ -108,11 +226,16 @@ namespace zim
         for (itp = posList.begin(); itp != posList.end(); ++itp)
           priority += Search::getWeightPos() / pow(1.01, static_cast<double>(itp->first));
 
+      // The end of the last match approximates the article size here, so
+      // that the priority is computed from the index data only.
       if (Search::getWeightPosRel())
+      {
+        double extent = posList.rbegin()->first + posList.rbegin()->second.size();
         for (itp = posList.begin(); itp != posList.end(); ++itp)
-          priority += Search::getWeightPosRel() * itp->first / article.getData().size();
+          priority += Search::getWeightPosRel() * itp->first / extent;
+      }
 
-      log_debug("priority of article " << article.getIndex() << " \"" << article.getTitle() << "\", " << wordList.size() << " words: " << priority);
+      log_debug("priority of article " << article.getIndex() << ", " << wordList.size() << " words: " << priority);
     }
 
     return priority;
@@ -133,55 +256,89 @@ namespace zim
   double Search::weightPosRel = 0;
   double Search::weightDistinctWords = 50;
   unsigned Search::searchLimit = 10000;
+  unsigned Search::phraseGap = 8;
 
-  void Search::search(Results& results, const std::string& expr)
+  void Search::search(Results& results, const std::string& expr, unsigned limit)
   {
     log_trace("search articles with expression \"" << expr << '"');
 
-    std::istringstream ssearch(expr);
-    std::string token;
+    std::vector<QueryWord> words;
+    std::vector<Phrase> phrases;
+    parseQuery(expr, words, phrases);
 
-    // map from article-idx to article + relevance-informations
-    typedef std::map<size_type, SearchResult> IndexType;
-    IndexType index;
-
-    while (ssearch >> token)
+    // Phrases are evaluated first. Only articles matching all of them are
+    // ranked, so the postings of the words are read for these only.
+    bool restricted = !phrases.empty();
+    std::vector<unsigned> matching;
+    for (std::vector<Phrase>::const_iterator it = phrases.begin(); it != phrases.end(); ++it)
     {
-      unsigned addweight = 0;
-      while (token.size() > 0 && token.at(0) == '+')
+      std::vector<IndexArticle> articles;
+      articles.reserve(it->words.size());
+      for (std::vector<std::string>::const_iterator w = it->words.begin(); w != it->words.end(); ++w)
       {
-        ++addweight;
-        token.erase(0, 1);
+        size_type termIdx;
+        articles.push_back(indexfile.getTitleDictionary('X').find(*w, termIdx)
+                             ? IndexArticle(indexfile.getArticle(termIdx)) : IndexArticle(Article()));
       }
 
-      if (token.empty())
-      {
-        log_warn("empty token");
-        continue;
-      }
+      std::vector<unsigned> m;
+      findPhrase(articles, it->words, it->gap, it == phrases.begin() ? 0 : &matching, m);
+      matching.swap(m);
 
-      for (std::string::iterator it = token.begin(); it != token.end(); ++it)
-        *it = std::tolower(*it);
+      log_debug(matching.size() << " articles match phrase " << it - phrases.begin());
+    }
+
+    // map from article-idx to article + relevance-informations
+    typedef std::map<size_type, SearchResult> IndexType;
+    IndexType index;
+
+    for (std::vector<QueryWord>::const_iterator w = words.begin(); w != words.end(); ++w)
+    {
+      const std::string& token = w->word;
+      unsigned addweight = w->addweight;
 
       log_debug("search for token \"" << token << '"');
 
-      IndexArticle indexarticle = indexfile.getArticleByTitle('X', token);
+      // the term dictionary is kept in memory, so looking up a term does
+      // not read any directory entries
+      size_type termIdx;
+      IndexArticle indexarticle = indexfile.getTitleDictionary('X').find(token, termIdx)
+                                ? indexfile.getArticle(termIdx) : Article();
 
       if (indexarticle.getTotalCount() > 0)
       {
         for (unsigned cat = 0; cat < 4; ++cat)
         {
-          const IndexArticle::EntriesType ent = indexarticle.getCategory(cat);
-          for (IndexArticle::EntriesType::const_iterator it = ent.begin(); it != ent.end(); ++it)
+          if (indexarticle.getCategoryCount(cat) == 0)
+            continue;
+
+          IndexArticle::Cursor c(indexarticle, cat);
+          std::vector<unsigned>::iterator m = matching.begin();
+          while (!c.end())
           {
-            size_type articleIdx = it->index;
-            size_type position = it->pos;
+            // pass over the entries of articles not matching the phrases
+            if (restricted)
+            {
+              m = std::lower_bound(m, matching.end(), c->index);
+              if (m == matching.end())
+                break;
+              if (*m != c->index)
+              {
+                if (!c.skipTo(*m))
+                  break;
+                continue;
+              }
+            }
+
+            size_type articleIdx = c->index;
+            size_type position = c->pos;
 
             IndexType::iterator itIt = index.insert(
               IndexType::value_type(articleIdx,
                 SearchResult(articlefile.getArticle(articleIdx)))).first;
 
             itIt->second.foundWord(token, position, addweight + 3 - cat);
+            ++c;
           }
         }
       }
@@ -193,6 +350,8 @@ namespace zim
         for (Results::const_iterator it = results.begin(); it != results.end(); ++it)
         {
           size_type articleIdx = it->getArticle().getIndex();
+          if (restricted && !std::binary_search(matching.begin(), matching.end(), articleIdx))
+            continue;
 
           IndexType::iterator itIt = index.insert(
             IndexType::value_type(articleIdx,
@@ -203,38 +362,266 @@ namespace zim
       }
     }
 
-    log_debug("copy/filter " << index.size() << " articles");
-    results.setExpression(expr);
+    // articles with a single position are only used, when there is nothing better
+    unsigned minPositions = 1;
     for (IndexType::const_iterator it = index.begin(); it != index.end(); ++it)
     {
       if (it->second.getCountPositions() > 1)
-        results.push_back(it->second);
-      //else
-        //log_debug("discard article " << it->first);
+      {
+        minPositions = 2;
+        break;
+      }
     }
 
-    if (results.empty())
+    log_debug("rank " << index.size() << " articles; limit " << limit);
+
+    // keep the best limit ranks in a heap with the worst one on top
+    std::vector<RankType> ranks;
+    size_type totalCount = 0;
+    RankGt rankGt;
+    for (IndexType::const_iterator it = index.begin(); it != index.end(); ++it)
     {
-      for (IndexType::const_iterator it = index.begin(); it != index.end(); ++it)
-        results.push_back(it->second);
+      if (it->second.getCountPositions() < minPositions)
+        continue;
+
+      ++totalCount;
+      RankType rank(it->second.getPriority(), it->first);
+      if (ranks.size() < limit)
+      {
+        ranks.push_back(rank);
+        std::push_heap(ranks.begin(), ranks.end(), rankGt);
+      }
+      else if (!ranks.empty() && rankGt(rank, ranks.front()))
+      {
+        std::pop_heap(ranks.begin(), ranks.end(), rankGt);
+        ranks.back() = rank;
+        std::push_heap(ranks.begin(), ranks.end(), rankGt);
+      }
+    }
+
+    std::sort_heap(ranks.begin(), ranks.end(), rankGt);
+
+    log_debug("copy " << ranks.size() << " of " << totalCount << " articles");
+    results.setExpression(expr);
+    results.setTotalCount(totalCount);
+    for (std::vector<RankType>::const_iterator it = ranks.begin(); it != ranks.end(); ++it)
+      results.push_back(index[it->second]);
+
+    // the titles break ties in the final order - this reads the dirents of
+    // the selected articles only
+    std::stable_sort(results.begin(), results.end(), PriorityGt());
+  }
+
+  void Search::searchCached(Results& results, const std::string& expr, unsigned offset, unsigned count)
+  {
+    log_trace("search articles with expression \"" << expr << "\" from " << offset << " count " << count);
+
+    // The key is the expression normalized as search() reads it - lower
+    // case tokens separated by a single space - followed by the identity
+    // of the files and the weights, which change the ranking. The order of
+    // the tokens is kept, since words found at the same position are
+    // ranked by the order of the tokens.
+    std::istringstream ssearch(expr);
+    std::ostringstream key;
+    std::string token;
+    for (bool first = true; ssearch >> token; first = false)
+    {
+      for (std::string::iterator it = token.begin(); it != token.end(); ++it)
+        *it = std::tolower(*it);
+      key << (first ? "" : " ") << token;
+    }
+
+    appendFileKey(key, indexfile);
+    appendFileKey(key, articlefile);
+    key << '\0' << weightOcc << ' ' << weightOccOff << ' ' << weightPlus
+        << ' ' << weightDist << ' ' << weightPos << ' ' << weightPosRel
+        << ' ' << weightDistinctWords << ' ' << phraseGap;
+
+    SearchCache& cache = SearchCache::getInstance();
+    SearchCache::Hits page;
+    size_type totalCount;
+    size_type depth;
+    if (!cache.get(key.str(), offset, count, page, totalCount, depth))
+    {
+      unsigned limit = std::max(std::max(offset + count, 2 * depth), minCacheDepth);
+      Results ranked;
+      Results::size_type size;
+      while (true)
+      {
+        log_debug("rank " << limit << " matches of \"" << expr << '"');
+
+        ranked.clear();
+        search(ranked, expr, limit);
+
+        // Matches with the same priority as the last one may be cut off
+        // arbitrarily by the limit. They are dropped, so that the cached
+        // ranking is always a prefix of the complete ranking and pages do
+        // not overlap, when the ranking is extended later.
+        size = ranked.size();
+        if (size < ranked.getTotalCount())
+        {
+          while (size > 0 && ranked[size - 1].getPriority() == ranked.back().getPriority())
+            --size;
+        }
+
+        if (size >= offset + count || ranked.size() >= ranked.getTotalCount()
+          || limit >= std::numeric_limits<unsigned>::max() / 2)
+          break;
+
+        limit *= 2;
+      }
+
+      SearchCache::Hits hits(size);
+      for (Results::size_type n = 0; n < size; ++n)
+      {
+        hits[n].index = ranked[n].getArticle().getIndex();
+        hits[n].priority = static_cast<float>(ranked[n].getPriority());
+      }
+
+      totalCount = ranked.getTotalCount();
+      cache.put(key.str(), hits, totalCount);
+
+      if (offset < hits.size())
+        page.assign(hits.begin() + offset,
+                    offset + count < hits.size() ? hits.begin() + offset + count : hits.end());
+    }
+
+    results.setExpression(expr);
+    results.setTotalCount(totalCount);
+    results.setOffset(offset);
+    for (SearchCache::Hits::const_iterator it = page.begin(); it != page.end(); ++it)
+      results.push_back(SearchResult(articlefile.getArticle(it->index), it->priority));
+  }
+
+  void Search::findSimilar(Results& results, char ns, const std::string& title,
+                           unsigned limit, unsigned maxDistance)
+  {
+    log_debug("find titles in namespace " << ns << " similar to \"" << title << '"');
+
+    const TitleIndex& titleIndex = articlefile.getTitleIndex(ns);
+    TitleIndex::SimilarResults similar;
+    titleIndex.findSimilar(title, similar, limit, maxDistance);
+
+    for (TitleIndex::SimilarResults::const_iterator it = similar.begin(); it != similar.end(); ++it)
+      results.push_back(SearchResult(articlefile.getArticle(titleIndex.getArticleIndex(it->second)),
+                                     maxDistance + 1 - it->first));
+
+    log_debug(results.size() << " similar titles found");
+  }
+
+  size_type Search::getCacheSize()
+  {
+    return SearchCache::getInstance().getMaxSize();
+  }
+
+  void Search::setCacheSize(size_type bytes)
+  {
+    SearchCache::getInstance().setMaxSize(bytes);
+  }
+
+  void Search::suggest(Results& results, char ns, const std::string& praefix, unsigned limit)
+  {
+    log_debug("suggest titles in namespace " << ns << " for praefix \"" << praefix << '"');
+
+    Autocomplete::Results completions;
+    if (!articlefile.getAutocomplete(ns).find(praefix, completions, limit))
+    {
+      find(results, ns, praefix, limit);
+      return;
     }
 
-    log_debug("sort " << results.size() << " articles");
-    std::sort(results.begin(), results.end(), PriorityGt());
+    for (Autocomplete::Results::size_type n = 0; n < completions.size(); ++n)
+      results.push_back(SearchResult(articlefile.getArticle(completions[n]), completions.size() - n));
+
+    log_debug(results.size() << " suggestions");
+  }
+
+  namespace
+  {
+    // article index or cluster number and number of a result
+    typedef std::pair<size_type, Search::Results::size_type> ResultOrderType;
+  }
+
+  void Search::getSnippets(const Results& results, std::vector<std::string>& snippets, unsigned size)
+  {
+    std::vector<QueryWord> words;
+    std::vector<Phrase> phrases;
+    parseQuery(results.getExpression(), words, phrases);
+
+    std::vector<ResultOrderType> order;
+    order.reserve(results.size());
+    for (Results::size_type n = 0; n < results.size(); ++n)
+      order.push_back(ResultOrderType(results[n].getArticle().getIndex(), n));
+    std::sort(order.begin(), order.end());
+
+    // Collect the positions of the words in the result articles from the
+    // index. The cursors skip to the articles, so only the blocks holding
+    // them are decoded.
+    std::vector<std::vector<HighlightType> > positions(results.size());
+    std::set<std::string> seen;
+    for (std::vector<QueryWord>::const_iterator w = words.begin(); w != words.end(); ++w)
+    {
+      if (!seen.insert(w->word).second)
+        continue;
+
+      size_type termIdx;
+      if (!indexfile.getTitleDictionary('X').find(w->word, termIdx))
+        continue;
+
+      IndexArticle indexarticle(indexfile.getArticle(termIdx));
+      for (unsigned cat = 0; cat < 4; ++cat)
+      {
+        if (indexarticle.getCategoryCount(cat) == 0)
+          continue;
+
+        IndexArticle::Cursor c(indexarticle, cat);
+        for (std::vector<ResultOrderType>::const_iterator it = order.begin();
+             it != order.end() && c.skipTo(it->first); ++it)
+          for ( ; !c.end() && c->index == it->first; ++c)
+            positions[it->second].push_back(HighlightType(c->pos, w->word.size()));
+      }
+    }
+
+    // read the articles ordered by cluster
+    for (std::vector<ResultOrderType>::iterator it = order.begin(); it != order.end(); ++it)
+      it->first = results[it->second].getArticle().getDirent().getClusterNumber();
+    std::sort(order.begin(), order.end());
+
+    snippets.clear();
+    snippets.resize(results.size());
+    for (std::vector<ResultOrderType>::const_iterator it = order.begin(); it != order.end(); ++it)
+    {
+      const Article& article = results[it->second].getArticle();
+      Blob data = article.getData();
+
+      // The indexer numbers the bytes of the title and the article data
+      // consecutively, so positions before the end of the title are
+      // matches in the title.
+      size_type titleSize = article.getTitle().size();
+      std::vector<HighlightType> highlights;
+      const std::vector<HighlightType>& p = positions[it->second];
+      for (std::vector<HighlightType>::const_iterator h = p.begin(); h != p.end(); ++h)
+        if (h->first >= titleSize)
+          highlights.push_back(HighlightType(h->first - titleSize, h->second));
+      std::sort(highlights.begin(), highlights.end());
+
+      snippets[it->second] = makeSnippet(data.data(), data.size(), highlights, size);
+    }
   }
 
   void Search::find(Results& results, char ns, const std::string& praefix, unsigned limit)
   {
     log_debug("find results in namespace " << ns << " for praefix \"" << praefix << '"');
-    for (File::const_iterator pos = articlefile.findByTitle(ns, praefix);
-         pos != articlefile.end() && results.size() < limit; ++pos)
+    const TitleDictionary& titles = articlefile.getTitleDictionary(ns);
+    for (TitleDictionary::const_iterator it = titles.lower_bound(praefix);
+         it != titles.end() && results.size() < limit; ++it)
     {
-      if (ns != pos->getNamespace() || pos->getTitle().compare(0, praefix.size(), praefix) > 0)
+      if (it->compare(0, praefix.size(), praefix) > 0)
       {
-        log_debug("article " << pos->getNamespace() << ", \"" << pos->getTitle() << "\" does not match " << ns << ", \"" << praefix << '"');
+        log_debug("article " << ns << ", \"" << *it << "\" does not match " << ns << ", \"" << praefix << '"');
         break;
       }
-      results.push_back(SearchResult(*pos));
+      results.push_back(SearchResult(articlefile.getArticle(it.getIndex())));
     }
     log_debug(results.size() << " articles in result");
   }
@@ -243,16 +630,17 @@ namespace zim
     const std::string& end, unsigned limit)
   {
     log_debug("find results in namespace " << ns << " for praefix \"" << begin << '"');
-    for (File::const_iterator pos = articlefile.findByTitle(ns, begin);
-         pos != articlefile.end() && results.size() < limit; ++pos)
+    const TitleDictionary& titles = articlefile.getTitleDictionary(ns);
+    for (TitleDictionary::const_iterator it = titles.lower_bound(begin);
+         it != titles.end() && results.size() < limit; ++it)
     {
-      log_debug("check " << pos->getNamespace() << '/' << pos->getTitle());
-      if (pos->getNamespace() != ns || pos->getTitle().compare(end) > 0)
+      log_debug("check " << ns << '/' << *it);
+      if (it->compare(end) > 0)
       {
-        log_debug("article " << pos->getNamespace() << ", \"" << pos->getTitle() << "\" does not match");
+        log_debug("article " << ns << ", \"" << *it << "\" does not match");
         break;
       }
-      results.push_back(SearchResult(*pos));
+      results.push_back(SearchResult(articlefile.getArticle(it.getIndex())));
     }
     log_debug(results.size() << " articles in result");
   }
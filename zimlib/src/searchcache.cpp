@@ -0,0 +1,154 @@
+/*
+ * Copyright (C) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * is provided AS IS, WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, and
+ * NON-INFRINGEMENT.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ */
+
+#include "searchcache.h"
+#include "envvalue.h"
+#include "config.h"
+#include "log.h"
+
+log_define("zim.search.cache")
+
+namespace zim
+{
+  bool SearchCache::get(const std::string& key, size_type offset, size_type count,
+                        Hits& page, size_type& totalCount, size_type& depth)
+  {
+    MutexLock lock(mutex);
+
+    EntriesType::iterator it = entries.find(key);
+    if (it == entries.end())
+    {
+      log_debug("query \"" << key << "\" not found in cache");
+      depth = 0;
+      return false;
+    }
+
+    const Entry& e = it->second;
+    if (offset + count > e.hits.size() && e.hits.size() < e.totalCount)
+    {
+      log_debug("query \"" << key << "\" ranked " << e.hits.size() << " of " << e.totalCount << " matches only");
+      depth = e.hits.size();
+      return false;
+    }
+
+    // mark as recently used
+    lru.splice(lru.begin(), lru, e.lru);
+
+    page.clear();
+    if (offset < e.hits.size())
+    {
+      size_type end = offset + count < e.hits.size() ? offset + count : e.hits.size();
+      page.assign(e.hits.begin() + offset, e.hits.begin() + end);
+    }
+
+    totalCount = e.totalCount;
+    depth = e.hits.size();
+    return true;
+  }
+
+  void SearchCache::put(const std::string& key, const Hits& hits, size_type totalCount)
+  {
+    size_type size = entrySize(key, hits);
+    MutexLock lock(mutex);
+
+    if (size > maxSize)
+    {
+      log_debug("query \"" << key << "\" with " << hits.size() << " hits too large for cache");
+      return;
+    }
+
+    EntriesType::iterator it = entries.find(key);
+    if (it != entries.end())
+    {
+      Entry& e = it->second;
+      if (e.hits.size() >= hits.size())
+        return;  // another thread was faster
+
+      currentSize -= entrySize(key, e.hits);
+      e.hits = hits;
+      e.totalCount = totalCount;
+      lru.splice(lru.begin(), lru, e.lru);
+    }
+    else
+    {
+      it = entries.insert(EntriesType::value_type(key, Entry())).first;
+      it->second.hits = hits;
+      it->second.totalCount = totalCount;
+      lru.push_front(it);
+      it->second.lru = lru.begin();
+    }
+
+    currentSize += size;
+    evict();
+
+    log_debug("query \"" << key << "\" with " << hits.size() << " of " << totalCount << " hits cached; " << entries.size() << " entries, " << currentSize << " bytes");
+  }
+
+  void SearchCache::evict()
+  {
+    while (currentSize > maxSize && !lru.empty())
+    {
+      EntriesType::iterator it = lru.back();
+      log_debug("evict query \"" << it->first << '"');
+      currentSize -= entrySize(it->first, it->second.hits);
+      lru.pop_back();
+      entries.erase(it);
+    }
+  }
+
+  void SearchCache::clear()
+  {
+    MutexLock lock(mutex);
+    lru.clear();
+    entries.clear();
+    currentSize = 0;
+  }
+
+  size_type SearchCache::getMaxSize() const
+  {
+    MutexLock lock(mutex);
+    return maxSize;
+  }
+
+  void SearchCache::setMaxSize(size_type s)
+  {
+    MutexLock lock(mutex);
+    maxSize = s;
+    evict();
+  }
+
+  size_type SearchCache::getSize() const
+  {
+    MutexLock lock(mutex);
+    return currentSize;
+  }
+
+  size_type SearchCache::getCount() const
+  {
+    MutexLock lock(mutex);
+    return entries.size();
+  }
+
+  SearchCache& SearchCache::getInstance()
+  {
+    static SearchCache cache(envMemSize("ZIM_SEARCHCACHE", SEARCH_CACHE_SIZE * 1024 * 1024));
+    return cache;
+  }
+
+}
@@ -0,0 +1,102 @@
+/*
+ * Copyright (C) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * is provided AS IS, WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, and
+ * NON-INFRINGEMENT.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ */
+
+#ifndef ZIM_SEARCHCACHE_H
+#define ZIM_SEARCHCACHE_H
+
+#include <zim/zim.h>
+#include <string>
+#include <vector>
+#include <list>
+#include <map>
+#include "mutex.h"
+
+namespace zim
+{
+  /**
+     Process wide cache of full text search rankings.
+
+     An entry holds the best matches of one query as compact (article
+     index, priority) pairs in final order. Only the number of matches,
+     which were asked for so far, is ranked, so an entry may be extended
+     later. The cache is bounded by the bytes used by its entries and
+     evicts the least recently used ones. All methods are thread safe.
+   */
+  class SearchCache
+  {
+    public:
+      struct Hit
+      {
+        size_type index;
+        float priority;
+      };
+
+      typedef std::vector<Hit> Hits;
+
+    private:
+      struct Entry;
+      typedef std::map<std::string, Entry> EntriesType;
+      typedef std::list<EntriesType::iterator> LruType;
+
+      struct Entry
+      {
+        Hits hits;
+        size_type totalCount;
+        LruType::iterator lru;
+      };
+
+      EntriesType entries;
+      LruType lru;  // most recently used first
+      size_type maxSize;
+      size_type currentSize;
+      mutable Mutex mutex;
+
+      static size_type entrySize(const std::string& key, const Hits& hits)
+        { return key.size() + hits.size() * sizeof(Hit) + sizeof(Entry) + 64; }
+
+      void evict();
+
+    public:
+      explicit SearchCache(size_type maxSize_)
+        : maxSize(maxSize_),
+          currentSize(0)
+        { }
+
+      /// Copies the hits offset to offset + count of key into page. Returns
+      /// false, when key is not cached or not ranked deep enough; depth
+      /// is then set to the number of ranked hits.
+      bool get(const std::string& key, size_type offset, size_type count,
+               Hits& page, size_type& totalCount, size_type& depth);
+
+      /// Stores the ranked hits of key, replacing a shorter ranking.
+      void put(const std::string& key, const Hits& hits, size_type totalCount);
+
+      void clear();
+
+      size_type getMaxSize() const;
+      void setMaxSize(size_type s);
+      size_type getSize() const;
+      size_type getCount() const;
+
+      /// Returns the cache shared by all searches of the process.
+      static SearchCache& getInstance();
+  };
+}
+
+#endif // ZIM_SEARCHCACHE_H
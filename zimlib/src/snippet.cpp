@@ -0,0 +1,286 @@
+/*
+ * Copyright (C) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * is provided AS IS, WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, and
+ * NON-INFRINGEMENT.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ */
+
+#include "snippet.h"
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include "log.h"
+
+log_define("zim.snippet")
+
+namespace zim
+{
+  namespace
+  {
+    // how far to look back for the start of a tag or entity, which
+    // encloses the start of the window
+    const size_type maxTagLength = 1024;
+    const size_type maxEntityLength = 10;
+
+    inline bool isWordChar(char ch)
+    {
+      unsigned char c = static_cast<unsigned char>(ch);
+      return c >= 0x80 || std::isalnum(c);
+    }
+
+    inline char foldCase(char ch)
+    {
+      return ch >= 'A' && ch <= 'Z' ? ch + ('a' - 'A') : ch;
+    }
+
+    // Returns true, if the tag at data[p] is named name. The name is lower
+    // case.
+    bool isTag(const char* data, size_type dataSize, size_type p, const char* name)
+    {
+      size_type len = std::strlen(name);
+      if (p + 1 + len > dataSize)
+        return false;
+      for (size_type n = 0; n < len; ++n)
+        if (foldCase(data[p + 1 + n]) != name[n])
+          return false;
+      return p + 1 + len == dataSize || !isWordChar(data[p + 1 + len]);
+    }
+
+    // Returns the offset after the end tag of the element, which starts at
+    // data[p], or dataSize.
+    size_type skipElement(const char* data, size_type dataSize, size_type p, const char* name)
+    {
+      std::string endTag = std::string("/") + name;
+      for (p = p + 1; p < dataSize; ++p)
+        if (data[p] == '<' && isTag(data, dataSize, p, endTag.c_str()))
+          break;
+      for ( ; p < dataSize && data[p] != '>'; ++p)
+        ;
+      return p < dataSize ? p + 1 : dataSize;
+    }
+
+    // Moves a start offset out of a tag, an entity or a word.
+    size_type adjustStart(const char* data, size_type dataSize, size_type p)
+    {
+      // inside a tag, when a '<' is closer than a '>'
+      for (size_type b = p; b > 0 && p - b < maxTagLength; --b)
+      {
+        if (data[b - 1] == '>')
+          break;
+        if (data[b - 1] == '<')
+        {
+          while (p < dataSize && data[p] != '>')
+            ++p;
+          return p < dataSize ? p + 1 : p;
+        }
+      }
+
+      // inside an entity
+      for (size_type b = p; b > 0 && p - b < maxEntityLength; --b)
+      {
+        char ch = data[b - 1];
+        if (ch == '&')
+        {
+          while (p < dataSize && data[p] != ';' && p - b < maxEntityLength)
+            ++p;
+          return p < dataSize ? p + 1 : p;
+        }
+        if (ch == ';' || std::isspace(static_cast<unsigned char>(ch)))
+          break;
+      }
+
+      // inside a word
+      if (p > 0)
+        while (p < dataSize && isWordChar(data[p - 1]) && isWordChar(data[p]))
+          ++p;
+
+      return p;
+    }
+
+    // Returns true, if there is text before offset p. Only a limited
+    // number of bytes is examined; beyond that text is assumed.
+    bool hasTextBefore(const char* data, size_type p)
+    {
+      for (size_type steps = 0; p > 0 && steps < maxTagLength; ++steps)
+      {
+        char ch = data[--p];
+        if (ch == '>')
+        {
+          // pass over the tag
+          for (size_type t = 0; p > 0 && data[p - 1] != '<' && t < maxTagLength; ++t)
+            --p;
+          if (p > 0)
+            --p;
+        }
+        else if (!std::isspace(static_cast<unsigned char>(ch)))
+          return true;
+      }
+      return p > 0;
+    }
+
+    // Returns true, if the highlight lies within the data and covers word
+    // characters only, so that it does not cut markup.
+    bool isPlainWord(const char* data, size_type dataSize, const HighlightType& h)
+    {
+      if (h.second == 0 || h.first + h.second > dataSize)
+        return false;
+      for (size_type n = h.first; n < h.first + h.second; ++n)
+        if (!isWordChar(data[n]))
+          return false;
+      return true;
+    }
+  }
+
+  std::string makeSnippet(const char* data, size_type dataSize,
+                          const std::vector<HighlightType>& highlights, unsigned size)
+  {
+    // find the window of size bytes with the most highlights
+    size_type best = 0;
+    size_type bestCount = 0;
+    for (size_type b = 0, e = 0; b < highlights.size(); ++b)
+    {
+      if (e < b)
+        e = b;
+      while (e < highlights.size() && highlights[e].first < highlights[b].first + size)
+        ++e;
+      if (e - b > bestCount)
+      {
+        best = b;
+        bestCount = e - b;
+      }
+    }
+
+    size_type p;
+    if (bestCount > 0)
+    {
+      // show some context before the first highlight
+      size_type first = highlights[best].first;
+      p = first > size / 4 ? first - size / 4 : 0;
+    }
+    else
+    {
+      // no match in the text - start at the body
+      static const char body[] = "<body";
+      const char* b = std::search(data, data + dataSize, body, body + sizeof(body) - 1);
+      p = b == data + dataSize ? 0 : b - data;
+    }
+
+    p = adjustStart(data, dataSize, p);
+
+    log_debug("snippet starts at offset " << p << " of " << dataSize);
+
+    std::string result;
+    if (hasTextBefore(data, p))
+      result = "... ";
+
+    std::vector<HighlightType>::const_iterator h = highlights.begin();
+    unsigned count = 0;   // characters of text
+    bool space = true;    // last character written was a space
+    while (p < dataSize)
+    {
+      char ch = data[p];
+
+      if (count >= size && !isWordChar(ch))
+        break;
+
+      while (h != highlights.end() && h->first < p)
+        ++h;
+
+      if (ch == '<')
+      {
+        if (isTag(data, dataSize, p, "script"))
+          p = skipElement(data, dataSize, p, "script");
+        else if (isTag(data, dataSize, p, "style"))
+          p = skipElement(data, dataSize, p, "style");
+        else if (isTag(data, dataSize, p, "title"))
+          p = skipElement(data, dataSize, p, "title");
+        else
+        {
+          while (p < dataSize && data[p] != '>')
+            ++p;
+          if (p < dataSize)
+            ++p;
+        }
+
+        // tags separate words
+        if (!space)
+        {
+          result += ' ';
+          space = true;
+          ++count;
+        }
+      }
+      else if (h != highlights.end() && h->first == p && isPlainWord(data, dataSize, *h))
+      {
+        result += "<b>";
+        result.append(data + p, h->second);
+        result += "</b>";
+        count += h->second;
+        p += h->second;
+        space = false;
+      }
+      else if (std::isspace(static_cast<unsigned char>(ch)))
+      {
+        if (!space)
+        {
+          result += ' ';
+          space = true;
+          ++count;
+        }
+        ++p;
+      }
+      else if (ch == '&')
+      {
+        // an entity is copied as a whole
+        size_type e = p + 1;
+        while (e < dataSize && e - p < maxEntityLength && data[e] != ';'
+            && !std::isspace(static_cast<unsigned char>(data[e])))
+          ++e;
+        if (e < dataSize && data[e] == ';')
+        {
+          result.append(data + p, e + 1 - p);
+          p = e + 1;
+        }
+        else
+        {
+          result += "&amp;";
+          ++p;
+        }
+        ++count;
+        space = false;
+      }
+      else
+      {
+        if (ch == '>')
+          result += "&gt;";
+        else
+          result += ch;
+        ++count;
+        ++p;
+        space = false;
+      }
+    }
+
+    // strip trailing white space
+    while (!result.empty() && result[result.size() - 1] == ' ')
+      result.erase(result.size() - 1);
+
+    if (p < dataSize)
+      result += " ...";
+
+    return result;
+  }
+
+}
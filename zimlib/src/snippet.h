@@ -0,0 +1,41 @@
+/*
+ * Copyright (C) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * is provided AS IS, WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, and
+ * NON-INFRINGEMENT.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ */
+
+#ifndef ZIM_SNIPPET_H
+#define ZIM_SNIPPET_H
+
+#include <string>
+#include <vector>
+#include <zim/zim.h>
+
+namespace zim
+{
+  /// offset and length of a word to highlight in the data of an article
+  typedef std::pair<size_type, size_type> HighlightType;
+
+  /// Returns about size bytes of the text of the html document data
+  /// around the densest group of highlights. Only the bytes of this window
+  /// are read: tags are removed, white space is collapsed and the
+  /// highlighted words are wrapped in <b> tags. Entities are kept, so the
+  /// result is html. The highlights must be ordered by offset.
+  std::string makeSnippet(const char* data, size_type dataSize,
+                          const std::vector<HighlightType>& highlights, unsigned size);
+}
+
+#endif // ZIM_SNIPPET_H
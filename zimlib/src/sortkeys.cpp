@@ -0,0 +1,233 @@
+/*
+ * Copyright (C) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * is provided AS IS, WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, and
+ * NON-INFRINGEMENT.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ */
+
+#include "sortkeys.h"
+#include "threadpool.h"
+#include <algorithm>
+#include <string.h>
+#include "log.h"
+
+log_define("zim.writer.sortkeys")
+
+namespace zim
+{
+  namespace writer
+  {
+    namespace
+    {
+      uint64_t makePrefix(const char* key, size_type size)
+      {
+        uint64_t prefix = 0;
+        for (unsigned n = 0; n < 8; ++n)
+          prefix = (prefix << 8) | (n < size ? static_cast<unsigned char>(key[n]) : 0);
+        return prefix;
+      }
+
+      class EntryLess
+      {
+          const SortKeys& keys;
+
+        public:
+          explicit EntryLess(const SortKeys& keys_)
+            : keys(keys_)
+            { }
+
+          bool operator() (const SortKeys::Entry& e1, const SortKeys::Entry& e2) const
+            { return keys.less(e1, e2); }
+      };
+
+      typedef std::vector<SortKeys::Entry> EntriesType;
+
+      class SortTask : public ThreadPool::Task
+      {
+          EntriesType& entries;
+          size_type begin;
+          size_type end;
+          const SortKeys& keys;
+
+        public:
+          SortTask(EntriesType& entries_, size_type begin_, size_type end_, const SortKeys& keys_)
+            : entries(entries_),
+              begin(begin_),
+              end(end_),
+              keys(keys_)
+            { }
+
+          void run()
+            { std::sort(entries.begin() + begin, entries.begin() + end, EntryLess(keys)); }
+      };
+
+      class MergeTask : public ThreadPool::Task
+      {
+          const EntriesType& in;
+          EntriesType& out;
+          size_type begin;
+          size_type middle;
+          size_type end;
+          const SortKeys& keys;
+
+        public:
+          MergeTask(const EntriesType& in_, EntriesType& out_, size_type begin_,
+                    size_type middle_, size_type end_, const SortKeys& keys_)
+            : in(in_),
+              out(out_),
+              begin(begin_),
+              middle(middle_),
+              end(end_),
+              keys(keys_)
+            { }
+
+          void run()
+          {
+            std::merge(in.begin() + begin, in.begin() + middle,
+                       in.begin() + middle, in.begin() + end,
+                       out.begin() + begin, EntryLess(keys));
+          }
+      };
+    }
+
+    const size_type SortKeys::notFound;
+
+    void SortKeys::reserve(size_type count, size_type poolSize)
+    {
+      entries.reserve(count);
+      pool.reserve(poolSize);
+    }
+
+    void SortKeys::add(char ns, const std::string& str, size_type number)
+    {
+      Entry e;
+      e.offset = pool.size();
+      e.size = str.size() + 1;
+      e.number = number;
+      pool += ns;
+      pool += str;
+      e.prefix = makePrefix(pool.data() + e.offset, e.size);
+      entries.push_back(e);
+    }
+
+    void SortKeys::add(const std::string& str, size_type number)
+    {
+      Entry e;
+      e.offset = pool.size();
+      e.size = str.size();
+      e.number = number;
+      pool += str;
+      e.prefix = makePrefix(str.data(), e.size);
+      entries.push_back(e);
+    }
+
+    void SortKeys::clear()
+    {
+      pool.clear();
+      entries.clear();
+    }
+
+    int SortKeys::compare(const Entry& e, uint64_t prefix, const char* key, size_type size) const
+    {
+      if (e.prefix != prefix)
+        return e.prefix < prefix ? -1 : 1;
+
+      size_type s = std::min(e.size, size);
+      int c = s > 8 ? ::memcmp(pool.data() + e.offset + 8, key + 8, s - 8) : 0;
+      if (c != 0)
+        return c;
+      return e.size < size ? -1 : e.size > size ? 1 : 0;
+    }
+
+    bool SortKeys::less(const Entry& e1, const Entry& e2) const
+    {
+      int c = compare(e1, e2.prefix, pool.data() + e2.offset, e2.size);
+      return c < 0 || (c == 0 && e1.number < e2.number);
+    }
+
+    void SortKeys::sort(unsigned threads)
+    {
+      // sort chunks in parallel and merge them pairwise; small inputs are
+      // not worth the threads
+      size_type chunks = threads;
+      if (chunks > entries.size() / 10000)
+        chunks = entries.size() / 10000;
+
+      if (chunks <= 1)
+      {
+        std::sort(entries.begin(), entries.end(), EntryLess(*this));
+        return;
+      }
+
+      log_debug("sort " << entries.size() << " keys in " << chunks << " chunks");
+
+      std::vector<size_type> bounds;
+      for (size_type n = 0; n <= chunks; ++n)
+        bounds.push_back(entries.size() * n / chunks);
+
+      {
+        ThreadPool pool(threads);
+        for (size_type n = 0; n < chunks; ++n)
+          pool.add(new SortTask(entries, bounds[n], bounds[n + 1], *this));
+      }
+
+      EntriesType buffer(entries.size());
+      while (bounds.size() > 2)
+      {
+        std::vector<size_type> merged;
+
+        {
+          ThreadPool pool(threads);
+          size_type n = 0;
+          for ( ; n + 2 < bounds.size(); n += 2)
+          {
+            pool.add(new MergeTask(entries, buffer, bounds[n], bounds[n + 1], bounds[n + 2], *this));
+            merged.push_back(bounds[n]);
+          }
+
+          if (n + 1 < bounds.size())
+          {
+            // odd chunk left over
+            std::copy(entries.begin() + bounds[n], entries.begin() + bounds[n + 1], buffer.begin() + bounds[n]);
+            merged.push_back(bounds[n]);
+          }
+        }
+
+        merged.push_back(entries.size());
+        bounds.swap(merged);
+        entries.swap(buffer);
+      }
+    }
+
+    size_type SortKeys::find(const std::string& str) const
+    {
+      uint64_t prefix = makePrefix(str.data(), str.size());
+
+      size_type l = 0;
+      size_type u = entries.size();
+      while (l < u)
+      {
+        size_type m = l + (u - l) / 2;
+        if (compare(entries[m], prefix, str.data(), str.size()) < 0)
+          l = m + 1;
+        else
+          u = m;
+      }
+
+      return l < entries.size() && compare(entries[l], prefix, str.data(), str.size()) == 0
+           ? entries[l].number : notFound;
+    }
+  }
+}
@@ -0,0 +1,86 @@
+/*
+ * Copyright (C) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * is provided AS IS, WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, and
+ * NON-INFRINGEMENT.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ */
+
+#ifndef ZIM_SORTKEYS_H
+#define ZIM_SORTKEYS_H
+
+#include <zim/zim.h>
+#include <string>
+#include <vector>
+
+namespace zim
+{
+  namespace writer
+  {
+    /**
+       Sorts numbers (e.g. of dirents) by string keys.
+
+       The keys are copied into one pool. Each entry holds the first 8 bytes
+       of its key as a big endian number, so that most comparisons are
+       integer comparisons and only entries with equal prefixes look at the
+       pool. Entries with equal keys are ordered by number, so the result
+       does not depend on the number of threads used for sorting.
+     */
+    class SortKeys
+    {
+      public:
+        struct Entry
+        {
+          uint64_t prefix;
+          size_type offset;   // of the key in the pool
+          size_type size;
+          size_type number;
+        };
+
+        static const size_type notFound = static_cast<size_type>(-1);
+
+      private:
+        std::string pool;
+        std::vector<Entry> entries;
+
+        int compare(const Entry& e, uint64_t prefix, const char* key, size_type size) const;
+
+      public:
+        void reserve(size_type count, size_type poolSize);
+
+        /// Adds a key made of the namespace char and str.
+        void add(char ns, const std::string& str, size_type number);
+        /// Adds the key str.
+        void add(const std::string& str, size_type number);
+
+        /// Sorts the entries using up to threads threads.
+        void sort(unsigned threads);
+
+        void clear();
+
+        size_type size() const                 { return entries.size(); }
+        size_type getNumber(size_type n) const { return entries[n].number; }
+        std::string getKey(size_type n) const
+          { return pool.substr(entries[n].offset, entries[n].size); }
+
+        /// Returns the number of the first entry with key str in the
+        /// sorted entries or notFound.
+        size_type find(const std::string& str) const;
+
+        bool less(const Entry& e1, const Entry& e2) const;
+    };
+  }
+}
+
+#endif // ZIM_SORTKEYS_H
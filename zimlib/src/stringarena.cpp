@@ -0,0 +1,114 @@
+/*
+ * Copyright (C) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * is provided AS IS, WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, and
+ * NON-INFRINGEMENT.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ */
+
+#include <zim/writer/stringarena.h>
+#include <stdexcept>
+#include <string.h>
+
+namespace zim
+{
+  namespace writer
+  {
+    const unsigned StringArena::chunkBits;
+    const size_type StringArena::chunkSize;
+    const StringArena::Handle StringArena::empty;
+
+    StringArena::StringArena()
+      : used(0),
+        count(0)
+    {
+      clear();
+    }
+
+    StringArena::~StringArena()
+    {
+      for (std::vector<char*>::iterator it = chunks.begin(); it != chunks.end(); ++it)
+        delete[] *it;
+    }
+
+    StringArena::Handle StringArena::add(const char* data, size_type size)
+    {
+      if (size == 0)
+        return empty;
+
+      char len[5];
+      unsigned lenSize = 0;
+      for (size_type s = size; ; s >>= 7)
+      {
+        len[lenSize++] = static_cast<char>((s & 0x7f) | (s >= 0x80 ? 0x80 : 0));
+        if (s < 0x80)
+          break;
+      }
+
+      if (size > chunkSize - lenSize)
+        throw std::runtime_error("string too long for string arena");
+
+      if (used + lenSize + size > chunkSize)
+      {
+        if (chunks.size() >= (static_cast<uint64_t>(1) << 32) / chunkSize)
+          throw std::runtime_error("string arena full");
+        chunks.push_back(new char[chunkSize]);
+        used = 0;
+      }
+
+      Handle h = static_cast<Handle>(((chunks.size() - 1) << chunkBits) + used);
+      char* p = chunks.back() + used;
+      memcpy(p, len, lenSize);
+      memcpy(p + lenSize, data, size);
+      used += lenSize + size;
+      ++count;
+      return h;
+    }
+
+    const char* StringArena::decode(Handle h, size_type& size) const
+    {
+      const unsigned char* p = reinterpret_cast<const unsigned char*>(
+                                 chunks[h >> chunkBits] + (h & (chunkSize - 1)));
+      size = 0;
+      for (unsigned shift = 0; ; shift += 7)
+      {
+        unsigned char c = *p++;
+        size |= static_cast<size_type>(c & 0x7f) << shift;
+        if (!(c & 0x80))
+          break;
+      }
+      return reinterpret_cast<const char*>(p);
+    }
+
+    bool StringArena::equals(Handle h, const std::string& str) const
+    {
+      size_type size;
+      const char* data = decode(h, size);
+      return size == str.size() && memcmp(data, str.data(), size) == 0;
+    }
+
+    void StringArena::clear()
+    {
+      for (std::vector<char*>::iterator it = chunks.begin(); it != chunks.end(); ++it)
+        delete[] *it;
+      chunks.clear();
+
+      // the empty string at offset 0
+      chunks.push_back(new char[chunkSize]);
+      chunks.back()[0] = '\0';
+      used = 1;
+      count = 0;
+    }
+  }
+}
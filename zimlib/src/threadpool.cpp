@@ -0,0 +1,107 @@
+/*
+ * Copyright (C) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * is provided AS IS, WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, and
+ * NON-INFRINGEMENT.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ */
+
+#include "threadpool.h"
+#include <stdexcept>
+#include "log.h"
+
+log_define("zim.threadpool")
+
+namespace zim
+{
+  ThreadPool::ThreadPool(unsigned count)
+    : stop(false)
+  {
+    if (count == 0)
+      count = 1;
+
+    threads.reserve(count);
+    for (unsigned n = 0; n < count; ++n)
+    {
+      pthread_t thread;
+      if (pthread_create(&thread, 0, start, this) != 0)
+      {
+        if (threads.empty())
+          throw std::runtime_error("failed to create thread");
+        log_warn("failed to create thread; use " << threads.size() << " threads");
+        break;
+      }
+      threads.push_back(thread);
+    }
+
+    log_debug(threads.size() << " threads started");
+  }
+
+  ThreadPool::~ThreadPool()
+  {
+    {
+      MutexLock lock(mutex);
+      stop = true;
+      taskAdded.broadcast();
+    }
+
+    for (std::vector<pthread_t>::iterator it = threads.begin(); it != threads.end(); ++it)
+      pthread_join(*it, 0);
+  }
+
+  void ThreadPool::add(Task* task)
+  {
+    MutexLock lock(mutex);
+    tasks.push_back(task);
+    taskAdded.signal();
+  }
+
+  void* ThreadPool::start(void* pool)
+  {
+    static_cast<ThreadPool*>(pool)->work();
+    return 0;
+  }
+
+  void ThreadPool::work()
+  {
+    while (true)
+    {
+      Task* task;
+
+      {
+        MutexLock lock(mutex);
+        while (tasks.empty() && !stop)
+          taskAdded.wait(mutex);
+
+        if (tasks.empty())
+          return;
+
+        task = tasks.front();
+        tasks.pop_front();
+      }
+
+      try
+      {
+        task->run();
+      }
+      catch (const std::exception& e)
+      {
+        log_error("task failed: " << e.what());
+      }
+
+      delete task;
+    }
+  }
+
+}
@@ -0,0 +1,67 @@
+/*
+ * Copyright (C) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * is provided AS IS, WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, and
+ * NON-INFRINGEMENT.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ */
+
+#ifndef ZIM_THREADPOOL_H
+#define ZIM_THREADPOOL_H
+
+#include <zim/noncopyable.h>
+#include "mutex.h"
+#include <deque>
+#include <vector>
+#include <pthread.h>
+
+namespace zim
+{
+  /**
+     A fixed number of threads running queued tasks in the order, in which
+     they were added.
+   */
+  class ThreadPool : private NonCopyable
+  {
+    public:
+      class Task
+      {
+        public:
+          virtual ~Task()  { }
+          virtual void run() = 0;
+      };
+
+    private:
+      Mutex mutex;
+      Condition taskAdded;
+      std::deque<Task*> tasks;
+      std::vector<pthread_t> threads;
+      bool stop;
+
+      static void* start(void* pool);
+      void work();
+
+    public:
+      explicit ThreadPool(unsigned count);
+      /// Runs the queued tasks and waits for the threads to finish.
+      ~ThreadPool();
+
+      /// Queues a task. The pool deletes the task after running it.
+      void add(Task* task);
+
+      unsigned size() const   { return threads.size(); }
+  };
+}
+
+#endif // ZIM_THREADPOOL_H
@@ -0,0 +1,133 @@
+/*
+ * Copyright (C) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * is provided AS IS, WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, and
+ * NON-INFRINGEMENT.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ */
+
+#include <zim/titledictionary.h>
+#include <zim/zintstream.h>
+#include <stdexcept>
+#include "log.h"
+
+log_define("zim.titledictionary")
+
+namespace zim
+{
+  const unsigned TitleDictionary::restartInterval;
+
+  void TitleDictionary::add(const std::string& title, size_type idx)
+  {
+    if (count > 0 && title < lastTitle)
+      throw std::runtime_error("titles not sorted in title dictionary");
+
+    size_type shared = 0;
+    if (count % restartInterval == 0)
+      restarts.push_back(data.size());
+    else
+      while (shared < title.size() && shared < lastTitle.size()
+          && title[shared] == lastTitle[shared])
+        ++shared;
+
+    char buffer[10];
+    char* p = encodeZInt(buffer, shared);
+    p = encodeZInt(p, title.size() - shared);
+    data.append(buffer, p);
+    data.append(title, shared, std::string::npos);
+    data.append(buffer, encodeZInt(buffer, idx));
+
+    lastTitle = title;
+    ++count;
+  }
+
+  TitleDictionary::const_iterator TitleDictionary::lower_bound(const std::string& title) const
+  {
+    // find the last restart point with a title not greater than title
+    size_type l = 0;
+    size_type u = restarts.size();
+    while (l < u)
+    {
+      size_type m = l + (u - l) / 2;
+      const char* p = data.data() + restarts[m];
+      const char* e = data.data() + data.size();
+      size_type v[2];  // shared (always 0) and length
+      p = decodeZInts(p, e, v, 2);
+      if (title.compare(0, std::string::npos, p, v[1]) < 0)
+        u = m;
+      else
+        l = m + 1;
+    }
+
+    if (l == 0)
+      return begin();
+
+    const_iterator it(this, (l - 1) * restartInterval, restarts[l - 1]);
+    while (it.entry < count && it.title < title)
+      ++it;
+
+    return it;
+  }
+
+  TitleDictionary::const_iterator TitleDictionary::find(const std::string& title) const
+  {
+    const_iterator it = lower_bound(title);
+    return it.entry < count && it.title == title ? it : end();
+  }
+
+  bool TitleDictionary::find(const std::string& title, size_type& idx) const
+  {
+    const_iterator it = lower_bound(title);
+    if (it.entry < count && it.title == title)
+    {
+      idx = it.index;
+      return true;
+    }
+
+    return false;
+  }
+
+  void TitleDictionary::const_iterator::decode()
+  {
+    if (entry >= dict->count)
+    {
+      title.clear();
+      index = 0;
+      return;
+    }
+
+    const char* p = dict->data.data() + offset;
+    const char* e = dict->data.data() + dict->data.size();
+
+    size_type v[2];  // shared prefix and suffix length
+    p = decodeZInts(p, e, v, 2);
+    if (v[0] > title.size() || v[1] > static_cast<size_type>(e - p))
+      throw std::runtime_error("invalid entry in title dictionary");
+
+    title.resize(v[0]);
+    title.append(p, v[1]);
+    p = decodeZInts(p + v[1], e, &index, 1);
+
+    next = p - dict->data.data();
+  }
+
+  TitleDictionary::const_iterator& TitleDictionary::const_iterator::operator++()
+  {
+    ++entry;
+    offset = next;
+    decode();
+    return *this;
+  }
+
+}
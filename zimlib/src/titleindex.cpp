@@ -0,0 +1,431 @@
+/*
+ * Copyright (C) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * is provided AS IS, WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, and
+ * NON-INFRINGEMENT.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ */
+
+#include <zim/titleindex.h>
+#include <zim/zintstream.h>
+#include <algorithm>
+#include <iostream>
+#include <iterator>
+#include <stdexcept>
+#include <stdint.h>
+#include "log.h"
+
+log_define("zim.titleindex")
+
+namespace zim
+{
+  namespace
+  {
+    inline unsigned char foldCase(char ch)
+    {
+      unsigned char c = static_cast<unsigned char>(ch);
+      return c >= 'A' && c <= 'Z' ? c + ('a' - 'A') : c;
+    }
+
+    typedef std::pair<size_type, unsigned> BucketSizeType;  // bytes, bucket
+
+    // Levenshtein distance of a and b, both folded to lower case. Only a
+    // band of width 2 * max + 1 around the diagonal is computed, and the
+    // computation stops, as soon as the distance exceeds max. Returns
+    // max + 1 in that case.
+    unsigned editDistance(const char* a, unsigned alen, const char* b, unsigned blen, unsigned max)
+    {
+      if ((alen > blen ? alen - blen : blen - alen) > max)
+        return max + 1;
+
+      const unsigned inf = max + 1;
+      std::vector<unsigned> prev(blen + 1, inf);
+      std::vector<unsigned> cur(blen + 1, inf);
+      for (unsigned j = 0; j <= blen && j <= max; ++j)
+        prev[j] = j;
+
+      for (unsigned i = 1; i <= alen; ++i)
+      {
+        unsigned from = i > max ? i - max : 1;
+        unsigned to = i + max < blen ? i + max : blen;
+        unsigned rowMin = inf;
+
+        cur[from - 1] = from == 1 && i <= max ? i : inf;
+        for (unsigned j = from; j <= to; ++j)
+        {
+          unsigned d = prev[j - 1] + (foldCase(a[i - 1]) == foldCase(b[j - 1]) ? 0 : 1);
+          d = std::min(d, prev[j] + 1);
+          d = std::min(d, cur[j - 1] + 1);
+          cur[j] = std::min(d, inf);
+          rowMin = std::min(rowMin, cur[j]);
+        }
+        if (to < blen)
+          cur[to + 1] = inf;
+
+        if (std::min(rowMin, cur[from - 1]) > max)
+          return inf;
+
+        prev.swap(cur);
+      }
+
+      return prev[blen];
+    }
+
+    // orders candidates by the number of shared trigrams, most first
+    struct CandidateType
+    {
+      size_type title;
+      unsigned shared;
+      bool operator< (const CandidateType& c) const
+        { return shared > c.shared || (shared == c.shared && title < c.title); }
+    };
+
+    void readData(std::istream& in, std::string& data)
+    {
+      if (!data.empty())
+        in.read(&data[0], data.size());
+    }
+  }
+
+  unsigned TitleIndex::bucket(const char* p) const
+  {
+    uint32_t key = (static_cast<uint32_t>(foldCase(p[0])) << 16)
+                 | (static_cast<uint32_t>(foldCase(p[1])) << 8)
+                 | foldCase(p[2]);
+    return (key * 2654435761u) >> (32 - bucketBits);
+  }
+
+  void TitleIndex::getTrigrams(const char* begin, const char* end, std::vector<unsigned>& result) const
+  {
+    result.clear();
+    for (const char* p = begin; p + 3 <= end; ++p)
+      result.push_back(bucket(p));
+    std::sort(result.begin(), result.end());
+    result.erase(std::unique(result.begin(), result.end()), result.end());
+  }
+
+  void TitleIndex::decodeBucket(unsigned b, std::vector<size_type>& result) const
+  {
+    const char* begin = postings.data() + buckets[b];
+    const char* end = postings.data() + buckets[b + 1];
+    result.resize(end - begin);
+    result.resize(decodeZInts(begin, end, result.empty() ? 0 : &result[0]));
+    for (std::vector<size_type>::size_type n = 1; n < result.size(); ++n)
+      result[n] += result[n - 1];
+  }
+
+  bool TitleIndex::matches(size_type n, const std::string& expr) const
+  {
+    const char* begin = titles.data() + offsets[n];
+    const char* end = titles.data() + (n + 1 < offsets.size() ? offsets[n + 1] : titles.size()) - 1;
+    return std::search(begin, end, expr.begin(), expr.end()) != end;
+  }
+
+  void TitleIndex::add(const std::string& title, size_type idx)
+  {
+    offsets.push_back(titles.size());
+    articles.push_back(idx);
+    titles += title;
+    titles += '\0';
+  }
+
+  void TitleIndex::build()
+  {
+    // about one bucket per 4 bytes of titles
+    bucketBits = 10;
+    while (bucketBits < 22 && (1u << bucketBits) < titles.size() / 4)
+      ++bucketBits;
+
+    unsigned numBuckets = 1u << bucketBits;
+    log_debug("build title index with " << offsets.size() << " titles and " << numBuckets << " buckets");
+
+    // first pass: size of each bucket
+    std::vector<size_type> last(numBuckets, 0);  // last title number + 1
+    std::vector<size_type> sizes(numBuckets, 0);
+    std::vector<unsigned> trigrams;
+    for (size_type n = 0; n < offsets.size(); ++n)
+    {
+      const char* begin = titles.data() + offsets[n];
+      getTrigrams(begin, begin + std::char_traits<char>::length(begin), trigrams);
+      for (std::vector<unsigned>::const_iterator it = trigrams.begin(); it != trigrams.end(); ++it)
+      {
+        sizes[*it] += zintSize(last[*it] == 0 ? n : n + 1 - last[*it]);
+        last[*it] = n + 1;
+      }
+    }
+
+    buckets.resize(numBuckets + 1);
+    buckets[0] = 0;
+    for (unsigned b = 0; b < numBuckets; ++b)
+      buckets[b + 1] = buckets[b] + sizes[b];
+
+    // second pass: fill the buckets
+    postings.resize(buckets[numBuckets]);
+    std::vector<char*> pos(numBuckets);
+    for (unsigned b = 0; b < numBuckets; ++b)
+    {
+      pos[b] = postings.empty() ? 0 : &postings[0] + buckets[b];
+      last[b] = 0;
+    }
+
+    for (size_type n = 0; n < offsets.size(); ++n)
+    {
+      const char* begin = titles.data() + offsets[n];
+      getTrigrams(begin, begin + std::char_traits<char>::length(begin), trigrams);
+      for (std::vector<unsigned>::const_iterator it = trigrams.begin(); it != trigrams.end(); ++it)
+      {
+        pos[*it] = encodeZInt(pos[*it], last[*it] == 0 ? n : n + 1 - last[*it]);
+        last[*it] = n + 1;
+      }
+    }
+
+    log_debug("title index uses " << getMemoryUsage() << " bytes");
+  }
+
+  size_type TitleIndex::getMemoryUsage() const
+  {
+    return titles.capacity()
+         + offsets.capacity() * sizeof(size_type)
+         + articles.capacity() * sizeof(size_type)
+         + buckets.capacity() * sizeof(size_type)
+         + postings.capacity()
+         + sizeof(*this);
+  }
+
+  void TitleIndex::scan(const std::string& expr, Results& results, size_type limit) const
+  {
+    std::string::size_type pos = 0;
+    while (results.size() < limit && pos < titles.size()
+        && (pos = titles.find(expr, pos)) != std::string::npos)
+    {
+      size_type n = std::upper_bound(offsets.begin(), offsets.end(), pos) - offsets.begin() - 1;
+      results.push_back(articles[n]);
+      pos = n + 1 < offsets.size() ? offsets[n + 1] : titles.size();
+    }
+  }
+
+  void TitleIndex::search(const std::string& expr, Results& results, size_type limit) const
+  {
+    log_debug("search titles for \"" << expr << '"');
+
+    if (expr.size() < 3 || buckets.empty())
+    {
+      scan(expr, results, limit);
+      return;
+    }
+
+    std::vector<unsigned> trigrams;
+    getTrigrams(expr.data(), expr.data() + expr.size(), trigrams);
+
+    // intersect the buckets starting with the smallest one
+    std::vector<BucketSizeType> bucketSizes;
+    for (std::vector<unsigned>::const_iterator it = trigrams.begin(); it != trigrams.end(); ++it)
+      bucketSizes.push_back(BucketSizeType(buckets[*it + 1] - buckets[*it], *it));
+    std::sort(bucketSizes.begin(), bucketSizes.end());
+
+    std::vector<size_type> candidates;
+    decodeBucket(bucketSizes[0].second, candidates);
+
+    std::vector<size_type> bucket;
+    std::vector<size_type> intersection;
+    for (unsigned n = 1; n < bucketSizes.size() && !candidates.empty(); ++n)
+    {
+      // verifying a few candidates is cheaper than decoding a large bucket
+      if (bucketSizes[n].first > candidates.size() * 16)
+        break;
+
+      decodeBucket(bucketSizes[n].second, bucket);
+      intersection.clear();
+      std::set_intersection(candidates.begin(), candidates.end(),
+                            bucket.begin(), bucket.end(),
+                            std::back_inserter(intersection));
+      candidates.swap(intersection);
+    }
+
+    log_debug(candidates.size() << " candidates for \"" << expr << '"');
+
+    for (std::vector<size_type>::const_iterator it = candidates.begin();
+         it != candidates.end() && results.size() < limit; ++it)
+    {
+      if (matches(*it, expr))
+        results.push_back(articles[*it]);
+    }
+  }
+
+  const size_type TitleIndex::maxCandidates;
+  const size_type TitleIndex::maxBucketSize;
+
+  void TitleIndex::findSimilar(const std::string& expr, SimilarResults& results,
+                               size_type limit, unsigned maxDistance) const
+  {
+    log_debug("find titles similar to \"" << expr << "\" with distance " << maxDistance);
+
+    if (expr.size() < 3 || buckets.empty())
+      return;
+
+    std::vector<unsigned> trigrams;
+    getTrigrams(expr.data(), expr.data() + expr.size(), trigrams);
+
+    // collect the titles of the used buckets; a title appears once for
+    // each shared trigram
+    std::vector<size_type> hits;
+    std::vector<size_type> bucket;
+    unsigned used = 0;
+    for (std::vector<unsigned>::const_iterator it = trigrams.begin(); it != trigrams.end(); ++it)
+    {
+      size_type bucketSize = buckets[*it + 1] - buckets[*it];
+      if (bucketSize > maxBucketSize)
+      {
+        log_debug("skip bucket of " << bucketSize << " bytes");
+        continue;
+      }
+
+      ++used;
+      decodeBucket(*it, bucket);
+      hits.insert(hits.end(), bucket.begin(), bucket.end());
+    }
+
+    std::sort(hits.begin(), hits.end());
+
+    // Each edit changes at most 3 trigrams, so a title within maxDistance
+    // shares at least used - 3 * maxDistance of the trigrams of expr.
+    unsigned threshold = used > 3 * maxDistance + 1 ? used - 3 * maxDistance : 1;
+
+    std::vector<CandidateType> candidates;
+    for (std::vector<size_type>::const_iterator it = hits.begin(); it != hits.end(); )
+    {
+      size_type n = *it;
+      std::vector<size_type>::const_iterator e = it;
+      while (e != hits.end() && *e == n)
+        ++e;
+      unsigned shared = e - it;
+      it = e;
+
+      if (shared < threshold)
+        continue;
+
+      size_type len = (n + 1 < offsets.size() ? offsets[n + 1] : titles.size()) - offsets[n] - 1;
+      if (len + maxDistance < expr.size() || len > expr.size() + maxDistance)
+        continue;
+
+      CandidateType c;
+      c.title = n;
+      c.shared = shared;
+      candidates.push_back(c);
+    }
+
+    log_debug(candidates.size() << " candidates share at least " << threshold << " of " << used << " trigrams");
+
+    if (candidates.size() > maxCandidates)
+    {
+      std::nth_element(candidates.begin(), candidates.begin() + maxCandidates, candidates.end());
+      candidates.resize(maxCandidates);
+    }
+
+    SimilarResults found;
+    for (std::vector<CandidateType>::const_iterator it = candidates.begin(); it != candidates.end(); ++it)
+    {
+      size_type n = it->title;
+      const char* title = titles.data() + offsets[n];
+      size_type len = (n + 1 < offsets.size() ? offsets[n + 1] : titles.size()) - offsets[n] - 1;
+      unsigned d = editDistance(expr.data(), expr.size(), title, len, maxDistance);
+      if (d <= maxDistance)
+        found.push_back(SimilarType(d, n));
+    }
+
+    std::sort(found.begin(), found.end());
+    if (found.size() > limit)
+      found.resize(limit);
+
+    results.insert(results.end(), found.begin(), found.end());
+  }
+
+  void TitleIndex::write(std::ostream& out) const
+  {
+    std::string articleData;
+    char buffer[5];
+    for (size_type n = 0; n < articles.size(); ++n)
+      articleData.append(buffer, encodeZInt(buffer, n == 0 ? articles[0] : articles[n] - articles[n - 1]));
+
+    std::string bucketData;
+    for (size_type b = 0; b + 1 < buckets.size(); ++b)
+      bucketData.append(buffer, encodeZInt(buffer, buckets[b + 1] - buckets[b]));
+
+    ZIntStream z(out);
+    z.put(offsets.size())
+     .put(bucketBits)
+     .put(titles.size())
+     .put(articleData.size())
+     .put(bucketData.size())
+     .put(postings.size());
+
+    out.write(titles.data(), titles.size());
+    out.write(articleData.data(), articleData.size());
+    out.write(bucketData.data(), bucketData.size());
+    out.write(postings.data(), postings.size());
+  }
+
+  void TitleIndex::read(std::istream& in)
+  {
+    ZIntStream z(in);
+    size_type count, titlesSize, articlesSize, bucketsSize, postingsSize;
+    if (!z.get(count) || !z.get(bucketBits) || !z.get(titlesSize) || !z.get(articlesSize)
+      || !z.get(bucketsSize) || !z.get(postingsSize) || bucketBits > 31)
+      throw std::runtime_error("invalid title index header");
+
+    std::string articleData(articlesSize, '\0');
+    std::string bucketData(bucketsSize, '\0');
+    titles.resize(titlesSize);
+    postings.resize(postingsSize);
+
+    readData(in, titles);
+    readData(in, articleData);
+    readData(in, bucketData);
+    readData(in, postings);
+    if (!in || (!titles.empty() && titles[titles.size() - 1] != '\0'))
+      throw std::runtime_error("error reading title index");
+
+    offsets.clear();
+    for (size_type pos = 0; pos < titles.size(); pos = titles.find('\0', pos) + 1)
+      offsets.push_back(pos);
+
+    articles.resize(articlesSize);
+    articles.resize(decodeZInts(articleData.data(), articleData.data() + articleData.size(), articles.empty() ? 0 : &articles[0]));
+    for (size_type n = 1; n < articles.size(); ++n)
+      articles[n] += articles[n - 1];
+
+    std::vector<size_type> sizes(bucketsSize);
+    sizes.resize(decodeZInts(bucketData.data(), bucketData.data() + bucketData.size(), sizes.empty() ? 0 : &sizes[0]));
+    buckets.resize(sizes.size() + 1);
+    buckets[0] = 0;
+    for (size_type b = 0; b < sizes.size(); ++b)
+      buckets[b + 1] = buckets[b] + sizes[b];
+
+    if (offsets.size() != count || articles.size() != count
+      || (!buckets.empty() && buckets.size() != (1u << bucketBits) + 1)
+      || buckets.back() != postings.size())
+      throw std::runtime_error("invalid title index");
+
+    // searches use the title numbers of the buckets unchecked
+    std::vector<size_type> bucket;
+    for (unsigned b = 0; b + 1 < buckets.size(); ++b)
+    {
+      decodeBucket(b, bucket);
+      for (std::vector<size_type>::const_iterator it = bucket.begin(); it != bucket.end(); ++it)
+        if (*it >= count)
+          throw std::runtime_error("invalid title number in title index");
+    }
+  }
+
+}
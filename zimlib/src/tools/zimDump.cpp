@@ -24,11 +24,14 @@
 #include <zim/file.h>
 #include <zim/fileiterator.h>
 #include <zim/zintstream.h>
+#include <zim/indexarticle.h>
+#include <zim/progress.h>
 #include "arg.h"
 #include "log.h"
 #include <stdexcept>
 #include <sys/stat.h>
 #include <sys/types.h>
+#include <unistd.h>
 
 log_define("zim.dumper")
 
@@ -54,6 +57,7 @@ class ZimDumper
     void findArticleByUrl(const std::string& url);
     void dumpArticle();
     void dumpIndex();
+    void dumpIndexBlocks();
     void printPage();
     void listArticles(bool info, bool listTable, bool extra);
     void listArticle(const zim::Article& article, bool extra);
@@ -166,6 +170,12 @@ void ZimDumper::dumpIndex()
     if (!parameter)
       throw std::runtime_error("invalid index parameter data");
 
+    if (flags & zim::IndexArticle::blockFormatFlag)
+    {
+      dumpIndexBlocks();
+      return;
+    }
+
     // process categories
     for (unsigned c = 0, flag = 1; c < 4; ++c, flag <<= 1)
     {
@@ -225,6 +235,39 @@ void ZimDumper::dumpIndex()
     std::cout << "no index article\n";
 }
 
+void ZimDumper::dumpIndexBlocks()
+{
+  zim::IndexArticle index(*pos);
+
+  for (unsigned c = 0; c < 4; ++c)
+  {
+    if (index.getCategoryCount(c) == 0)
+      continue;
+
+    const zim::IndexArticle::BlocksType& blocks = index.getBlocks(c);
+    if (verbose)
+    {
+      std::cout << 'c' << c << "\tcount=" << index.getCategoryCount(c) << "\tblocks=" << blocks.size() << std::endl;
+      for (zim::IndexArticle::BlocksType::const_iterator it = blocks.begin(); it != blocks.end(); ++it)
+        std::cout << 'c' << c << "\tblock maxidx=" << it->maxIndex << "\toffset=" << it->offset << "\tsize=" << it->size << "\tcount=" << it->count << std::endl;
+    }
+    else
+      std::cout << 'c' << c;
+
+    const zim::IndexArticle::EntriesType& entries = index.getCategory(c);
+    for (zim::IndexArticle::EntriesType::const_iterator it = entries.begin(); it != entries.end(); ++it)
+    {
+      if (verbose)
+        std::cout << 'c' << c << "\tidx=" << it->index << "\tpos=" << it->pos << std::endl;
+      else
+        std::cout << '\t' << it->index << ';' << it->pos;
+    }
+
+    if (!verbose)
+      std::cout << std::endl;
+  }
+}
+
 void ZimDumper::listArticles(bool info, bool listTable, bool extra)
 {
   log_trace("listArticles(" << info << ", " << extra << ") verbose=" << verbose);
@@ -293,6 +336,8 @@ void ZimDumper::listArticle(const zim::Article& article, bool extra)
         case zim::zimcompLzma:    std::cout << "lzma"; break;
         default:                  std::cout << "unknown (" << static_cast<unsigned>(cluster.getCompression()) << ')'; break;
       }
+      if (cluster.getBlockSize() > 0)
+        std::cout << " in blocks of " << cluster.getBlockSize() << " bytes";
       std::cout << "\n";
     }
   }
@@ -414,9 +459,48 @@ void ZimDumper::dumpFiles(const std::string& directory)
   }
 }
 
+namespace
+{
+  // prints the percentage of the file verified so far to stderr
+  class VerifyProgress : public zim::Progress
+  {
+      unsigned percent;
+
+    public:
+      VerifyProgress()
+        : percent(0)
+        { }
+
+      ~VerifyProgress()
+      {
+        if (percent > 0)
+          std::cerr << std::endl;
+      }
+
+      void progress(zim::offset_type done, zim::offset_type total)
+      {
+        unsigned p = static_cast<unsigned>(done * 100 / total);
+        if (p > percent)
+        {
+          percent = p;
+          std::cerr << "\rverify checksum " << p << "% (" << done / (1024 * 1024) << " MB)" << std::flush;
+        }
+      }
+  };
+}
+
 void ZimDumper::verifyChecksum()
 {
-  if (file.verify())
+  bool ok;
+  if (verbose || ::isatty(2))
+  {
+    VerifyProgress progress;
+    ok = file.verify(&progress);
+  }
+  else
+    ok = file.verify();
+
+  if (ok)
     std::cout << "checksum ok" << std::endl;
   else
     std::cout << "no checksum" << std::endl;
@@ -468,7 +552,7 @@ int main(int argc, char* argv[])
                    "  -v        verbose (print uncompressed length of articles when -i is set)\n"
                    "                    (print namespaces with counts with -F)\n"
                    "  -Z        dump index data\n"
-                   "  -C        verify checksum\n"
+                   "  -C        verify checksum (shows progress on a terminal or with -v)\n"
                    "\n"
                    "examples:\n"
                    "  " << argv[0] << " -F wikipedia.zim\n"
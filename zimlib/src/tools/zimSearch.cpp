@@ -18,9 +18,14 @@
  */
 
 #include <iostream>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
 #include "log.h"
 #include "arg.h"
 #include <zim/search.h>
+#include <zim/articlesearch.h>
+#include <zim/multisearch.h>
 
 void zimSearch(zim::Search& search, const std::string& s)
 {
@@ -33,6 +38,49 @@ void zimSearch(zim::Search& search, const std::string& s)
     }
 }
 
+void zimTitleSearch(const zim::File& file, char ns, const std::string& s)
+{
+    zim::ArticleSearch search(file, ns);
+    zim::ArticleSearch::Results result = search.search(s);
+
+    for (zim::ArticleSearch::Results::const_iterator it = result.begin(); it != result.end(); ++it)
+    {
+      std::cout << "article " << it->getIndex() << "\t:\t" << it->getTitle() << std::endl;
+    }
+}
+
+void zimLibrarySearch(const std::string& library, unsigned threads, unsigned timeout, const std::string& s)
+{
+    std::ifstream in(library.c_str());
+    if (!in)
+      throw std::runtime_error("failed to open library file \"" + library + '"');
+
+    // each line names a zim file optionally followed by its index file
+    zim::MultiSearch search(threads);
+    std::string line;
+    while (std::getline(in, line))
+    {
+      std::istringstream l(line);
+      std::string zimfile, indexfile;
+      if (!(l >> zimfile) || zimfile[0] == '#')
+        continue;
+      if (l >> indexfile)
+        search.add(zim::File(zimfile), zim::File(indexfile));
+      else
+        search.add(zim::File(zimfile));
+    }
+
+    zim::MultiSearch::Results result;
+    zim::size_type count = search.search(result, s, 100, timeout);
+    if (count < search.size())
+      std::cerr << "only " << count << " of " << search.size() << " files searched in time" << std::endl;
+
+    for (zim::MultiSearch::Results::const_iterator it = result.begin(); it != result.end(); ++it)
+    {
+      std::cout << it->getArticle().getFile().getFilename() << "\tarticle " << it->getArticle().getIndex() << "\tpriority " << it->getPriority() << "\t:\t" << it->getArticle().getTitle() << std::endl;
+    }
+}
+
 int main(int argc, char* argv[])
 {
   try
@@ -40,6 +88,12 @@ int main(int argc, char* argv[])
     log_init();
 
     zim::Arg<std::string> indexfile(argc, argv, 'x');
+    zim::Arg<bool> titleSearch(argc, argv, 't');
+    zim::Arg<char> ns(argc, argv, 'n', 'A');
+    zim::Arg<bool> writeTitleIndex(argc, argv, "--write-title-index");
+    zim::Arg<std::string> library(argc, argv, 'l');
+    zim::Arg<unsigned> threads(argc, argv, 'j', 0);
+    zim::Arg<unsigned> timeout(argc, argv, 'T', 0);
 
     zim::Arg<double> weightOcc(argc, argv, "--weight-occ");
     zim::Arg<double> weightOccOff(argc, argv, "--weight-occ-off");
@@ -64,12 +118,42 @@ int main(int argc, char* argv[])
     if (weightDistinctWords.isSet())
       zim::Search::setWeightDistinctWords(weightDistinctWords);
 
+    if (writeTitleIndex && argc == 2)
+    {
+      zim::File(argv[1]).writeTitleIndex(ns);
+      return 0;
+    }
+
+    if (library.isSet() && argc > 1)
+    {
+      std::string s = argv[1];
+      for (int a = 2; a < argc; ++a)
+      {
+        s += ' ';
+        s += argv[a];
+      }
+
+      zimLibrarySearch(library, threads, timeout, s);
+      return 0;
+    }
+
     if (argc <= 2)
     {
       std::cerr << "usage: " << argv[0] << " [-x indexfile] zimfile searchstring\n"
+                   "       " << argv[0] << " -t [-n ns] zimfile substring\n"
+                   "       " << argv[0] << " --write-title-index [-n ns] zimfile\n"
+                   "       " << argv[0] << " -l library [-j threads] [-T timeout] searchstring\n"
                    "\n"
                    "options\n"
                    "  -x indexfile   specify indexfile\n"
+                   "  -t             search article titles containing substring\n"
+                   "  -n ns          namespace for title search (default 'A')\n"
+                   "  --write-title-index\n"
+                   "                 write the title search index to a file next to the zim file\n"
+                   "  -l library     search all zim files listed in the file library, one\n"
+                   "                 per line, each optionally followed by its index file\n"
+                   "  -j threads     number of threads searching the library\n"
+                   "  -T timeout     return the results found within timeout milliseconds\n"
                    "options to tune search parameters:)\n"
                    "  --weight-occ number (default " << zim::Search::getWeightOcc() << ")\n"
                    "  --weight-occ-off number (default " << zim::Search::getWeightOccOff() << ")\n"
@@ -89,7 +173,11 @@ int main(int argc, char* argv[])
       s += argv[a];
     }
 
-    if (indexfile.isSet())
+    if (titleSearch)
+    {
+      zimTitleSearch(zim::File(argv[1]), ns, s);
+    }
+    else if (indexfile.isSet())
     {
       zim::Search search = zim::Search(zim::File(argv[1]), zim::File(indexfile));
       zimSearch(search, s);
@@ -24,6 +24,7 @@
 #include <zim/endian.h>
 #include <algorithm>
 #include <fstream>
+#include <set>
 
 #ifdef _WIN32
 #include <io.h>
@@ -36,8 +37,14 @@
 #include <stdexcept>
 #include "config.h"
 #include "arg.h"
-#include "md5stream.h"
-#include "tee.h"
+#include "md5file.h"
+#include "envvalue.h"
+#include "clusterwriter.h"
+#include "codecselector.h"
+#include "deduptable.h"
+#include "extsort.h"
+#include "filerange.h"
+#include "sortkeys.h"
 #include "log.h"
 
 log_define("zim.writer.creator")
@@ -52,8 +59,136 @@ namespace zim
 {
   namespace writer
   {
+    namespace
+    {
+      // Records of the external sorters and the temporary dirent files.
+      // Numbers are stored little endian with 4 bytes, strings length
+      // prefixed.
+
+      void putNumber(std::string& s, size_type n)
+      {
+        char d[4];
+        toLittleEndian(n, d);
+        s.append(d, 4);
+      }
+
+      size_type getNumber(const std::string& s, std::string::size_type& pos)
+      {
+        if (pos + 4 > s.size())
+          throw std::runtime_error("invalid record in temporary file");
+        size_type n = fromLittleEndian(reinterpret_cast<const size_type*>(s.data() + pos));
+        pos += 4;
+        return n;
+      }
+
+      std::string numberRecord(size_type n1, size_type n2 = 0)
+      {
+        std::string s;
+        putNumber(s, n1);
+        putNumber(s, n2);
+        return s;
+      }
+
+      void putString(std::string& s, const std::string& v)
+      {
+        putNumber(s, v.size());
+        s += v;
+      }
+
+      std::string getString(const std::string& s, std::string::size_type& pos)
+      {
+        size_type size = getNumber(s, pos);
+        if (pos + size > s.size())
+          throw std::runtime_error("invalid record in temporary file");
+        std::string v(s, pos, size);
+        pos += size;
+        return v;
+      }
+
+      // seq is the number of the dirent in the order of the article source
+      std::string serializeDirent(const Dirent& dirent, size_type seq)
+      {
+        std::string s;
+        putNumber(s, seq);
+        putNumber(s, dirent.getMimeType());
+        putNumber(s, dirent.getVersion());
+        putNumber(s, dirent.getClusterNumber());
+        putNumber(s, dirent.getBlobNumber());
+        putNumber(s, dirent.getRedirectIndex());
+        putNumber(s, dirent.getIdx());
+        putNumber(s, dirent.getClusterGroup());
+        s += dirent.getNamespace();
+        s += static_cast<char>((dirent.isArticle() && dirent.isCompress() ? 1 : 0)
+                             | (dirent.isPacked() ? 2 : 0));
+        putString(s, dirent.getUrl());
+        putString(s, dirent.getTitle());
+        putString(s, dirent.getParameter());
+        putString(s, dirent.getAid());
+        putString(s, dirent.getRedirectAid());
+        return s;
+      }
+
+      Dirent deserializeDirent(const std::string& s, size_type& seq)
+      {
+        std::string::size_type pos = 0;
+        seq = getNumber(s, pos);
+        uint16_t mimeType = static_cast<uint16_t>(getNumber(s, pos));
+        size_type version = getNumber(s, pos);
+        size_type clusterNumber = getNumber(s, pos);
+        size_type blobNumber = getNumber(s, pos);
+        size_type redirectIndex = getNumber(s, pos);
+        size_type idx = getNumber(s, pos);
+        size_type clusterGroup = getNumber(s, pos);
+        if (pos + 2 > s.size())
+          throw std::runtime_error("invalid record in temporary file");
+        char ns = s[pos++];
+        char flags = s[pos++];
+
+        Dirent dirent;
+        std::string url = getString(s, pos);
+        dirent.setUrl(ns, url);
+        dirent.setTitle(getString(s, pos));
+        dirent.setParameter(getString(s, pos));
+        dirent.setAid(getString(s, pos));
+        dirent.setRedirectAid(getString(s, pos));
+        dirent.setVersion(version);
+        dirent.setIdx(idx);
+        dirent.setClusterGroup(clusterGroup);
+        dirent.setCompress((flags & 1) != 0);
+        dirent.setPacked((flags & 2) != 0);
+        dirent.setArticle(mimeType, clusterNumber, blobNumber);
+        if (dirent.isRedirect())
+          dirent.setRedirect(redirectIndex);
+        return dirent;
+      }
+
+      // Validity of a redirect while following redirect chains. A chain is
+      // followed once up to its end or to a redirect decided before and
+      // all redirects on the way get the result. Redirects in a cycle stay
+      // valid.
+      enum RedirectState
+      {
+        redirectUnknown,
+        redirectVisiting,
+        redirectValid,
+        redirectInvalid
+      };
+    }
+
+    const offset_type ZimCreator::mimeListReserve;
+    const unsigned ZimCreator::maxOpenClusters;
+    const size_type ZimCreator::minFileClusterSize;
+
     ZimCreator::ZimCreator()
       : minChunkSize(1024-64),
+        compressionThreads(envValue("ZIM_COMPRESSION_THREADS", 4)),
+        maxDirentMemory(0),
+        deduplicate(true),
+        clusterStrategy(clusterByUrl),
+        adaptiveCompression(false),
+        compressionBudget(0),
+        minDecodeSpeed(0),
+        blockSize(0),
         nextMimeIdx(0),
 #ifdef ENABLE_LZMA
         compression(zimcompLzma)
@@ -68,7 +203,15 @@ namespace zim
     }
 
     ZimCreator::ZimCreator(int& argc, char* argv[])
-      : nextMimeIdx(0),
+      : compressionThreads(envValue("ZIM_COMPRESSION_THREADS", 4)),
+        maxDirentMemory(0),
+        deduplicate(true),
+        clusterStrategy(clusterByUrl),
+        adaptiveCompression(false),
+        compressionBudget(0),
+        minDecodeSpeed(0),
+        blockSize(0),
+        nextMimeIdx(0),
 #ifdef ENABLE_LZMA
         compression(zimcompLzma)
 #elif ENABLE_BZIP2
@@ -85,6 +228,39 @@ namespace zim
       else
         minChunkSize = Arg<unsigned>(argc, argv, 's', 1024-64);
 
+      Arg<unsigned> threadsArg(argc, argv, "--threads");
+      if (threadsArg.isSet())
+        compressionThreads = threadsArg;
+      else
+        compressionThreads = Arg<unsigned>(argc, argv, 'j', compressionThreads);
+
+      maxDirentMemory = Arg<unsigned>(argc, argv, "--dirent-memory", 0);
+
+      if (Arg<bool>(argc, argv, "--no-dedup"))
+        deduplicate = false;
+
+      Arg<std::string> clusterByArg(argc, argv, "--cluster-by");
+      if (clusterByArg.isSet())
+      {
+        std::string s = clusterByArg;
+        if (s == "url")
+          clusterStrategy = clusterByUrl;
+        else if (s == "mime")
+          clusterStrategy = clusterByMimeType;
+        else if (s == "hint")
+          clusterStrategy = clusterByHint;
+        else if (s == "title")
+          clusterStrategy = clusterByTitle;
+        else
+          throw std::runtime_error("unknown cluster strategy \"" + s + "\"; expected url, mime, hint or title");
+      }
+
+      if (Arg<bool>(argc, argv, "--adaptive"))
+        adaptiveCompression = true;
+      compressionBudget = Arg<unsigned>(argc, argv, "--compression-budget", 0);
+      minDecodeSpeed = Arg<unsigned>(argc, argv, "--min-decode-speed", 0);
+      blockSize = Arg<unsigned>(argc, argv, "--block-size", 0);
+
 #ifdef ENABLE_ZLIB
       if (Arg<bool>(argc, argv, "--zlib"))
         compression = zimcompZip;
@@ -108,18 +284,95 @@ namespace zim
                      ? fname.substr(0, fname.size() - 4)
                      : fname;
       log_debug("basename " << basename);
+      tmpBasename = basename;
 
-      INFO("create directory entries");
-      createDirents(src);
-      INFO(dirents.size() << " directory entries created");
+      // The clusters are written directly to the zim file after the mime
+      // type list. Everything, which depends on them, follows the clusters
+      // and the header is written last.
+      std::string zimfname = basename + ".zim";
+      std::ofstream out(zimfname.c_str(), std::ios::out | std::ios::trunc | std::ios::binary);
+      if (!out)
+        throw std::runtime_error("failed to create zim file " + zimfname);
+
+      CodecSelector selector(minDecodeSpeed, compressionBudget);
+      ClusterWriter writer(out, clusterOffsets, compressionThreads);
+      writer.setOutputFile(zimfname);
+      if (adaptiveCompression)
+        writer.setCodecSelector(&selector);
+
+      std::ifstream in(zimfname.c_str(), std::ios::in | std::ios::binary);
+      DedupTable blobs;
+      Cluster lastRead;
+
+      zimfile = &out;
+      clusterWriter = &writer;
+      openClusters.clear();
+      clusterNumbers.clear();
+      clusterHints.clear();
+      countPacked = 0;
+      dedupTable = &blobs;
+      countDuplicates = 0;
+      zimReader = &in;
+      readCluster = &lastRead;
+      readClusterNumber = DedupTable::npos;
+      mimeListStart = Fileheader::size;
+      clustersStart = 0;
+
+      if (maxDirentMemory > 0)
+      {
+        // the title index is created by the external sort too
+        INFO("create directory entries in temporary files");
+        createDirentsExternal(src);
+        INFO(articleCount() << " directory entries created");
+      }
+      else
+      {
+        INFO("create directory entries");
+        createDirents(src);
+        INFO(articleCount() << " directory entries created");
 
-      INFO("create title index");
-      createTitleIndex(src);
-      INFO(dirents.size() << " title index created");
+        INFO("create title index");
+        createTitleIndex(src);
+        INFO(articleCount() << " title index created");
+      }
+
+      if (clustersStart == 0)
+      {
+        out.seekp(mimeListPos());
+        writeMimeTypes(out);
+        clustersStart = out.tellp();
+      }
+      else
+      {
+        // Articles with data are already packed after the space reserved
+        // for the mime type list. If the list does not fit there, it is
+        // written after these clusters, which is fine for readers using
+        // the header.
+        offset_type pos = out.tellp();
+        if (mimeListSize() > mimeListReserve)
+        {
+          log_warn("mime type list of " << mimeListSize() << " bytes exceeds reserved space; write it after the clusters");
+          mimeListStart = pos;
+        }
+
+        out.seekp(mimeListPos());
+        writeMimeTypes(out);
+        if (mimeListPos() != pos)
+          out.seekp(pos);
+      }
 
       INFO("create clusters");
-      createClusters(src, basename + ".tmp");
+      createClusters(src);
       INFO(clusterOffsets.size() << " clusters created");
+      if (deduplicate)
+        INFO(countDuplicates << " duplicate blobs shared");
+      if (adaptiveCompression)
+        INFO("adaptive compression: " << selector.getCount(zimcompZip) << " zlib, "
+          << selector.getCount(zimcompLzma) << " lzma, "
+          << selector.getCount(zimcompBzip2) << " bzip2, "
+          << selector.getCount(zimcompNone) << " uncompressed clusters; "
+          << selector.getCountFallback() << " without sampling; "
+          << selector.getTime() << "s cpu");
 
       INFO("create geo index");
       createGeoIndex();
@@ -128,14 +381,79 @@ namespace zim
       INFO("fill header");
       fillHeader(src);
 
+      zimfile = 0;
+      clusterWriter = 0;
+      dedupTable = 0;
+      zimReader = 0;
+      readCluster = 0;
+
       INFO("write zimfile");
-      write(basename + ".zim", basename + ".tmp");
+      write(out);
+
+      if (maxDirentMemory > 0)
+        ::remove(clusteredTmpName().c_str());
 
-      ::remove((basename + ".tmp").c_str());
+      INFO("write checksum");
+      writeChecksum(out, zimfname);
 
       INFO("ready");
     }
 
+    Dirent ZimCreator::createDirent(const Article& article)
+    {
+      Dirent dirent;
+      dirent.setAid(article.getAid());
+      dirent.setUrl(article.getNamespace(), article.getUrl());
+      dirent.setTitle(article.getTitle());
+      dirent.setParameter(article.getParameter());
+
+      log_debug("article " << dirent.getLongUrl() << " fetched");
+
+      if (article.isRedirect())
+      {
+        dirent.setRedirect(0);
+        dirent.setRedirectAid(article.getRedirectAid());
+        log_debug("is redirect to " << dirent.getRedirectAid());
+      }
+      else if (article.isLinktarget())
+      {
+        dirent.setLinktarget();
+      }
+      else if (article.isDeleted())
+      {
+        dirent.setDeleted();
+      }
+      else
+      {
+        uint16_t mimeType = getMimeTypeIdx(article.getMimeType());
+        dirent.setArticle(mimeType, 0, 0);
+        dirent.setCompress(article.shouldCompress());
+        dirent.setClusterGroup(getClusterGroup(article, mimeType));
+        log_debug("is article; mimetype " << dirent.getMimeType());
+      }
+
+      return dirent;
+    }
+
+    size_type ZimCreator::getClusterGroup(const Article& article, uint16_t mimeType)
+    {
+      switch (clusterStrategy)
+      {
+        case clusterByMimeType:
+          return mimeType;
+
+        case clusterByHint:
+        {
+          ClusterHints::iterator it = clusterHints.insert(
+            ClusterHints::value_type(article.getClusterHint(), clusterHints.size())).first;
+          return it->second;
+        }
+
+        default:
+          return 0;
+      }
+    }
+
     void ZimCreator::createDirents(ArticleSource& src)
     {
       INFO("collect articles");
@@ -143,206 +461,692 @@ namespace zim
       const Article* article;
       while ((article = src.getNextArticle()) != 0)
       {
-        Dirent dirent;
-        dirent.setAid(article->getAid());
-        dirent.setUrl(article->getNamespace(), article->getUrl());
-        dirent.setTitle(article->getTitle());
-        dirent.setParameter(article->getParameter());
+        Dirent dirent = createDirent(*article);
+        if (article->hasData())
+          addArticleData(*article, dirent, dirents.size());
+        dirents.push_back(dirent);
+      }
 
-        log_debug("article " << dirent.getLongUrl() << " fetched");
+      // dirent numbers in aid order, so that redirect targets are found
+      // without moving the dirents
+      INFO("sort " << dirents.size() << " directory entries (aid)");
+      const size_type noTarget = SortKeys::notFound;
+      SizeVectorType targets(dirents.size(), noTarget);
 
-        if (article->isRedirect())
+      {
+        SortKeys aids;
+        size_type poolSize = 0;
+        for (DirentsType::size_type n = 0; n < dirents.size(); ++n)
+          poolSize += dirents.getAid(n).size();
+        aids.reserve(dirents.size(), poolSize);
+        for (DirentsType::size_type n = 0; n < dirents.size(); ++n)
+          aids.add(dirents.getAid(n), n);
+        aids.sort(compressionThreads);
+
+        INFO("resolve redirects");
+        for (DirentsType::size_type n = 0; n < dirents.size(); ++n)
         {
-          dirent.setRedirect(0);
-          dirent.setRedirectAid(article->getRedirectAid());
-          log_debug("is redirect to " << dirent.getRedirectAid());
+          if (dirents.isRedirect(n))
+            targets[n] = aids.find(dirents.getRedirectAid(n));
         }
-        else if (article->isLinktarget())
+      }
+
+      // remove invalid redirects; a redirect to a removed redirect is
+      // invalid too
+      INFO("remove invalid redirects from " << dirents.size() << " directory entries");
+      std::vector<char> state(dirents.size(), redirectUnknown);
+      SizeVectorType path;
+      for (DirentsType::size_type n = 0; n < dirents.size(); ++n)
+      {
+        if (!dirents.isRedirect(n) || state[n] != redirectUnknown)
+          continue;
+
+        path.clear();
+        size_type m = n;
+        char result;
+        while (true)
         {
-          dirent.setLinktarget();
+          if (m == noTarget)
+          {
+            result = redirectInvalid;
+            break;
+          }
+          if (!dirents.isRedirect(m) || state[m] == redirectVisiting)
+          {
+            result = redirectValid;
+            break;
+          }
+          if (state[m] != redirectUnknown)
+          {
+            result = state[m];
+            break;
+          }
+          state[m] = redirectVisiting;
+          path.push_back(m);
+          m = targets[m];
         }
-        else if (article->isDeleted())
+
+        for (SizeVectorType::const_iterator it = path.begin(); it != path.end(); ++it)
+          state[*it] = result;
+      }
+
+      std::vector<bool> removed(dirents.size(), false);
+      DirentsType::size_type countRemoved = 0;
+      for (DirentsType::size_type n = 0; n < dirents.size(); ++n)
+      {
+        if (state[n] == redirectInvalid)
         {
-          dirent.setDeleted();
+          log_debug("remove invalid redirection " << dirents.getTitle(n));
+          removed[n] = true;
+          ++countRemoved;
         }
-        else
+      }
+
+      // sort the remaining dirent numbers by url and put the removed ones
+      // at the end
+      INFO("sort " << dirents.size() - countRemoved << " directory entries (url)");
+      SizeVectorType order;
+      order.reserve(dirents.size());
+
+      {
+        SortKeys urls;
+        size_type poolSize = 0;
+        for (DirentsType::size_type n = 0; n < dirents.size(); ++n)
+          if (!removed[n])
+            poolSize += dirents.getUrl(n).size() + 1;
+        urls.reserve(dirents.size() - countRemoved, poolSize);
+        for (DirentsType::size_type n = 0; n < dirents.size(); ++n)
+          if (!removed[n])
+            urls.add(dirents.getNamespace(n), dirents.getUrl(n), n);
+        urls.sort(compressionThreads);
+
+        for (size_type n = 0; n < urls.size(); ++n)
+          order.push_back(urls.getNumber(n));
+      }
+
+      for (DirentsType::size_type n = 0; n < dirents.size(); ++n)
+        if (removed[n])
+          order.push_back(n);
+
+      // set index and translate redirect aid to index
+      INFO("set index");
+      for (SizeVectorType::size_type i = 0; i < order.size(); ++i)
+        dirents.setIdx(order[i], i);
+
+      // geo points of packed articles were added with their dirent number
+      for (ArticleGeoPointIterator it = articleGeoPoints.begin(); it != articleGeoPoints.end(); ++it)
+        it->index = dirents.getIdx(it->index);
+
+      for (DirentsType::size_type n = 0; n < dirents.size(); ++n)
+      {
+        if (dirents.isRedirect(n) && !removed[n])
         {
-          dirent.setArticle(getMimeTypeIdx(article->getMimeType()), 0, 0);
-          dirent.setCompress(article->shouldCompress());
-          log_debug("is article; mimetype " << dirent.getMimeType());
+          log_debug("redirect aid=" << dirents.getRedirectAid(n) << " redirect index=" << dirents.getIdx(targets[n]));
+          dirents.setRedirect(n, dirents.getIdx(targets[n]));
         }
-
-        dirents.push_back(dirent);
       }
 
-      // sort
-      INFO("sort " << dirents.size() << " directory entries (aid)");
-      std::sort(dirents.begin(), dirents.end(), compareAid);
+      // move the dirents to their url position
+      dirents.permute(order);
+      dirents.resize(dirents.size() - countRemoved);
+      countDirents = dirents.size();
+    }
+
+    void ZimCreator::createDirentsExternal(ArticleSource& src)
+    {
+      // Every sorter gets a quarter of the budget, since up to four of
+      // them are filled at the same time.
+      offset_type budget = (static_cast<offset_type>(maxDirentMemory) << 20) / 4;
+      size_type sorterMemory = static_cast<size_type>(std::min(budget,
+          static_cast<offset_type>(std::numeric_limits<size_type>::max())));
+
+      std::string key, data;
+      std::set<size_type> removed;   // invalid redirects by seq
+
+      ExternalSorter urls(tmpBasename + ".url.tmp", sorterMemory, compressionThreads);
 
-      // remove invalid redirects
-      INFO("remove invalid redirects from " << dirents.size() << " directory entries");
-      DirentsType::size_type di = 0;
-      while (di < dirents.size())
       {
-        if (dirents[di].isRedirect())
+        ExternalSorter aids(tmpBasename + ".aid.tmp", sorterMemory, compressionThreads);
+        ExternalSorter redirectAids(tmpBasename + ".redirect.tmp", sorterMemory, compressionThreads);
+
+        INFO("collect articles");
+
+        size_type seq = 0;
+        const Article* article;
+        while ((article = src.getNextArticle()) != 0)
         {
-          log_debug("check " << dirents[di].getTitle() << " redirect to " << dirents[di].getRedirectAid() << " (" << di << '/' << dirents.size() << ')');
+          Dirent dirent = createDirent(*article);
+          if (article->hasData())
+            addArticleData(*article, dirent, seq);
+          urls.add(dirent.getNamespace(), dirent.getUrl(), serializeDirent(dirent, seq));
+          aids.add(dirent.getAid(), numberRecord(seq, dirent.isRedirect()));
+          if (dirent.isRedirect())
+            redirectAids.add(dirent.getRedirectAid(), numberRecord(seq));
+          ++seq;
+        }
+
+        INFO("sort " << seq << " directory entries (aid)");
+        aids.sort();
+        redirectAids.sort();
+
+        // Merge join of the redirect aids with the aids. Records with equal
+        // keys come in source order, so the first one of an aid is the
+        // target, like in memory.
+        INFO("resolve redirects");
+        typedef std::vector<std::pair<size_type, size_type> > ChainsType;
+        ChainsType chains;   // redirects to redirects
+        std::string aid, aidData;
+        bool haveAid = aids.next(aid, aidData);
+        while (redirectAids.next(key, data))
+        {
+          std::string::size_type pos = 0;
+          size_type redirect = getNumber(data, pos);
+
+          while (haveAid && aid < key)
+            haveAid = aids.next(aid, aidData);
 
-          if (!std::binary_search(dirents.begin(), dirents.end(), Dirent(dirents[di].getRedirectAid()), compareAid))
+          if (!haveAid || aid != key)
           {
-            log_debug("remove invalid redirection " << dirents[di].getTitle());
-            dirents.erase(dirents.begin() + di);
+            removed.insert(redirect);
             continue;
           }
+
+          pos = 0;
+          size_type target = getNumber(aidData, pos);
+          if (getNumber(aidData, pos))
+            chains.push_back(ChainsType::value_type(redirect, target));
         }
 
-        ++di;
+        // a redirect to a removed redirect is invalid too; the chains are
+        // sorted by redirect to find the next link of a chain
+        std::sort(chains.begin(), chains.end());
+        std::vector<char> state(chains.size(), redirectUnknown);
+        std::vector<ChainsType::size_type> path;
+        for (ChainsType::size_type n = 0; n < chains.size(); ++n)
+        {
+          if (state[n] != redirectUnknown)
+            continue;
+
+          path.clear();
+          ChainsType::size_type c = n;
+          char result;
+          while (true)
+          {
+            if (state[c] == redirectVisiting)
+            {
+              result = redirectValid;
+              break;
+            }
+            if (state[c] != redirectUnknown)
+            {
+              result = state[c];
+              break;
+            }
+            state[c] = redirectVisiting;
+            path.push_back(c);
+
+            size_type target = chains[c].second;
+            if (removed.count(target))
+            {
+              result = redirectInvalid;
+              break;
+            }
+
+            ChainsType::const_iterator it = std::lower_bound(chains.begin(), chains.end(),
+                                                             ChainsType::value_type(target, 0));
+            if (it == chains.end() || it->first != target)
+            {
+              result = redirectValid;
+              break;
+            }
+            c = it - chains.begin();
+          }
+
+          for (std::vector<ChainsType::size_type>::const_iterator it = path.begin(); it != path.end(); ++it)
+          {
+            state[*it] = result;
+            if (result == redirectInvalid)
+              removed.insert(chains[*it].first);
+          }
+        }
       }
 
-      // sort
-      INFO("sort " << dirents.size() << " directory entries (url)");
-      std::sort(dirents.begin(), dirents.end(), compareUrl);
+      // Assign the indexes in url order and write the dirents in that order
+      // to a temporary file. The redirect targets and the title order are
+      // found by sorting again.
+      INFO("sort directory entries (url); " << removed.size() << " invalid redirects removed");
+      urls.sort();
 
-      // set index
-      INFO("set index");
-      unsigned idx = 0;
-      for (DirentsType::iterator di = dirents.begin(); di != dirents.end(); ++di)
-        di->setIdx(idx++);
+      std::ofstream direntsFile(direntsTmpName().c_str(), std::ios::out | std::ios::trunc | std::ios::binary);
+      if (!direntsFile)
+        throw std::runtime_error("failed to create temporary file " + direntsTmpName());
 
-      // sort
-      log_debug("sort " << dirents.size() << " directory entries (aid)");
-      std::sort(dirents.begin(), dirents.end(), compareAid);
+      ExternalSorter targetAids(tmpBasename + ".aididx.tmp", sorterMemory, compressionThreads);
+      ExternalSorter redirectIdx(tmpBasename + ".redirectidx.tmp", sorterMemory, compressionThreads);
+      ExternalSorter titles(tmpBasename + ".title.tmp", sorterMemory, compressionThreads);
 
-      // translate redirect aid to index
-      INFO("translate redirect aid to index");
-      for (DirentsType::iterator di = dirents.begin(); di != dirents.end(); ++di)
+      // geo points of packed articles were added with their seq
+      SizeVectorType geoSeqs;
+      geoSeqs.reserve(articleGeoPoints.size());
+      for (ArticleGeoPointIterator it = articleGeoPoints.begin(); it != articleGeoPoints.end(); ++it)
+        geoSeqs.push_back(it->index);
+
+      countDirents = 0;
+      while (urls.next(key, data))
       {
-        if (di->isRedirect())
+        size_type seq;
+        Dirent dirent = deserializeDirent(data, seq);
+        if (removed.count(seq))
         {
-          DirentsType::iterator ddi = std::lower_bound(dirents.begin(), dirents.end(), di->getRedirectAid(), compareAid);
-          if (ddi != dirents.end() && ddi->getAid() == di->getRedirectAid())
-          {
-            log_debug("redirect aid=" << ddi->getAid() << " redirect index=" << ddi->getIdx());
-            di->setRedirect(ddi->getIdx());
-          }
-          else
-          {
-            std::ostringstream msg;
-            msg << "internal error: redirect aid " << di->getRedirectAid() << " not found";
-            log_fatal(msg.str());
-            throw std::runtime_error(msg.str());
-          }
+          log_debug("remove invalid redirection " << dirent.getTitle());
+          continue;
         }
-      }
 
-      // sort
-      log_debug("sort " << dirents.size() << " directory entries (url)");
-      std::sort(dirents.begin(), dirents.end(), compareUrl);
+        if (dirent.isPacked())
+        {
+          SizeVectorType::iterator it = std::lower_bound(geoSeqs.begin(), geoSeqs.end(), seq);
+          if (it != geoSeqs.end() && *it == seq)
+            articleGeoPoints[it - geoSeqs.begin()].index = countDirents;
+        }
 
-    }
+        dirent.setIdx(countDirents);
+        writeRecord(direntsFile, serializeDirent(dirent, seq));
+        targetAids.add(dirent.getAid(), numberRecord(seq, countDirents));
+        if (dirent.isRedirect())
+          redirectIdx.add(dirent.getRedirectAid(), numberRecord(countDirents));
+        titles.add(dirent.getNamespace(), dirent.getTitle(), numberRecord(countDirents));
+        ++countDirents;
+      }
 
-    namespace
-    {
-      class CompareTitle
+      direntsFile.close();
+      if (!direntsFile)
+        throw std::runtime_error("failed to write temporary file " + direntsTmpName());
+
+      // translate redirect aid to index; the target is the remaining dirent
+      // with the aid, which came first from the article source
+      INFO("set redirect index");
+      targetAids.sort();
+      redirectIdx.sort();
+      redirectTargets.assign(countDirents, 0);
+
+      std::string aid, aidData, groupAid;
+      size_type groupIdx = SortKeys::notFound;
+      bool haveAid = targetAids.next(aid, aidData);
+      while (redirectIdx.next(key, data))
       {
-          ZimCreator::DirentsType& dirents;
+        if (groupIdx == SortKeys::notFound || groupAid != key)
+        {
+          while (haveAid && aid < key)
+            haveAid = targetAids.next(aid, aidData);
 
-        public:
-          explicit CompareTitle(ZimCreator::DirentsType& dirents_)
-            : dirents(dirents_)
-            { }
-          bool operator() (size_type titleIdx1, size_type titleIdx2) const
+          groupAid = key;
+          groupIdx = SortKeys::notFound;
+          size_type groupSeq = SortKeys::notFound;
+          for ( ; haveAid && aid == key; haveAid = targetAids.next(aid, aidData))
           {
-            Dirent d1 = dirents[titleIdx1];
-            Dirent d2 = dirents[titleIdx2];
-            return d1.getNamespace() < d2.getNamespace()
-               || (d1.getNamespace() == d2.getNamespace()
-                && d1.getTitle() < d2.getTitle());
+            std::string::size_type pos = 0;
+            size_type seq = getNumber(aidData, pos);
+            if (groupIdx == SortKeys::notFound || seq < groupSeq)
+            {
+              groupSeq = seq;
+              groupIdx = getNumber(aidData, pos);
+            }
           }
-      };
+
+          if (groupIdx == SortKeys::notFound)
+            throw std::runtime_error("redirect target " + key + " not found");
+        }
+
+        std::string::size_type pos = 0;
+        redirectTargets[getNumber(data, pos)] = groupIdx;
+      }
+
+      INFO("create title index");
+      titles.sort();
+      titleIdx.clear();
+      titleIdx.reserve(countDirents);
+      while (titles.next(key, data))
+      {
+        std::string::size_type pos = 0;
+        titleIdx.push_back(getNumber(data, pos));
+      }
     }
 
     void ZimCreator::createTitleIndex(ArticleSource& src)
     {
-      titleIdx.resize(dirents.size());
+      SortKeys titles;
+      size_type poolSize = 0;
+      for (DirentsType::size_type n = 0; n < dirents.size(); ++n)
+        poolSize += dirents.getTitle(n).size() + 1;
+      titles.reserve(dirents.size(), poolSize);
       for (DirentsType::size_type n = 0; n < dirents.size(); ++n)
-        titleIdx[n] = dirents[n].getIdx();
+        titles.add(dirents.getNamespace(n), dirents.getTitle(n), dirents.getIdx(n));
+      titles.sort(compressionThreads);
 
-      CompareTitle compareTitle(dirents);
-      std::sort(titleIdx.begin(), titleIdx.end(), compareTitle);
+      titleIdx.resize(dirents.size());
+      for (DirentsType::size_type n = 0; n < dirents.size(); ++n)
+        titleIdx[n] = titles.getNumber(n);
     }
 
-    void ZimCreator::createClusters(ArticleSource& src, const std::string& tmpfname)
+    void ZimCreator::createClusters(ArticleSource& src)
     {
-      std::ofstream out(tmpfname.c_str());
+      std::ostream& out = *zimfile;
 
-      Cluster cluster;
-      cluster.setCompression(compression);
+      size_type count = 0, progress = 0;
+      if (maxDirentMemory == 0)
+      {
+        bool byTitle = clusterStrategy == clusterByTitle;
+        for ( ; out && count < dirents.size(); ++count)
+        {
+          while (progress < count * 100 / dirents.size() + 1)
+          {
+            INFO(progress << "% ready");
+            progress += 10;
+          }
 
-      DirentsType::size_type count = 0, progress = 0;
-      for (DirentsType::iterator di = dirents.begin(); out && di != dirents.end(); ++di, ++count)
+          size_type n = byTitle ? titleIdx[count] : count;
+          Dirent dirent = dirents.get(n);
+          addDirentData(src, dirent);
+          dirents.update(n, dirent);
+        }
+      }
+      else
       {
-        while (progress < count * 100 / dirents.size() + 1)
+        if (clusterStrategy == clusterByTitle)
+          log_warn("title order needs the directory entries in memory; clusters are filled in url order");
+
+        // Stream the dirents from the temporary file in url order and write
+        // them with their cluster numbers and redirect indexes to another
+        // one. The main and layout page are looked up here as well.
+        std::string mainAid = src.getMainPage();
+        std::string layoutAid = src.getLayoutPage();
+        header.setMainPage(std::numeric_limits<size_type>::max());
+        header.setLayoutPage(std::numeric_limits<size_type>::max());
+
+        std::ifstream in(direntsTmpName().c_str(), std::ios::in | std::ios::binary);
+        std::ofstream clustered(clusteredTmpName().c_str(), std::ios::out | std::ios::trunc | std::ios::binary);
+        if (!in || !clustered)
+          throw std::runtime_error("failed to open temporary file " + direntsTmpName());
+
+        direntsSize = 0;
+        std::string data;
+        for ( ; out && readRecord(in, data); ++count)
         {
-          INFO(progress << "% ready");
-          progress += 10;
+          while (progress < count * 100 / countDirents + 1)
+          {
+            INFO(progress << "% ready");
+            progress += 10;
+          }
+
+          size_type seq;
+          Dirent dirent = deserializeDirent(data, seq);
+          if (dirent.isRedirect())
+            dirent.setRedirect(redirectTargets[dirent.getIdx()]);
+          else if (dirent.isArticle())
+            dirent.setMimeType(mimeMapping[dirent.getMimeType()]);
+
+          if (!mainAid.empty() && mainAid == dirent.getAid())
+            header.setMainPage(dirent.getIdx());
+          if (!layoutAid.empty() && layoutAid == dirent.getAid())
+            header.setLayoutPage(dirent.getIdx());
+
+          addDirentData(src, dirent);
+
+          direntsSize += dirent.getDirentSize();
+          writeRecord(clustered, serializeDirent(dirent, seq));
         }
 
-        if (di->isRedirect())
-          continue;
+        if (!clustered.flush() || (out && count != countDirents))
+          throw std::runtime_error("failed to copy temporary file " + direntsTmpName());
 
-        Blob blob = src.getData(di->getAid());
-        addGeoPoint(blob, di->getIdx());
+        in.close();
+        ::remove(direntsTmpName().c_str());
+        SizeVectorType().swap(redirectTargets);
+      }
 
-        if (blob.size() > 0)
-          isEmpty = false;
+      while (!openClusters.empty())
+        addCluster(openClusters.begin());
 
-        if (di->isCompress())
-        {
-          di->setCluster(clusterOffsets.size(), cluster.count());
-          cluster.addBlob(blob);
-          if (cluster.size() >= minChunkSize * 1024)
-          {
-            log_info("compress cluster with " << cluster.count() << " articles, " << cluster.size() << " bytes; current title \"" << di->getTitle() << '\"');
+      clusterWriter->flush();
 
-            clusterOffsets.push_back(out.tellp());
-            out << cluster;
-            log_debug("cluster compressed");
-            cluster.clear();
-            cluster.setCompression(compression);
-          }
+      for (DirentsType::size_type n = 0; n < dirents.size(); ++n)
+      {
+        if (!dirents.isRedirect(n))
+        {
+          Dirent dirent = dirents.get(n);
+          setClusterNumber(dirent);
+          dirents.update(n, dirent);
         }
-        else
+      }
+
+      if (!out)
+        throw std::runtime_error("failed to write clusters");
+
+      if (isEmpty)
+        log_warn("no data found");
+
+      clustersSize = static_cast<offset_type>(out.tellp()) - clustersPos();
+    }
+
+    void ZimCreator::addArticleData(const Article& article, Dirent& dirent, size_type seq)
+    {
+      if (dirent.isRedirect())
+        return;
+
+      if (clustersStart == 0)
+      {
+        // the mime type list is not known yet, so leave room for it
+        clustersStart = mimeListPos() + mimeListReserve;
+        zimfile->seekp(clustersStart);
+      }
+
+      Blob blob = article.getData();
+      addGeoPoint(blob, seq);
+      packBlob(dirent, blob);
+      dirent.setPacked();
+    }
+
+    void ZimCreator::addDirentData(ArticleSource& src, Dirent& dirent)
+    {
+      if (dirent.isRedirect() || dirent.isPacked())
+        return;
+
+      ArticleData data;
+      if (!src.takeData(dirent.getAid(), data))
+      {
+        Blob blob = src.getData(dirent.getAid());
+        addGeoPoint(blob, dirent.getIdx());
+        packBlob(dirent, blob);
+      }
+      else if (data.isFile())
+      {
+        FileRange file(data.getFilename(), data.getOffset(), data.getSize());
+        Blob blob(file.data(), file.size());
+        addGeoPoint(blob, dirent.getIdx());
+        packBlob(dirent, blob, &data);
+      }
+      else
+      {
+        Blob blob(data.getBuffer().data(), data.getBuffer().size());
+        addGeoPoint(blob, dirent.getIdx());
+        packBlob(dirent, blob);
+      }
+    }
+
+    void ZimCreator::packBlob(Dirent& dirent, const Blob& blob, const ArticleData* file)
+    {
+      if (blob.size() > 0)
+        isEmpty = false;
+
+      // empty blobs are not worth sharing
+      bool dedup = deduplicate && blob.size() > 0;
+      uint64_t hash = 0;
+      if (dedup)
+      {
+        hash = DedupTable::hash(blob.data(), blob.size());
+        for (size_type slot = dedupTable->first(hash, blob.size()); slot != DedupTable::npos;
+             slot = dedupTable->next(slot, hash, blob.size()))
         {
-          if (cluster.count() > 0)
+          const DedupTable::Entry& e = (*dedupTable)[slot];
+          if (isSameBlob(blob, e.cluster, e.blob))
           {
-            clusterOffsets.push_back(out.tellp());
-            cluster.setCompression(compression);
-            out << cluster;
-            cluster.clear();
-            cluster.setCompression(compression);
+            log_debug("blob of " << dirent.getLongUrl() << " shared with cluster " << e.cluster << " blob " << e.blob);
+            dirent.setCluster(e.cluster, e.blob);
+            ++countDuplicates;
+            return;
           }
+        }
+      }
 
-          di->setCluster(clusterOffsets.size(), cluster.count());
-          clusterOffsets.push_back(out.tellp());
-          Cluster c;
-          c.addBlob(blob);
-          c.setCompression(zimcompNone);
-          out << c;
+      if (file && !dirent.isCompress() && blob.size() >= minFileClusterSize)
+      {
+        // the cluster is copied from the file, when it is its turn
+        log_debug("file cluster for " << dirent.getLongUrl() << ", " << blob.size() << " bytes");
+        dirent.setCluster(clusterNumbers.size(), 0);
+        clusterNumbers.push_back(clusterWriter->count());
+        clusterWriter->addFile(file->getFilename(), file->getOffset(), file->getSize());
+        if (dedup)
+          dedupTable->insert(hash, blob.size(), dirent.getClusterNumber(), dirent.getBlobNumber());
+        return;
+      }
+
+      // every cluster group has its own clusters and blobs, which are not
+      // compressed, do not interrupt the compressed cluster of their group
+      ClusterKey key(dirent.getClusterGroup(), dirent.isCompress());
+      OpenClusters::iterator it = openClusters.find(key);
+      if (it == openClusters.end())
+      {
+        if (openClusters.size() >= maxOpenClusters)
+        {
+          OpenClusters::iterator lru = openClusters.begin();
+          for (OpenClusters::iterator o = openClusters.begin(); o != openClusters.end(); ++o)
+            if (o->second.lastUsed < lru->second.lastUsed)
+              lru = o;
+          log_debug("too many open clusters; write cluster " << lru->second.id << " of group " << lru->first.first);
+          addCluster(lru);
         }
+
+        it = openClusters.insert(OpenClusters::value_type(key, OpenCluster())).first;
+        it->second.id = clusterNumbers.size();
+        clusterNumbers.push_back(std::numeric_limits<size_type>::max());
+        it->second.cluster.setCompression(dirent.isCompress() ? compression : zimcompNone);
+        it->second.cluster.setBlockSize(blockSize * 1024);
       }
 
-      if (cluster.count() > 0)
+      Cluster& c = it->second.cluster;
+      it->second.lastUsed = countPacked++;
+      dirent.setCluster(it->second.id, c.count());
+      c.addBlob(blob);
+      if (c.size() >= minChunkSize * 1024)
       {
-        clusterOffsets.push_back(out.tellp());
-        cluster.setCompression(compression);
-        out << cluster;
+        log_info((dirent.isCompress() ? "compress" : "write") << " cluster with " << c.count() << " articles, " << c.size() << " bytes; current title \"" << dirent.getTitle() << '\"');
+        addCluster(it);
       }
 
-      if (!out)
-        throw std::runtime_error("failed to write temporary cluster file");
+      if (dedup)
+        dedupTable->insert(hash, blob.size(), dirent.getClusterNumber(), dirent.getBlobNumber());
+    }
+
+    void ZimCreator::addCluster(OpenClusters::iterator it)
+    {
+      clusterNumbers[it->second.id] = clusterWriter->count();
+      clusterWriter->add(it->second.cluster);
+      openClusters.erase(it);
+    }
+
+    void ZimCreator::setClusterNumber(Dirent& dirent) const
+    {
+      if (!dirent.isRedirect())
+        dirent.setCluster(clusterNumbers[dirent.getClusterNumber()], dirent.getBlobNumber());
+    }
+
+    bool ZimCreator::isSameBlob(const Blob& blob, size_type id, size_type blobNumber)
+    {
+      const Cluster* c = 0;
+      for (OpenClusters::const_iterator it = openClusters.begin(); c == 0 && it != openClusters.end(); ++it)
+        if (it->second.id == id)
+          c = &it->second.cluster;
+
+      if (c == 0)
+      {
+        size_type clusterNumber = clusterNumbers[id];
+        // the cluster is written or being compressed, so read it back
+        if (readClusterNumber != clusterNumber)
+        {
+          if (clusterNumber >= clusterOffsets.size())
+            clusterWriter->flush(clusterNumber + 1);
+          zimfile->flush();
+
+          // the blob of an uncompressed cluster is compared in the file
+          offset_type pos;
+          size_type size;
+          if (readBlobRange(clusterOffsets[clusterNumber], blobNumber, pos, size))
+            return size == blob.size() && isSameData(blob, pos);
+
+          log_debug("read back cluster " << clusterNumber);
+          Cluster r;
+          zimReader->clear();
+          zimReader->seekg(clusterOffsets[clusterNumber]);
+          *zimReader >> r;
+          if (!*zimReader)
+            throw std::runtime_error("failed to read back cluster");
+
+          *readCluster = r;
+          readClusterNumber = clusterNumber;
+        }
 
-      clustersSize = out.tellp();
+        c = readCluster;
+      }
+
+      return c->getBlobSize(blobNumber) == blob.size()
+          && std::equal(blob.data(), blob.end(), c->getBlobPtr(blobNumber));
+    }
+
+    bool ZimCreator::readBlobRange(offset_type clusterOffset, size_type blobNumber,
+                                   offset_type& pos, size_type& size)
+    {
+      zimReader->clear();
+      zimReader->seekg(clusterOffset);
+      char c;
+      zimReader->get(c);
+      if (!*zimReader)
+        throw std::runtime_error("failed to read back cluster");
+
+      CompressionType compression = static_cast<CompressionType>(c);
+      if (compression != zimcompDefault && compression != zimcompNone)
+        return false;
+
+      size_type offsets[2];
+      zimReader->seekg(clusterOffset + 1 + sizeof(size_type) * blobNumber);
+      zimReader->read(reinterpret_cast<char*>(offsets), sizeof(offsets));
+      if (!*zimReader)
+        throw std::runtime_error("failed to read back blob offsets");
+
+      offsets[0] = fromLittleEndian(&offsets[0]);
+      offsets[1] = fromLittleEndian(&offsets[1]);
+      if (offsets[1] < offsets[0])
+        throw std::runtime_error("invalid blob offsets read back");
+
+      pos = clusterOffset + 1 + offsets[0];
+      size = offsets[1] - offsets[0];
+      return true;
+    }
+
+    bool ZimCreator::isSameData(const Blob& blob, offset_type pos)
+    {
+      zimReader->seekg(pos);
+      char buffer[16384];
+      for (size_type n = 0; n < blob.size(); )
+      {
+        size_type count = std::min(static_cast<size_type>(sizeof(buffer)), blob.size() - n);
+        zimReader->read(buffer, count);
+        if (!*zimReader)
+          throw std::runtime_error("failed to read back blob");
+        if (!std::equal(buffer, buffer + count, blob.data() + n))
+          return false;
+        n += count;
+      }
+      return true;
     }
 
     void ZimCreator::addGeoPoint(const Blob& blob, size_t index)
@@ -393,7 +1197,9 @@ namespace zim
       // If we have less than 10 points or all remaining points are equal
       if (end < begin + 10 || end == std::adjacent_find(begin, end, std::not_equal_to<ArticleGeoPoint>()))
       {
+        // a leaf starts with a zero median value followed by the point count
         toLittleEndian(uint32_t(0), data);
+        geoIndex.write(data, 4);
         if (end <= begin)
           toLittleEndian(uint32_t(0), data);
         else
@@ -484,34 +1290,38 @@ namespace zim
 
     void ZimCreator::fillHeader(ArticleSource& src)
     {
-      std::string mainAid = src.getMainPage();
-      std::string layoutAid = src.getLayoutPage();
+      // with temporary files the main and layout page are set in createClusters
+      std::string mainAid = maxDirentMemory > 0 ? std::string() : src.getMainPage();
+      std::string layoutAid = maxDirentMemory > 0 ? std::string() : src.getLayoutPage();
 
       log_debug("main aid=" << mainAid << " layout aid=" << layoutAid);
 
-      header.setMainPage(std::numeric_limits<size_type>::max());
-      header.setLayoutPage(std::numeric_limits<size_type>::max());
+      if (maxDirentMemory == 0)
+      {
+        header.setMainPage(std::numeric_limits<size_type>::max());
+        header.setLayoutPage(std::numeric_limits<size_type>::max());
+      }
 
       if (!mainAid.empty() || !layoutAid.empty())
       {
-        for (DirentsType::const_iterator di = dirents.begin(); di != dirents.end(); ++di)
+        for (DirentsType::size_type n = 0; n < dirents.size(); ++n)
         {
-          if (mainAid == di->getAid())
+          if (dirents.isAid(n, mainAid))
           {
-            log_debug("main idx=" << di->getIdx());
-            header.setMainPage(di->getIdx());
+            log_debug("main idx=" << dirents.getIdx(n));
+            header.setMainPage(dirents.getIdx(n));
           }
 
-          if (layoutAid == di->getAid())
+          if (dirents.isAid(n, layoutAid))
           {
-            log_debug("layout idx=" << di->getIdx());
-            header.setLayoutPage(di->getIdx());
+            log_debug("layout idx=" << dirents.getIdx(n));
+            header.setLayoutPage(dirents.getIdx(n));
           }
         }
       }
 
       header.setUuid( src.getUuid() );
-      header.setArticleCount( dirents.size() );
+      header.setArticleCount( articleCount() );
       header.setUrlPtrPos( urlPtrPos() );
       header.setMimeListPos( mimeListPos() );
       header.setTitleIdxPos( titleIdxPos() );
@@ -533,7 +1343,6 @@ namespace zim
            " clusterPtrPos=" << clusterPtrPos() <<
            " clusterCount=" << clusterCount() <<
            " articleCount=" << articleCount() <<
-           " articleCount=" << dirents.size() <<
            " urlPtrPos=" << header.getUrlPtrPos() <<
            " titleIdxPos=" << header.getTitleIdxPos() <<
            " clusterCount=" << header.getClusterCount() <<
@@ -542,20 +1351,11 @@ namespace zim
            );
     }
 
-    void ZimCreator::write(const std::string& fname, const std::string& tmpfname)
+    void ZimCreator::writeMimeTypes(std::ostream& out)
     {
-      std::ofstream zimfile(fname.c_str());
-      Md5stream md5;
-      Tee out(zimfile, md5);
-
-      out << header;
-
-      log_debug("after writing header - pos=" << zimfile.tellp());
-
-      // write mime type list
+      // the mime types are written sorted, so the dirents get new indexes
       std::vector<std::string> oldMImeList;
       std::vector<std::string> newMImeList;
-      std::vector<uint16_t> mapping;
 
       for (RMimeTypes::const_iterator it = rmimeTypes.begin(); it != rmimeTypes.end(); ++it)
       {
@@ -563,7 +1363,7 @@ namespace zim
         newMImeList.push_back(it->second);
       }
 
-      mapping.resize(oldMImeList.size());
+      mimeMapping.resize(oldMImeList.size());
       std::sort(newMImeList.begin(), newMImeList.end());
 
       for (unsigned i=0; i<oldMImeList.size(); ++i)
@@ -571,14 +1371,14 @@ namespace zim
         for (unsigned j=0; j<newMImeList.size(); ++j)
         {
           if (oldMImeList[i] == newMImeList[j])
-            mapping[i] = static_cast<uint16_t>(j);
+            mimeMapping[i] = static_cast<uint16_t>(j);
         }
       }
 
       for (unsigned i=0; i<dirents.size(); ++i)
       {
-        if (dirents[i].isArticle())
-          dirents[i].setMimeType(mapping[dirents[i].getMimeType()]);
+        if (dirents.isArticle(i))
+          dirents.setMimeType(i, mimeMapping[dirents.getMimeType(i)]);
       }
 
       for (unsigned i=0; i<newMImeList.size(); ++i)
@@ -588,14 +1388,36 @@ namespace zim
 
       out << '\0';
 
+      log_debug("after writing mime type list - pos=" << out.tellp());
+    }
+
+    void ZimCreator::write(std::ostream& out)
+    {
+      out.seekp(urlPtrPos());
+
       // write url ptr list
 
       offset_type off = indexPos();
-      for (DirentsType::const_iterator it = dirents.begin(); it != dirents.end(); ++it)
+      if (maxDirentMemory == 0)
       {
-        offset_type ptr0 = fromLittleEndian<offset_type>(&off);
-        out.write(reinterpret_cast<const char*>(&ptr0), sizeof(ptr0));
-        off += it->getDirentSize();
+        for (DirentsType::size_type n = 0; n < dirents.size(); ++n)
+        {
+          offset_type ptr0 = fromLittleEndian<offset_type>(&off);
+          out.write(reinterpret_cast<const char*>(&ptr0), sizeof(ptr0));
+          off += dirents.getDirentSize(n);
+        }
+      }
+      else
+      {
+        std::ifstream in(clusteredTmpName().c_str(), std::ios::in | std::ios::binary);
+        std::string data;
+        size_type seq;
+        while (readRecord(in, data))
+        {
+          offset_type ptr0 = fromLittleEndian<offset_type>(&off);
+          out.write(reinterpret_cast<const char*>(&ptr0), sizeof(ptr0));
+          off += deserializeDirent(data, seq).getDirentSize();
+        }
       }
 
       log_debug("after writing direntPtr - pos=" << out.tellp());
@@ -612,49 +1434,75 @@ namespace zim
 
       // write geo index
 
-      out << geoIndex;
+      out << geoIndex.str();
 
       log_debug("after writing geoIdx - pos=" << out.tellp());
 
       // write directory entries
 
-      for (DirentsType::const_iterator it = dirents.begin(); it != dirents.end(); ++it)
+      if (maxDirentMemory == 0)
       {
-        out << *it;
-        log_debug("write " << it->getTitle() << " dirent.size()=" << it->getDirentSize() << " pos=" << out.tellp());
+        for (DirentsType::size_type n = 0; n < dirents.size(); ++n)
+        {
+          Dirent dirent = dirents.get(n);
+          out << dirent;
+          log_debug("write " << dirent.getTitle() << " dirent.size()=" << dirent.getDirentSize() << " pos=" << out.tellp());
+        }
+      }
+      else
+      {
+        std::ifstream in(clusteredTmpName().c_str(), std::ios::in | std::ios::binary);
+        std::string data;
+        size_type seq;
+        while (readRecord(in, data))
+        {
+          Dirent dirent = deserializeDirent(data, seq);
+          setClusterNumber(dirent);
+          out << dirent;
+        }
       }
 
       log_debug("after writing dirents - pos=" << out.tellp());
 
       // write cluster offset list
 
-      off += clusterOffsets.size() * sizeof(offset_type);
       for (OffsetsType::const_iterator it = clusterOffsets.begin(); it != clusterOffsets.end(); ++it)
       {
-        offset_type o = (off + *it);
-        offset_type ptr0 = fromLittleEndian<offset_type>(&o);
+        offset_type ptr0 = fromLittleEndian<offset_type>(&*it);
         out.write(reinterpret_cast<const char*>(&ptr0), sizeof(ptr0));
       }
 
       log_debug("after writing clusterOffsets - pos=" << out.tellp());
 
-      // write cluster data
+      // write header
 
-      if (!isEmpty)
-      {
-        std::ifstream blobsfile(tmpfname.c_str());
-        out << blobsfile.rdbuf();
-      }
-      else
-        log_warn("no data found");
+      out.seekp(0);
+      out << header;
 
       if (!out)
         throw std::runtime_error("failed to write zimfile");
+    }
+
+    void ZimCreator::writeChecksum(std::ostream& zimfile, const std::string& zimfname)
+    {
+      // The header precedes everything else, so the checksum can only be
+      // calculated, when the file is complete. Reading it once is still
+      // cheaper than copying the clusters from a temporary file.
+      zimfile.flush();
+      if (!zimfile)
+        throw std::runtime_error("failed to write zimfile");
+
+      streambuf::PartsType parts;
+      parts.push_back(streambuf::PartsType::value_type(zimfname, checksumPos()));
 
-      log_debug("after writing clusterData - pos=" << out.tellp());
       unsigned char digest[16];
-      md5.getDigest(digest);
+      md5File(parts, checksumPos(), digest);
+      zimfile.seekp(checksumPos());
       zimfile.write(reinterpret_cast<const char*>(digest), 16);
+      zimfile.flush();
+
+      if (!zimfile)
+        throw std::runtime_error("failed to write checksum");
     }
 
     offset_type ZimCreator::mimeListSize() const
@@ -667,10 +1515,13 @@ namespace zim
 
     offset_type ZimCreator::indexSize() const
     {
+      if (maxDirentMemory > 0)
+        return direntsSize;
+
       offset_type s = 0;
 
-      for (DirentsType::const_iterator it = dirents.begin(); it != dirents.end(); ++it)
-        s += it->getDirentSize();
+      for (DirentsType::size_type n = 0; n < dirents.size(); ++n)
+        s += dirents.getDirentSize(n);
 
       return s;
     }
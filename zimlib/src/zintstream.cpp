@@ -19,8 +19,16 @@
 
 #include <zim/zintstream.h>
 #include <stdint.h>
+#include <stdexcept>
+#include <cstddef>
 #include "log.h"
 
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__)) \
+  && (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9) || defined(__clang__))
+#define ZIM_ZINT_SSE 1
+#include <smmintrin.h>
+#endif
+
 log_define("zim.zintstream")
 
 namespace zim
@@ -101,4 +109,240 @@ namespace zim
     return *this;
   }
 
+  char* encodeZInt(char* out, size_type value)
+  {
+    size_type nmask = 0;
+    size_type mask = 0x7F;
+    uint64_t ubound = 0x80;
+    unsigned short N = 0;
+
+    while (value >= ubound)
+    {
+      value -= ubound;
+      ubound <<= 7;
+      nmask = (nmask >> 1) | 0x80;
+      mask = mask >> 1;
+      ++N;
+    }
+
+    *out++ = static_cast<char>(nmask | (value & mask));
+    value >>= 7 - N;
+    while (N--)
+    {
+      *out++ = static_cast<char>(value & 0xFF);
+      value >>= 8;
+    }
+
+    return out;
+  }
+
+  unsigned zintSize(size_type value)
+  {
+    return value < 0x80 ? 1
+         : value < 0x4080 ? 2
+         : value < 0x204080 ? 3
+         : value < 0x10204080 ? 4
+         : 5;
+  }
+
+  namespace
+  {
+    // Lookup tables for the bulk decoder.
+    //
+    // The number of additional bytes of a zint is given by the number of
+    // leading 1 bits of the first byte. For groups of 4 values with up to 3
+    // additional bytes each, the 4 lengths (2 bits each) build a key into
+    // a table of shuffle masks, which move the bytes of each value into
+    // its own 32 bit lane. The lanes are then fixed up with per lane masks,
+    // multipliers (for the variable shift) and offsets.
+    struct ZIntTables
+    {
+      unsigned char extra[256];   // additional bytes; 8 means invalid
+      uint32_t add[8];            // value offset by additional bytes
+      uint32_t mask[8];           // data bits in first byte
+
+      struct Group
+      {
+        unsigned char shuffle[16];
+        uint32_t mask[4];
+        uint32_t mult[4];
+        uint32_t add[4];
+        unsigned consumed;
+      } groups[256];
+
+      ZIntTables();
+    };
+
+    ZIntTables::ZIntTables()
+    {
+      for (unsigned ch = 0; ch < 256; ++ch)
+      {
+        unsigned n = 0;
+        while (n < 8 && (ch & (0x80 >> n)))
+          ++n;
+        extra[ch] = static_cast<unsigned char>(n);
+      }
+
+      uint64_t a = 0;
+      uint64_t ubound = 0x80;
+      for (unsigned n = 0; n < 8; ++n)
+      {
+        add[n] = static_cast<uint32_t>(a);
+        mask[n] = 0x7F >> n;
+        a += ubound;
+        ubound <<= 7;
+      }
+
+      for (unsigned key = 0; key < 256; ++key)
+      {
+        Group& g = groups[key];
+        unsigned offset = 0;
+        for (unsigned lane = 0; lane < 4; ++lane)
+        {
+          unsigned n = (key >> (lane * 2)) & 3;
+          for (unsigned b = 0; b < 4; ++b)
+            g.shuffle[lane * 4 + b] = b <= n ? static_cast<unsigned char>(offset + b) : 0x80;
+          g.mask[lane] = mask[n];
+          g.mult[lane] = 1u << (7 - n);
+          g.add[lane] = add[n];
+          offset += n + 1;
+        }
+        g.consumed = offset;
+      }
+    }
+
+    const ZIntTables zintTables;
+
+    inline const char* decodeOne(const char* p, const char* end, size_type& value)
+    {
+      const unsigned char* u = reinterpret_cast<const unsigned char*>(p);
+      unsigned n = zintTables.extra[u[0]];
+      if (n >= 8)
+        throw std::runtime_error("invalid bytestream in int decompressor");
+      if (end - p <= static_cast<std::ptrdiff_t>(n))
+        throw std::runtime_error("incomplete bytestream in int decompressor");
+
+      switch (n)
+      {
+        case 0:
+          value = u[0];
+          break;
+
+        case 1:
+          value = ((u[0] & 0x3F) | (u[1] << 6)) + 0x80;
+          break;
+
+        case 2:
+          value = ((u[0] & 0x1F) | (u[1] << 5) | (u[2] << 13)) + 0x4080;
+          break;
+
+        default:
+        {
+          // same arithmetic as ZIntStream::get, including truncation
+          // of values, which do not fit into size_type
+          size_type v = u[0] & zintTables.mask[n];
+          unsigned s = 7 - n;
+          for (unsigned b = 1; b <= n; ++b, s += 8)
+            v |= static_cast<size_type>(u[b]) << s;
+          value = v + zintTables.add[n];
+        }
+      }
+
+      return p + n + 1;
+    }
+
+#ifdef ZIM_ZINT_SSE
+    // Decodes groups of 4 values as long as at least 16 bytes of input
+    // and room for maxCount values are left. Stops at the first group with
+    // a value longer than 4 bytes and leaves it to the scalar decoder.
+    __attribute__((target("sse4.1")))
+    const char* decodeGroupsSse(const char* p, const char* end, size_type*& out, size_type maxCount)
+    {
+      const unsigned char* u = reinterpret_cast<const unsigned char*>(p);
+      const unsigned char* e = reinterpret_cast<const unsigned char*>(end);
+      size_type* outEnd = out + maxCount;
+
+      while (e - u >= 16 && outEnd - out >= 4)
+      {
+        unsigned n0 = zintTables.extra[u[0]];
+        if (n0 > 3)
+          break;
+        unsigned n1 = zintTables.extra[u[n0 + 1]];
+        if (n1 > 3)
+          break;
+        unsigned o2 = n0 + n1 + 2;
+        unsigned n2 = zintTables.extra[u[o2]];
+        if (n2 > 3)
+          break;
+        unsigned n3 = zintTables.extra[u[o2 + n2 + 1]];
+        if (n3 > 3)
+          break;
+
+        const ZIntTables::Group& g = zintTables.groups[n0 | (n1 << 2) | (n2 << 4) | (n3 << 6)];
+
+        __m128i in = _mm_loadu_si128(reinterpret_cast<const __m128i*>(u));
+        __m128i lanes = _mm_shuffle_epi8(in,
+          _mm_loadu_si128(reinterpret_cast<const __m128i*>(g.shuffle)));
+        __m128i lo = _mm_and_si128(lanes,
+          _mm_loadu_si128(reinterpret_cast<const __m128i*>(g.mask)));
+        __m128i hi = _mm_mullo_epi32(_mm_srli_epi32(lanes, 8),
+          _mm_loadu_si128(reinterpret_cast<const __m128i*>(g.mult)));
+        __m128i v = _mm_add_epi32(_mm_or_si128(lo, hi),
+          _mm_loadu_si128(reinterpret_cast<const __m128i*>(g.add)));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out), v);
+
+        out += 4;
+        u += g.consumed;
+      }
+
+      return reinterpret_cast<const char*>(u);
+    }
+
+    bool haveSse41()
+    {
+      __builtin_cpu_init();
+      return __builtin_cpu_supports("sse4.1");
+    }
+
+    const bool useSse = haveSse41();
+#endif
+
+    const char* decodeZIntsImpl(const char* begin, const char* end, size_type*& out, size_type maxCount)
+    {
+      size_type* outEnd = out + maxCount;
+      const char* p = begin;
+
+      while (p < end && out < outEnd)
+      {
+#ifdef ZIM_ZINT_SSE
+        if (useSse)
+        {
+          p = decodeGroupsSse(p, end, out, outEnd - out);
+          if (p >= end || out >= outEnd)
+            break;
+        }
+#endif
+        p = decodeOne(p, end, *out++);
+      }
+
+      return p;
+    }
+  }
+
+  size_type decodeZInts(const char* begin, const char* end, size_type* out)
+  {
+    size_type* o = out;
+    decodeZIntsImpl(begin, end, o, static_cast<size_type>(end - begin));
+    return static_cast<size_type>(o - out);
+  }
+
+  const char* decodeZInts(const char* begin, const char* end, size_type* out, size_type count)
+  {
+    size_type* o = out;
+    const char* p = decodeZIntsImpl(begin, end, o, count);
+    if (static_cast<size_type>(o - out) < count)
+      throw std::runtime_error("incomplete bytestream in int decompressor");
+    return p;
+  }
+
 }
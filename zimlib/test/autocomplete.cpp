@@ -0,0 +1,117 @@
+/*
+ * Copyright (C) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * is provided AS IS, WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, and
+ * NON-INFRINGEMENT.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ */
+#include <cxxtools/unit/testsuite.h>
+#include <cxxtools/unit/registertest.h>
+#include "zim/autocomplete.h"
+#include <algorithm>
+#include <sstream>
+#include <vector>
+
+class AutocompleteTest : public cxxtools::unit::TestSuite
+{
+    struct Title
+    {
+      std::string title;
+      zim::size_type idx;
+      zim::size_type score;
+    };
+
+    std::vector<Title> titles;
+    zim::Autocomplete autocomplete;
+
+    // ranks all titles starting with prefix like Autocomplete does
+    std::vector<zim::size_type> expected(const std::string& prefix, unsigned limit)
+    {
+      std::vector<std::pair<std::pair<zim::size_type, zim::size_type>, zim::size_type> > ranks;
+      for (unsigned n = 0; n < titles.size(); ++n)
+        if (titles[n].title.compare(0, prefix.size(), prefix) == 0)
+          ranks.push_back(std::make_pair(
+            std::make_pair(~titles[n].score, titles[n].title.size()), titles[n].idx));
+
+      std::sort(ranks.begin(), ranks.end());
+
+      std::vector<zim::size_type> result;
+      for (unsigned n = 0; n < ranks.size() && n < limit; ++n)
+        result.push_back(ranks[n].second);
+      return result;
+    }
+
+    void check(const std::string& prefix, unsigned limit)
+    {
+      zim::Autocomplete::Results results;
+      CXXTOOLS_UNIT_ASSERT(autocomplete.find(prefix, results, limit));
+
+      std::vector<zim::size_type> e = expected(prefix, std::min(limit, autocomplete.getK()));
+      CXXTOOLS_UNIT_ASSERT_EQUALS(results.size(), e.size());
+      for (unsigned n = 0; n < e.size(); ++n)
+        CXXTOOLS_UNIT_ASSERT_EQUALS(results[n], e[n]);
+    }
+
+  public:
+    AutocompleteTest()
+      : cxxtools::unit::TestSuite("zim::AutocompleteTest"),
+        autocomplete(5, 3)
+    {
+      registerMethod("find", *this, &AutocompleteTest::find);
+      registerMethod("notCovered", *this, &AutocompleteTest::notCovered);
+
+      const char* words[] = { "Berlin", "Bern", "Bremen", "Hamburg", "Hamm", "H", "of", "the" };
+      const unsigned numWords = sizeof(words) / sizeof(words[0]);
+      for (unsigned n = 0; n < 500; ++n)
+      {
+        std::ostringstream s;
+        s << words[n % numWords];
+        if (n >= numWords)
+          s << ' ' << words[(n / numWords) % numWords] << ' ' << n;
+        Title t;
+        t.title = s.str();
+        t.idx = n * 2;
+        t.score = (n * 7919) % 13;
+        titles.push_back(t);
+      }
+
+      for (unsigned n = 0; n < titles.size(); ++n)
+        autocomplete.add(titles[n].title, titles[n].idx, titles[n].score);
+      autocomplete.build();
+    }
+
+    void find()
+    {
+      check("B", 5);
+      check("Be", 5);
+      check("Ber", 5);
+      check("Ber", 2);
+      check("Ham", 5);
+      check("H", 5);
+      check("o", 10);
+      check("x", 5);
+      check("Bx", 5);
+    }
+
+    void notCovered()
+    {
+      zim::Autocomplete::Results results;
+      CXXTOOLS_UNIT_ASSERT(!autocomplete.find("", results));
+      CXXTOOLS_UNIT_ASSERT(!autocomplete.find("Berl", results));
+      CXXTOOLS_UNIT_ASSERT(results.empty());
+    }
+
+};
+
+cxxtools::unit::RegisterTest<AutocompleteTest> register_AutocompleteTest;
@@ -26,6 +26,7 @@
 #include <cxxtools/unit/registertest.h>
 
 #include "config.h"
+#include "clusterblocks.h"
 
 class ClusterTest : public cxxtools::unit::TestSuite
 {
@@ -36,6 +37,7 @@ class ClusterTest : public cxxtools::unit::TestSuite
       registerMethod("CreateCluster", *this, &ClusterTest::CreateCluster);
       registerMethod("ReadWriteCluster", *this, &ClusterTest::ReadWriteCluster);
       registerMethod("ReadWriteEmpty", *this, &ClusterTest::ReadWriteEmpty);
+      registerMethod("ReadBlob", *this, &ClusterTest::ReadBlob);
 #ifdef ENABLE_ZLIB
       registerMethod("ReadWriteClusterZ", *this, &ClusterTest::ReadWriteClusterZ);
 #endif
@@ -44,6 +46,8 @@ class ClusterTest : public cxxtools::unit::TestSuite
 #endif
 #ifdef ENABLE_LZMA
       registerMethod("ReadWriteClusterLzma", *this, &ClusterTest::ReadWriteClusterLzma);
+      registerMethod("ReadWriteBlocks", *this, &ClusterTest::ReadWriteBlocks);
+      registerMethod("DecompressBlock", *this, &ClusterTest::DecompressBlock);
 #endif
     }
 
@@ -113,6 +117,31 @@ class ClusterTest : public cxxtools::unit::TestSuite
       CXXTOOLS_UNIT_ASSERT_EQUALS(cluster2.getBlobSize(2), 0);
     }
 
+    void ReadBlob()
+    {
+      std::stringstream s;
+
+      zim::Cluster cluster;
+
+      std::string blob0("123456789012345678901234567890");
+      std::string blob1("ABCDEFGHIJKLMNOPQRSTUVWXYZ");
+
+      cluster.addBlob(blob0.data(), blob0.size());
+      cluster.addBlob(blob1.data(), blob1.size());
+
+      s << cluster;
+
+      // skip compression byte and 3 offsets to get to blob1
+      s.seekg(1 + 3 * sizeof(zim::size_type) + blob0.size());
+
+      zim::Cluster cluster2;
+      cluster2.readBlob(s, blob1.size());
+      CXXTOOLS_UNIT_ASSERT(!s.fail());
+      CXXTOOLS_UNIT_ASSERT_EQUALS(cluster2.count(), 1);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(cluster2.getBlobSize(0), blob1.size());
+      CXXTOOLS_UNIT_ASSERT(std::equal(cluster2.getBlobPtr(0), cluster2.getBlobPtr(0) + blob1.size(), blob1.data()));
+    }
+
 #ifdef ENABLE_ZLIB
     void ReadWriteClusterZ()
     {
@@ -210,6 +239,72 @@ class ClusterTest : public cxxtools::unit::TestSuite
       CXXTOOLS_UNIT_ASSERT(std::equal(cluster2.getBlobPtr(2), cluster2.getBlobPtr(2) + cluster2.getBlobSize(2), blob2.data()));
     }
 
+    void ReadWriteBlocks()
+    {
+      std::stringstream s;
+
+      zim::Cluster cluster;
+
+      std::string blob0("123456789012345678901234567890");
+      std::string blob1("ABCDEFGHIJKLMNOPQRSTUVWXYZ");
+      std::string blob2("abcdefghijklmnopqrstuvwxyz");
+
+      cluster.addBlob(blob0.data(), blob0.size());
+      cluster.addBlob(blob1.data(), blob1.size());
+      cluster.addBlob(blob2.data(), blob2.size());
+      cluster.setCompression(zim::zimcompLzma);
+      cluster.setBlockSize(16);
+
+      s << cluster;
+      CXXTOOLS_UNIT_ASSERT_EQUALS(s.str()[0], zim::zimcompLzma | zim::zimcompBlocks);
+
+      zim::Cluster cluster2;
+      s >> cluster2;
+      CXXTOOLS_UNIT_ASSERT(!s.fail());
+      CXXTOOLS_UNIT_ASSERT_EQUALS(cluster2.count(), 3);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(cluster2.getCompression(), zim::zimcompLzma);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(cluster2.getBlockSize(), 16);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(cluster2.getBlobSize(0), blob0.size());
+      CXXTOOLS_UNIT_ASSERT_EQUALS(cluster2.getBlobSize(1), blob1.size());
+      CXXTOOLS_UNIT_ASSERT_EQUALS(cluster2.getBlobSize(2), blob2.size());
+      CXXTOOLS_UNIT_ASSERT(std::equal(cluster2.getBlobPtr(0), cluster2.getBlobPtr(0) + cluster2.getBlobSize(0), blob0.data()));
+      CXXTOOLS_UNIT_ASSERT(std::equal(cluster2.getBlobPtr(1), cluster2.getBlobPtr(1) + cluster2.getBlobSize(1), blob1.data()));
+      CXXTOOLS_UNIT_ASSERT(std::equal(cluster2.getBlobPtr(2), cluster2.getBlobPtr(2) + cluster2.getBlobSize(2), blob2.data()));
+    }
+
+    void DecompressBlock()
+    {
+      std::stringstream s;
+
+      zim::Cluster cluster;
+
+      std::string blob0("123456789012345678901234567890");
+      std::string blob1("ABCDEFGHIJKLMNOPQRSTUVWXYZ");
+
+      cluster.addBlob(blob0.data(), blob0.size());
+      cluster.addBlob(blob1.data(), blob1.size());
+      cluster.setCompression(zim::zimcompLzma);
+      cluster.setBlockSize(16);
+
+      s << cluster;
+
+      // 3 offsets and 56 bytes of data make 5 blocks, the last with 4 bytes
+      s.seekg(1);
+      zim::ClusterBlocks blocks;
+      blocks.readIndex(s, zim::zimcompLzma);
+      CXXTOOLS_UNIT_ASSERT(!s.fail());
+      CXXTOOLS_UNIT_ASSERT_EQUALS(blocks.getCount(), 5);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(blocks.getSize(), 68);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(blocks.getUncompressedSize(4), 4);
+
+      // block 2 holds the last 10 bytes of blob0 and the first 6 of blob1
+      std::string data = s.str().substr(1 + blocks.getIndexSize() + blocks.getBlockBegin(2),
+                                        blocks.getBlockEnd(2) - blocks.getBlockBegin(2));
+      char out[16];
+      blocks.decompress(2, data.data(), out);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(std::string(out, 16), blob0.substr(20) + blob1.substr(0, 6));
+    }
+
 #endif
 
 };
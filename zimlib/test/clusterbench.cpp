@@ -0,0 +1,273 @@
+/*
+ * Copyright (C) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * is provided AS IS, WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, and
+ * NON-INFRINGEMENT.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ */
+
+// Benchmark comparing the cluster strategies of zim::writer::ZimCreator.
+// A synthetic site of html pages with a style sheet, a script and a text
+// summary each is written once per strategy. For each file the size, the
+// compression ratio and the time to read html pages in random and in title
+// order are reported.
+//
+// usage: clusterbench [zimcreator-options] [number-of-pages [random-reads]]
+
+#include <zim/writer/zimcreator.h>
+#include <zim/file.h>
+#include <zim/article.h>
+#include <zim/blob.h>
+#include <iostream>
+#include <sstream>
+#include <vector>
+#include <cstdio>
+#include <cstdlib>
+#include <sys/time.h>
+
+namespace
+{
+  double now()
+  {
+    struct timeval tv;
+    gettimeofday(&tv, 0);
+    return tv.tv_sec + tv.tv_usec / 1e6;
+  }
+
+  const char* words[] = {
+    "zim", "cluster", "article", "compression", "archive", "offline", "reader",
+    "wikipedia", "content", "title", "index", "search", "namespace", "mime",
+    "type", "blob", "data", "file", "header", "pointer", "url", "redirect",
+    "category", "section", "history", "language", "country", "river", "city",
+    "mountain", "people", "science", "music", "the", "of", "and", "in", "a",
+    "is", "was", "for", "on", "with", "by", "from", "at", "which", "also"
+  };
+  const unsigned countWords = sizeof(words) / sizeof(words[0]);
+
+  std::string sentence(unsigned n)
+  {
+    std::string s;
+    for (unsigned i = 0; i < n; ++i)
+    {
+      if (i > 0)
+        s += ' ';
+      s += words[std::rand() % countWords];
+    }
+    return s;
+  }
+
+  class BenchArticle : public zim::writer::Article
+  {
+    public:
+      std::string aid;
+      std::string url;
+      std::string title;
+      std::string mimeType;
+      std::string section;
+      std::string data;
+
+      virtual std::string getAid() const        { return aid; }
+      virtual char getNamespace() const         { return 'A'; }
+      virtual std::string getUrl() const        { return url; }
+      virtual std::string getTitle() const      { return title; }
+      virtual std::string getMimeType() const   { return mimeType; }
+      virtual std::string getClusterHint() const  { return section; }
+  };
+
+  class BenchSource : public zim::writer::ArticleSource
+  {
+      std::vector<BenchArticle> articles;
+      unsigned next;
+
+      void add(const std::string& url, const std::string& title,
+               const std::string& mimeType, const std::string& section,
+               const std::string& data);
+
+    public:
+      explicit BenchSource(unsigned pages);
+
+      void rewind()   { next = 0; }
+      zim::offset_type getDataSize() const;
+
+      virtual const zim::writer::Article* getNextArticle();
+      virtual zim::Blob getData(const std::string& aid);
+  };
+
+  void BenchSource::add(const std::string& url, const std::string& title,
+                        const std::string& mimeType, const std::string& section,
+                        const std::string& data)
+  {
+    std::ostringstream aid;
+    aid << articles.size();
+    articles.push_back(BenchArticle());
+    BenchArticle& a = articles.back();
+    a.aid = aid.str();
+    a.url = url;
+    a.title = title;
+    a.mimeType = mimeType;
+    a.section = section;
+    a.data = data;
+  }
+
+  BenchSource::BenchSource(unsigned pages)
+    : next(0)
+  {
+    std::srand(1);
+    for (unsigned p = 0; p < pages; ++p)
+    {
+      std::ostringstream base, section, title;
+      base << "page" << p;
+      section << "section" << p % 8;
+      title << sentence(2) << ' ' << p;
+
+      std::ostringstream html;
+      html << "<html><head><title>" << title.str() << "</title>"
+              "<link rel=\"stylesheet\" href=\"" << base.str() << "/style.css\">"
+              "<script src=\"" << base.str() << "/script.js\"></script></head><body><h1>"
+           << title.str() << "</h1>\n";
+      for (unsigned n = 0; n < 5 + std::rand() % 10; ++n)
+        html << "<p>" << sentence(20 + std::rand() % 40) << "</p>\n";
+      html << "</body></html>\n";
+
+      std::ostringstream css;
+      for (unsigned n = 0; n < 10; ++n)
+        css << '.' << words[std::rand() % countWords] << n << " { margin: " << std::rand() % 20
+            << "px; color: #" << std::rand() % 0x1000 << "; font-size: " << 10 + std::rand() % 8 << "pt; }\n";
+
+      std::ostringstream js;
+      for (unsigned n = 0; n < 10; ++n)
+        js << "function " << words[std::rand() % countWords] << n << "(e) { var x = e."
+           << words[std::rand() % countWords] << " + " << std::rand() % 100
+           << "; return document.getElementById('" << words[std::rand() % countWords] << "'); }\n";
+
+      add(base.str(), title.str(), "text/html", section.str(), html.str());
+      add(base.str() + "/script.js", title.str() + " script", "application/javascript", section.str(), js.str());
+      add(base.str() + "/style.css", title.str() + " style", "text/css", section.str(), css.str());
+      add(base.str() + "/summary.txt", title.str() + " summary", "text/plain", section.str(), sentence(30) + '\n');
+    }
+  }
+
+  zim::offset_type BenchSource::getDataSize() const
+  {
+    zim::offset_type size = 0;
+    for (std::vector<BenchArticle>::const_iterator it = articles.begin(); it != articles.end(); ++it)
+      size += it->data.size();
+    return size;
+  }
+
+  const zim::writer::Article* BenchSource::getNextArticle()
+  {
+    return next < articles.size() ? &articles[next++] : 0;
+  }
+
+  zim::Blob BenchSource::getData(const std::string& aid)
+  {
+    const std::string& data = articles[std::atoi(aid.c_str())].data;
+    return zim::Blob(data.data(), data.size());
+  }
+
+  // returns the time in microseconds per read html page
+  double readPages(zim::File& file, const std::vector<zim::size_type>& pages)
+  {
+    zim::size_type sum = 0;
+    double t0 = now();
+    for (std::vector<zim::size_type>::const_iterator it = pages.begin(); it != pages.end(); ++it)
+      sum += file.getArticle(*it).getData().size();
+    double t1 = now();
+    if (sum == 0)
+      std::cerr << "no data read" << std::endl;
+    return (t1 - t0) * 1e6 / pages.size();
+  }
+}
+
+int main(int argc, char* argv[])
+{
+  try
+  {
+    // every strategy gets a writer of its own with the same options
+    std::vector<char*> args(argv, argv + argc + 1);
+    zim::writer::ZimCreator options(argc, argv);
+    unsigned pages = argc > 1 ? std::atoi(argv[1]) : 5000;
+    unsigned reads = argc > 2 ? std::atoi(argv[2]) : 2000;
+
+    BenchSource src(pages);
+    zim::offset_type dataSize = src.getDataSize();
+
+    struct
+    {
+      const char* name;
+      zim::writer::ZimCreator::ClusterStrategy strategy;
+    } strategies[] = {
+      { "url",   zim::writer::ZimCreator::clusterByUrl },
+      { "mime",  zim::writer::ZimCreator::clusterByMimeType },
+      { "hint",  zim::writer::ZimCreator::clusterByHint },
+      { "title", zim::writer::ZimCreator::clusterByTitle }
+    };
+
+    std::cout << pages * 4 << " articles, " << dataSize << " bytes, " << reads << " random reads\n"
+                 "strategy   clusters  file size   ratio  random us/page  title order us/page" << std::endl;
+
+    for (unsigned s = 0; s < sizeof(strategies) / sizeof(strategies[0]); ++s)
+    {
+      // the writer reports its progress on std::cout
+      std::vector<char*> a(args);
+      int c = a.size() - 1;
+      zim::writer::ZimCreator creator(c, &a[0]);
+      creator.setClusterStrategy(strategies[s].strategy);
+
+      std::ostringstream progress;
+      std::streambuf* sbuf = std::cout.rdbuf(progress.rdbuf());
+      src.rewind();
+      creator.create("clusterbench.zim", src);
+      std::cout.rdbuf(sbuf);
+
+      zim::File file("clusterbench.zim");
+
+      // html pages in title order and a random selection of them
+      std::vector<zim::size_type> titleOrder;
+      for (zim::size_type n = 0; n < file.getCountArticles(); ++n)
+      {
+        zim::Article a = file.getArticleByTitle(n);
+        if (a.getMimeType() == "text/html")
+          titleOrder.push_back(a.getIndex());
+      }
+
+      std::vector<zim::size_type> random;
+      std::srand(2);
+      for (unsigned n = 0; n < reads; ++n)
+        random.push_back(titleOrder[std::rand() % titleOrder.size()]);
+
+      // use a fresh file for each run, so that no cluster is cached
+      zim::File randomFile("clusterbench.zim");
+      double randomTime = readPages(randomFile, random);
+      zim::File titleFile("clusterbench.zim");
+      double titleTime = readPages(titleFile, titleOrder);
+
+      std::printf("%-8s %10u %10llu %7.3f %15.1f %20.1f\n",
+                  strategies[s].name,
+                  static_cast<unsigned>(file.getCountClusters()),
+                  static_cast<unsigned long long>(file.getFilesize()),
+                  static_cast<double>(dataSize) / file.getFilesize(),
+                  randomTime, titleTime);
+      std::cout.flush();
+    }
+
+    ::remove("clusterbench.zim");
+  }
+  catch (const std::exception& e)
+  {
+    std::cerr << e.what() << std::endl;
+    return 1;
+  }
+}
@@ -0,0 +1,147 @@
+/*
+ * Copyright (C) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * is provided AS IS, WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, and
+ * NON-INFRINGEMENT.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ */
+#include <cxxtools/unit/testsuite.h>
+#include <cxxtools/unit/registertest.h>
+#include "clusterwriter.h"
+#include <zim/cluster.h>
+#include <sstream>
+#include <fstream>
+#include <cstdio>
+#include "config.h"
+
+class ClusterWriterTest : public cxxtools::unit::TestSuite
+{
+    static void writeClusters(std::ostream& out, std::vector<zim::offset_type>& offsets,
+                              unsigned threads, unsigned maxInFlight)
+    {
+      zim::writer::ClusterWriter writer(out, offsets, threads, maxInFlight);
+      for (unsigned n = 0; n < 50; ++n)
+      {
+        zim::Cluster cluster;
+#if defined(ENABLE_ZLIB)
+        cluster.setCompression(n % 5 == 0 ? zim::zimcompNone : zim::zimcompZip);
+#else
+        cluster.setCompression(zim::zimcompNone);
+#endif
+        std::ostringstream data;
+        for (unsigned i = 0; i <= n; ++i)
+          data << "blob " << n << ' ' << i << ' ';
+        cluster.addBlob(data.str().data(), data.str().size());
+        cluster.addBlob("end", 3);
+
+        CXXTOOLS_UNIT_ASSERT_EQUALS(writer.count(), n);
+        writer.add(cluster);
+      }
+
+      writer.flush();
+    }
+
+  public:
+    ClusterWriterTest()
+      : cxxtools::unit::TestSuite("zim::ClusterWriterTest")
+    {
+      registerMethod("sameOutput", *this, &ClusterWriterTest::sameOutput);
+      registerMethod("fileClusters", *this, &ClusterWriterTest::fileClusters);
+    }
+
+    void sameOutput()
+    {
+      std::ostringstream out0;
+      std::vector<zim::offset_type> offsets0;
+      writeClusters(out0, offsets0, 0, 0);
+
+      std::ostringstream out3;
+      std::vector<zim::offset_type> offsets3;
+      writeClusters(out3, offsets3, 3, 2);
+
+      CXXTOOLS_UNIT_ASSERT_EQUALS(offsets0.size(), 50u);
+      CXXTOOLS_UNIT_ASSERT(offsets0 == offsets3);
+      CXXTOOLS_UNIT_ASSERT(out0.str() == out3.str());
+
+      std::istringstream in(out3.str());
+      in.seekg(offsets3[49]);
+      zim::Cluster cluster;
+      in >> cluster;
+      CXXTOOLS_UNIT_ASSERT(in);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(cluster.count(), 2u);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(std::string(cluster.getBlobPtr(1), cluster.getBlobSize(1)), "end");
+    }
+
+    void fileClusters()
+    {
+      std::string content;
+      for (unsigned n = 0; n < 10000; ++n)
+        content += static_cast<char>('a' + n % 26);
+      {
+        std::ofstream f("clusterwriter.tmp", std::ios::binary);
+        f << content;
+      }
+
+      // via the stream and copied to the output file directly
+      std::ostringstream out0;
+      std::vector<zim::offset_type> offsets0;
+      {
+        zim::writer::ClusterWriter writer(out0, offsets0, 2);
+        zim::Cluster cluster;
+        cluster.addBlob("first", 5);
+        writer.add(cluster);
+        writer.addFile("clusterwriter.tmp", 100, 5000);
+        writer.add(cluster);
+        writer.flush();
+      }
+
+      std::vector<zim::offset_type> offsets1;
+      {
+        std::ofstream out1("clusterwriter.out.tmp", std::ios::binary);
+        zim::writer::ClusterWriter writer(out1, offsets1, 0);
+        writer.setOutputFile("clusterwriter.out.tmp");
+        zim::Cluster cluster;
+        cluster.addBlob("first", 5);
+        writer.add(cluster);
+        writer.addFile("clusterwriter.tmp", 100, 5000);
+        writer.add(cluster);
+      }
+
+      std::ifstream in1("clusterwriter.out.tmp", std::ios::binary);
+      std::ostringstream data1;
+      data1 << in1.rdbuf();
+      std::remove("clusterwriter.tmp");
+      std::remove("clusterwriter.out.tmp");
+
+      CXXTOOLS_UNIT_ASSERT_EQUALS(offsets0.size(), 3u);
+      CXXTOOLS_UNIT_ASSERT(offsets0 == offsets1);
+      CXXTOOLS_UNIT_ASSERT(out0.str() == data1.str());
+
+      std::istringstream in(out0.str());
+      in.seekg(offsets0[1]);
+      zim::Cluster cluster;
+      in >> cluster;
+      CXXTOOLS_UNIT_ASSERT(in);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(cluster.count(), 1u);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(cluster.getCompression(), zim::zimcompNone);
+      CXXTOOLS_UNIT_ASSERT(std::string(cluster.getBlobPtr(0), cluster.getBlobSize(0)) == content.substr(100, 5000));
+
+      in >> cluster;
+      CXXTOOLS_UNIT_ASSERT(in);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(std::string(cluster.getBlobPtr(0), cluster.getBlobSize(0)), "first");
+    }
+
+};
+
+cxxtools::unit::RegisterTest<ClusterWriterTest> register_ClusterWriterTest;
@@ -0,0 +1,118 @@
+/*
+ * Copyright (C) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * is provided AS IS, WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, and
+ * NON-INFRINGEMENT.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ */
+#include <cxxtools/unit/testsuite.h>
+#include <cxxtools/unit/registertest.h>
+#include "codecselector.h"
+#include <zim/cluster.h>
+#include <sstream>
+#include <cstdlib>
+#include "config.h"
+
+class CodecSelectorTest : public cxxtools::unit::TestSuite
+{
+    static zim::Cluster textCluster()
+    {
+      zim::Cluster cluster;
+      cluster.setCompression(zim::zimcompZip);
+      for (unsigned n = 0; n < 2000; ++n)
+      {
+        std::ostringstream data;
+        data << "<p>this is paragraph " << n << " of some article</p>\n";
+        cluster.addBlob(data.str().data(), data.str().size());
+      }
+      return cluster;
+    }
+
+    static zim::Cluster randomCluster()
+    {
+      zim::Cluster cluster;
+      cluster.setCompression(zim::zimcompZip);
+      std::srand(1);
+      std::string data;
+      for (unsigned n = 0; n < 100000; ++n)
+        data += static_cast<char>(std::rand());
+      cluster.addBlob(data.data(), data.size());
+      return cluster;
+    }
+
+  public:
+    CodecSelectorTest()
+      : cxxtools::unit::TestSuite("zim::writer::CodecSelectorTest")
+    {
+      registerMethod("compressText", *this, &CodecSelectorTest::compressText);
+      registerMethod("storeRandom", *this, &CodecSelectorTest::storeRandom);
+      registerMethod("decodeSpeed", *this, &CodecSelectorTest::decodeSpeed);
+      registerMethod("budget", *this, &CodecSelectorTest::budget);
+    }
+
+    void compressText()
+    {
+      zim::writer::CodecSelector selector;
+      zim::Cluster cluster = textCluster();
+      selector.select(cluster);
+      if (selector.getCandidates().empty())
+        CXXTOOLS_UNIT_ASSERT_EQUALS(cluster.getCompression(), zim::zimcompNone);
+      else
+        CXXTOOLS_UNIT_ASSERT(cluster.isCompressed());
+
+      // the chosen compression is read back
+      std::stringstream s;
+      s << cluster;
+      zim::Cluster cluster2;
+      s >> cluster2;
+      CXXTOOLS_UNIT_ASSERT(!s.fail());
+      CXXTOOLS_UNIT_ASSERT_EQUALS(cluster2.getCompression(), cluster.getCompression());
+      CXXTOOLS_UNIT_ASSERT_EQUALS(cluster2.count(), 2000);
+      CXXTOOLS_UNIT_ASSERT(std::string(cluster2.getBlobPtr(7), cluster2.getBlobSize(7))
+                        == std::string(cluster.getBlobPtr(7), cluster.getBlobSize(7)));
+    }
+
+    void storeRandom()
+    {
+      zim::writer::CodecSelector selector;
+      zim::Cluster cluster = randomCluster();
+      selector.select(cluster);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(cluster.getCompression(), zim::zimcompNone);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(selector.getCount(zim::zimcompNone), 1);
+    }
+
+    void decodeSpeed()
+    {
+      // no codec decompresses a petabyte per second
+      zim::writer::CodecSelector selector(1e9);
+      zim::Cluster cluster = textCluster();
+      selector.select(cluster);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(cluster.getCompression(), zim::zimcompNone);
+    }
+
+    void budget()
+    {
+      zim::writer::CodecSelector selector(0, 1);
+      if (selector.getCandidates().empty())
+        return;
+
+      selector.addTime(1);
+      zim::Cluster cluster = textCluster();
+      selector.select(cluster);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(cluster.getCompression(), selector.getCandidates()[0].compression);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(selector.getCountFallback(), 1);
+    }
+};
+
+cxxtools::unit::RegisterTest<CodecSelectorTest> register_CodecSelectorTest;
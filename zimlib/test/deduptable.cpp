@@ -0,0 +1,90 @@
+/*
+ * Copyright (C) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * is provided AS IS, WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, and
+ * NON-INFRINGEMENT.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ */
+
+#include <cxxtools/unit/testsuite.h>
+#include <cxxtools/unit/registertest.h>
+#include "deduptable.h"
+#include <string>
+
+class DedupTableTest : public cxxtools::unit::TestSuite
+{
+  public:
+    DedupTableTest()
+      : cxxtools::unit::TestSuite("zim::DedupTableTest")
+    {
+      registerMethod("hash", *this, &DedupTableTest::hash);
+      registerMethod("find", *this, &DedupTableTest::find);
+      registerMethod("collisions", *this, &DedupTableTest::collisions);
+    }
+
+    void hash()
+    {
+      std::string s1 = "body { color: red; }\n";
+      std::string s2 = s1;
+      std::string s3 = "body { color: red; }\r";
+
+      CXXTOOLS_UNIT_ASSERT_EQUALS(zim::writer::DedupTable::hash(s1.data(), s1.size()),
+                                  zim::writer::DedupTable::hash(s2.data(), s2.size()));
+      CXXTOOLS_UNIT_ASSERT(zim::writer::DedupTable::hash(s1.data(), s1.size())
+                        != zim::writer::DedupTable::hash(s3.data(), s3.size()));
+      CXXTOOLS_UNIT_ASSERT(zim::writer::DedupTable::hash(s1.data(), 8)
+                        != zim::writer::DedupTable::hash(s1.data(), 9));
+    }
+
+    void find()
+    {
+      zim::writer::DedupTable table;
+      for (unsigned n = 0; n < 10000; ++n)
+        table.insert(n * 7919, n % 100, n, n % 3);
+
+      CXXTOOLS_UNIT_ASSERT_EQUALS(table.size(), 10000u);
+
+      for (unsigned n = 0; n < 10000; n += 97)
+      {
+        zim::size_type slot = table.first(n * 7919, n % 100);
+        CXXTOOLS_UNIT_ASSERT(slot != zim::writer::DedupTable::npos);
+        CXXTOOLS_UNIT_ASSERT_EQUALS(table[slot].cluster, n);
+        CXXTOOLS_UNIT_ASSERT_EQUALS(table[slot].blob, n % 3);
+        CXXTOOLS_UNIT_ASSERT_EQUALS(table.next(slot, n * 7919, n % 100), zim::writer::DedupTable::npos);
+      }
+
+      CXXTOOLS_UNIT_ASSERT_EQUALS(table.first(7919, 2), zim::writer::DedupTable::npos);
+    }
+
+    void collisions()
+    {
+      // different blobs with the same hash and size are all found
+      zim::writer::DedupTable table;
+      for (unsigned n = 0; n < 3000; ++n)
+        table.insert(n % 3 == 0 ? 42 : n, 10, n, 0);
+
+      unsigned found = 0;
+      for (zim::size_type slot = table.first(42, 10); slot != zim::writer::DedupTable::npos;
+           slot = table.next(slot, 42, 10))
+      {
+        CXXTOOLS_UNIT_ASSERT(table[slot].cluster % 3 == 0);
+        ++found;
+      }
+
+      CXXTOOLS_UNIT_ASSERT_EQUALS(found, 1000u);
+    }
+
+};
+
+cxxtools::unit::RegisterTest<DedupTableTest> register_DedupTableTest;
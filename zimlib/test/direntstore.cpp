@@ -0,0 +1,185 @@
+/*
+ * Copyright (C) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * is provided AS IS, WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, and
+ * NON-INFRINGEMENT.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ */
+
+#include <cxxtools/unit/testsuite.h>
+#include <cxxtools/unit/registertest.h>
+#include <zim/writer/direntstore.h>
+#include <sstream>
+
+class DirentStoreTest : public cxxtools::unit::TestSuite
+{
+    static std::string written(const zim::Dirent& dirent)
+    {
+      std::ostringstream s;
+      s << dirent;
+      return s.str();
+    }
+
+  public:
+    DirentStoreTest()
+      : cxxtools::unit::TestSuite("zim::DirentStoreTest")
+    {
+      registerMethod("arena", *this, &DirentStoreTest::arena);
+      registerMethod("interning", *this, &DirentStoreTest::interning);
+      registerMethod("getUpdate", *this, &DirentStoreTest::getUpdate);
+      registerMethod("permute", *this, &DirentStoreTest::permute);
+    }
+
+    void arena()
+    {
+      zim::writer::StringArena arena;
+      std::string longString(300, 'x');
+      std::string zeros("a\0b", 3);
+
+      zim::writer::StringArena::Handle h1 = arena.add("Berlin");
+      zim::writer::StringArena::Handle h2 = arena.add(longString);
+      zim::writer::StringArena::Handle h3 = arena.add(zeros);
+
+      CXXTOOLS_UNIT_ASSERT_EQUALS(arena.add(std::string()), zim::writer::StringArena::empty);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(arena.get(zim::writer::StringArena::empty), std::string());
+      CXXTOOLS_UNIT_ASSERT_EQUALS(arena.get(h1), "Berlin");
+      CXXTOOLS_UNIT_ASSERT_EQUALS(arena.get(h2), longString);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(arena.get(h3), zeros);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(arena.getSize(h2), 300u);
+      CXXTOOLS_UNIT_ASSERT(arena.equals(h1, "Berlin"));
+      CXXTOOLS_UNIT_ASSERT(!arena.equals(h1, "Bern"));
+      CXXTOOLS_UNIT_ASSERT_EQUALS(arena.size(), 3u);
+
+      // strings do not cross chunk boundaries
+      std::string big(zim::writer::StringArena::chunkSize / 2, 'y');
+      zim::writer::StringArena::Handle h4 = arena.add(big);
+      zim::writer::StringArena::Handle h5 = arena.add(big);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(arena.get(h4), big);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(arena.get(h5), big);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(arena.get(h1), "Berlin");
+      CXXTOOLS_UNIT_ASSERT_EQUALS(arena.getMemoryUsage(), 2 * zim::writer::StringArena::chunkSize);
+
+      arena.clear();
+      CXXTOOLS_UNIT_ASSERT_EQUALS(arena.size(), 0u);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(arena.getMemoryUsage(), zim::writer::StringArena::chunkSize);
+    }
+
+    void interning()
+    {
+      zim::writer::DirentStore store;
+
+      zim::writer::Dirent d1('A', "Berlin");
+      d1.setAid("Berlin");
+      d1.setTitle("Berlin");
+      d1.setArticle(0, 0, 0);
+      store.push_back(d1);
+
+      zim::writer::Dirent d2('A', "Bern");
+      d2.setAid("42");
+      d2.setTitle("Bern, Switzerland");
+      d2.setArticle(0, 0, 0);
+      store.push_back(d2);
+
+      CXXTOOLS_UNIT_ASSERT_EQUALS(store.size(), 2u);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(store.getAid(0), "Berlin");
+      CXXTOOLS_UNIT_ASSERT_EQUALS(store.getTitle(0), "Berlin");
+      CXXTOOLS_UNIT_ASSERT_EQUALS(store.getAid(1), "42");
+      CXXTOOLS_UNIT_ASSERT_EQUALS(store.getUrl(1), "Bern");
+      CXXTOOLS_UNIT_ASSERT_EQUALS(store.getTitle(1), "Bern, Switzerland");
+      CXXTOOLS_UNIT_ASSERT(store.isAid(1, "42"));
+
+      CXXTOOLS_UNIT_ASSERT_EQUALS(store.getDirentSize(0), d1.getDirentSize());
+      CXXTOOLS_UNIT_ASSERT_EQUALS(store.getDirentSize(1), d2.getDirentSize());
+    }
+
+    void getUpdate()
+    {
+      zim::writer::DirentStore store;
+
+      zim::writer::Dirent article('A', "Berlin");
+      article.setAid("1");
+      article.setParameter("p");
+      article.setVersion(3);
+      article.setIdx(7);
+      article.setClusterGroup(2);
+      article.setCompress();
+      article.setArticle(5, 11, 13);
+      store.push_back(article);
+
+      zim::writer::Dirent redirect('A', "Berlin, Germany");
+      redirect.setAid("2");
+      redirect.setRedirectAid("1");
+      redirect.setIdx(8);
+      redirect.setRedirect(0);
+      store.push_back(redirect);
+
+      zim::writer::Dirent d = store.get(0);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(written(d), written(article));
+      CXXTOOLS_UNIT_ASSERT_EQUALS(d.getAid(), "1");
+      CXXTOOLS_UNIT_ASSERT_EQUALS(d.getIdx(), 7u);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(d.getClusterGroup(), 2u);
+      CXXTOOLS_UNIT_ASSERT(d.isCompress());
+      CXXTOOLS_UNIT_ASSERT(!d.isPacked());
+
+      d.setCluster(17, 19);
+      d.setPacked();
+      store.update(0, d);
+      d = store.get(0);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(d.getClusterNumber(), 17u);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(d.getBlobNumber(), 19u);
+      CXXTOOLS_UNIT_ASSERT(d.isPacked());
+      CXXTOOLS_UNIT_ASSERT_EQUALS(d.getUrl(), "Berlin");
+
+      CXXTOOLS_UNIT_ASSERT(store.isRedirect(1));
+      CXXTOOLS_UNIT_ASSERT(!store.isArticle(1));
+      store.setRedirect(1, 7);
+      d = store.get(1);
+      CXXTOOLS_UNIT_ASSERT(d.isRedirect());
+      CXXTOOLS_UNIT_ASSERT_EQUALS(d.getRedirectIndex(), 7u);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(d.getRedirectAid(), "1");
+      redirect.setRedirect(7);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(written(d), written(redirect));
+    }
+
+    void permute()
+    {
+      zim::writer::DirentStore store;
+      const char* urls[] = { "c", "a", "d", "b" };
+      for (unsigned n = 0; n < 4; ++n)
+      {
+        zim::writer::Dirent d('A', urls[n]);
+        d.setAid(urls[n]);
+        d.setArticle(0, n, 0);
+        store.push_back(d);
+      }
+
+      std::vector<zim::size_type> order;
+      order.push_back(1);
+      order.push_back(3);
+      order.push_back(0);
+      order.push_back(2);
+      store.permute(order);
+      store.resize(3);
+
+      CXXTOOLS_UNIT_ASSERT_EQUALS(store.size(), 3u);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(store.getUrl(0), "a");
+      CXXTOOLS_UNIT_ASSERT_EQUALS(store.getUrl(1), "b");
+      CXXTOOLS_UNIT_ASSERT_EQUALS(store.getUrl(2), "c");
+      CXXTOOLS_UNIT_ASSERT_EQUALS(store.get(2).getClusterNumber(), 0u);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(store.get(1).getClusterNumber(), 3u);
+    }
+
+};
+
+cxxtools::unit::RegisterTest<DirentStoreTest> register_DirentStoreTest;
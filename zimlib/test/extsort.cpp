@@ -0,0 +1,116 @@
+/*
+ * Copyright (C) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * is provided AS IS, WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, and
+ * NON-INFRINGEMENT.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ */
+
+#include <cxxtools/unit/testsuite.h>
+#include <cxxtools/unit/registertest.h>
+#include "extsort.h"
+#include <algorithm>
+#include <sstream>
+#include <cstdlib>
+#include <sys/resource.h>
+
+class ExternalSorterTest : public cxxtools::unit::TestSuite
+{
+    typedef std::pair<std::string, std::string> RecordType;
+
+    static bool keyLess(const RecordType& r1, const RecordType& r2)
+    {
+      return r1.first < r2.first;
+    }
+
+    void checkSort(zim::size_type memoryLimit, unsigned expectedRuns)
+    {
+      std::vector<RecordType> records;
+      std::srand(1);
+      for (unsigned n = 0; n < 20000; ++n)
+      {
+        std::string key;
+        unsigned len = std::rand() % 6;
+        for (unsigned i = 0; i < len; ++i)
+          key += static_cast<char>("ab\0\xe4z"[std::rand() % 5]);
+        std::ostringstream data;
+        data << n;
+        records.push_back(RecordType(key, data.str()));
+      }
+
+      zim::writer::ExternalSorter sorter("extsort-test.tmp", memoryLimit, 2);
+      for (unsigned n = 0; n < records.size(); ++n)
+        sorter.add(records[n].first, records[n].second);
+      sorter.sort();
+
+      if (expectedRuns == 0)
+        CXXTOOLS_UNIT_ASSERT_EQUALS(sorter.getCountRuns(), 0u);
+      else
+        CXXTOOLS_UNIT_ASSERT(sorter.getCountRuns() >= expectedRuns);
+
+      std::stable_sort(records.begin(), records.end(), keyLess);
+
+      std::string key, data;
+      for (unsigned n = 0; n < records.size(); ++n)
+      {
+        CXXTOOLS_UNIT_ASSERT(sorter.next(key, data));
+        CXXTOOLS_UNIT_ASSERT_EQUALS(key, records[n].first);
+        CXXTOOLS_UNIT_ASSERT_EQUALS(data, records[n].second);
+      }
+      CXXTOOLS_UNIT_ASSERT(!sorter.next(key, data));
+    }
+
+  public:
+    ExternalSorterTest()
+      : cxxtools::unit::TestSuite("zim::ExternalSorterTest")
+    {
+      registerMethod("sortInMemory", *this, &ExternalSorterTest::sortInMemory);
+      registerMethod("sortRuns", *this, &ExternalSorterTest::sortRuns);
+      registerMethod("sortManyRuns", *this, &ExternalSorterTest::sortManyRuns);
+    }
+
+    void sortInMemory()
+    {
+      checkSort(1 << 30, 0);
+    }
+
+    void sortRuns()
+    {
+      checkSort(64 << 10, 10);
+    }
+
+    void sortManyRuns()
+    {
+      // more runs than file descriptors
+      struct rlimit limit;
+      getrlimit(RLIMIT_NOFILE, &limit);
+      struct rlimit low = limit;
+      low.rlim_cur = 64;
+      setrlimit(RLIMIT_NOFILE, &low);
+
+      try
+      {
+        checkSort(1 << 10, 500);
+      }
+      catch (...)
+      {
+        setrlimit(RLIMIT_NOFILE, &limit);
+        throw;
+      }
+      setrlimit(RLIMIT_NOFILE, &limit);
+    }
+
+};
+
+cxxtools::unit::RegisterTest<ExternalSorterTest> register_ExternalSorterTest;
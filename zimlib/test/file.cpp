@@ -0,0 +1,165 @@
+/*
+ * Copyright (C) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * is provided AS IS, WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, and
+ * NON-INFRINGEMENT.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ */
+
+#include <cxxtools/unit/testsuite.h>
+#include <cxxtools/unit/registertest.h>
+#include <zim/writer/zimcreator.h>
+#include <zim/writer/articlesource.h>
+#include <zim/file.h>
+#include <zim/article.h>
+#include <zim/blob.h>
+#include <fstream>
+#include <iterator>
+#include <vector>
+#include <cstdio>
+
+namespace
+{
+  class FileTestArticle : public zim::writer::Article
+  {
+      std::string url;
+      std::string data;
+      bool compress;
+
+    public:
+      FileTestArticle(const std::string& url_, const std::string& data_, bool compress_)
+        : url(url_),
+          data(data_),
+          compress(compress_)
+        { }
+
+      virtual std::string getAid() const        { return url; }
+      virtual char getNamespace() const         { return 'A'; }
+      virtual std::string getUrl() const        { return url; }
+      virtual std::string getTitle() const      { return url; }
+      virtual std::string getMimeType() const   { return compress ? "text/plain" : "image/png"; }
+      virtual bool shouldCompress() const       { return compress; }
+
+      const std::string& getArticleData() const { return data; }
+  };
+
+  class FileTestSource : public zim::writer::ArticleSource
+  {
+      std::vector<FileTestArticle> articles;
+      unsigned next;
+
+    public:
+      FileTestSource()
+        : next(0)
+        { }
+
+      void add(const FileTestArticle& article)
+        { articles.push_back(article); }
+
+      virtual const zim::writer::Article* getNextArticle()
+        { return next < articles.size() ? &articles[next++] : 0; }
+
+      virtual zim::Blob getData(const std::string& aid)
+      {
+        for (unsigned n = 0; n < articles.size(); ++n)
+          if (articles[n].getAid() == aid)
+            return zim::Blob(articles[n].getArticleData().data(), articles[n].getArticleData().size());
+        return zim::Blob();
+      }
+  };
+
+  std::string testData(unsigned size, unsigned seed)
+  {
+    std::string data;
+    for (unsigned n = 0; n < size; ++n)
+      data += static_cast<char>((n * 7 + seed) % 251);
+    return data;
+  }
+
+  std::string str(const zim::Blob& blob)
+  {
+    return std::string(blob.data(), blob.size());
+  }
+}
+
+class FileTest : public cxxtools::unit::TestSuite
+{
+    std::string big;
+    std::string small;
+    std::string text;
+
+    void checkArticles(zim::File& file)
+    {
+      // the dirent of each article is read before its data
+      for (unsigned n = 0; n < 2; ++n)
+      {
+        CXXTOOLS_UNIT_ASSERT_EQUALS(str(file.getArticle('A', "small").getData()), small);
+        CXXTOOLS_UNIT_ASSERT_EQUALS(str(file.getArticle('A', "big").getData()), big);
+        CXXTOOLS_UNIT_ASSERT_EQUALS(str(file.getArticle('A', "text").getData()), text);
+      }
+    }
+
+  public:
+    FileTest()
+      : cxxtools::unit::TestSuite("zim::FileTest")
+    {
+      registerMethod("uncompressedBlob", *this, &FileTest::uncompressedBlob);
+      registerMethod("splitFile", *this, &FileTest::splitFile);
+    }
+
+    void setUp()
+    {
+      big = testData(100000, 1);
+      small = testData(300, 2);
+      text = testData(1000, 3);
+
+      FileTestSource src;
+      src.add(FileTestArticle("big", big, false));
+      src.add(FileTestArticle("small", small, false));
+      src.add(FileTestArticle("text", text, true));
+
+      zim::writer::ZimCreator creator;
+      creator.create("file.zim", src);
+    }
+
+    void tearDown()
+    {
+      ::remove("file.zim");
+      ::remove("file-split.zimaa");
+      ::remove("file-split.zimab");
+    }
+
+    void uncompressedBlob()
+    {
+      zim::File file("file.zim");
+      checkArticles(file);
+    }
+
+    void splitFile()
+    {
+      std::ifstream in("file.zim", std::ios::binary);
+      std::string data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+
+      // split in the middle of the big blob
+      std::string::size_type pos = data.find(big.substr(0, 1000)) + big.size() / 2;
+      std::ofstream("file-split.zimaa", std::ios::binary).write(data.data(), pos);
+      std::ofstream("file-split.zimab", std::ios::binary).write(data.data() + pos, data.size() - pos);
+
+      zim::File file("file-split.zim");
+      checkArticles(file);
+    }
+
+};
+
+cxxtools::unit::RegisterTest<FileTest> register_FileTest;
@@ -0,0 +1,245 @@
+/*
+ * Copyright (C) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * is provided AS IS, WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, and
+ * NON-INFRINGEMENT.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ */
+
+#include <cxxtools/unit/testsuite.h>
+#include <cxxtools/unit/registertest.h>
+#include "indexdata.h"
+#include <zim/writer/zimcreator.h>
+#include <zim/file.h>
+#include <cstdio>
+
+using namespace indexdata;
+
+class IndexArticleTest : public cxxtools::unit::TestSuite
+{
+    EntriesType entries[4];
+    EntriesType positions[4];
+
+    void makeEntries()
+    {
+      // two positions in every article, so that blocks start and end
+      // within the entries of an article
+      for (unsigned n = 0; n < 300; ++n)
+        entries[0].push_back(entry(n / 2 * 3, n % 2 ? 40 + n : 5));
+      entries[2].push_back(entry(4, 1));
+      entries[2].push_back(entry(4, 9));
+      entries[2].push_back(entry(17, 3));
+
+      // positions are deltas within an article, but not across articles
+      positions[1].push_back(entry(3, 2));
+      positions[1].push_back(entry(3, 10));
+      positions[1].push_back(entry(3, 25));
+      positions[1].push_back(entry(7, 4));
+      positions[1].push_back(entry(7, 30));
+      positions[1].push_back(entry(9, 1));
+      positions[1].push_back(entry(9, 1));
+    }
+
+    // "Z" data of old files with absolute indexes and positions
+    static IndexTestArticle noOffsetArticle()
+    {
+      std::ostringstream data;
+      zim::ZIntStream zdata(data);
+      zdata.put(3).put(10)
+           .put(3).put(25)
+           .put(7).put(4);
+
+      std::ostringstream parameter;
+      zim::ZIntStream zparameter(parameter);
+      zparameter.put(1)
+                .put(data.str().size())
+                .put(3).put(2);
+
+      return IndexTestArticle("nooffset", parameter.str(), data.str());
+    }
+
+    void createFile()
+    {
+      IndexTestSource src;
+      src.add(blockArticle("blocks", entries));
+      src.add(zArticle("zformat", entries));
+      src.add(bArticle("bformat", entries));
+      src.add(zArticle("zpositions", positions));
+      src.add(noOffsetArticle());
+
+      zim::writer::ZimCreator creator;
+      creator.create("indexarticle.zim", src);
+    }
+
+    void checkCategories(zim::IndexArticle& article)
+    {
+      for (unsigned c = 0; c < 4; ++c)
+      {
+        CXXTOOLS_UNIT_ASSERT_EQUALS(article.getCategoryCount(c), entries[c].size());
+        const EntriesType& e = article.getCategory(c);
+        CXXTOOLS_UNIT_ASSERT_EQUALS(e.size(), entries[c].size());
+        for (EntriesType::size_type n = 0; n < e.size(); ++n)
+        {
+          CXXTOOLS_UNIT_ASSERT_EQUALS(e[n].index, entries[c][n].index);
+          CXXTOOLS_UNIT_ASSERT_EQUALS(e[n].pos, entries[c][n].pos);
+        }
+      }
+    }
+
+    void checkSkipTo(zim::IndexArticle& article)
+    {
+      zim::IndexArticle::Cursor cursor(article, 0);
+      CXXTOOLS_UNIT_ASSERT(!cursor.end());
+      CXXTOOLS_UNIT_ASSERT_EQUALS(cursor->index, 0u);
+
+      // entries 126 and 127 end the first block and have index 189
+      CXXTOOLS_UNIT_ASSERT(cursor.skipTo(189));
+      CXXTOOLS_UNIT_ASSERT_EQUALS(cursor->index, 189u);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(cursor->pos, 5u);
+      CXXTOOLS_UNIT_ASSERT(cursor.skipTo(189));
+      CXXTOOLS_UNIT_ASSERT_EQUALS(cursor->pos, 5u);
+      ++cursor;
+      CXXTOOLS_UNIT_ASSERT_EQUALS(cursor->index, 189u);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(cursor->pos, 167u);
+
+      // across the block boundary
+      CXXTOOLS_UNIT_ASSERT(cursor.skipTo(190));
+      CXXTOOLS_UNIT_ASSERT_EQUALS(cursor->index, 192u);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(cursor->pos, 5u);
+      ++cursor;
+      CXXTOOLS_UNIT_ASSERT_EQUALS(cursor->index, 192u);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(cursor->pos, 169u);
+
+      // over a whole block to the last entry
+      CXXTOOLS_UNIT_ASSERT(cursor.skipTo(447));
+      CXXTOOLS_UNIT_ASSERT_EQUALS(cursor->index, 447u);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(cursor->pos, 5u);
+      ++cursor;
+      CXXTOOLS_UNIT_ASSERT(!cursor.end());
+      CXXTOOLS_UNIT_ASSERT_EQUALS(cursor->pos, 339u);
+      ++cursor;
+      CXXTOOLS_UNIT_ASSERT(cursor.end());
+
+      // past the end
+      zim::IndexArticle::Cursor cursor2(article, 0);
+      CXXTOOLS_UNIT_ASSERT(!cursor2.skipTo(448));
+      CXXTOOLS_UNIT_ASSERT(cursor2.end());
+      CXXTOOLS_UNIT_ASSERT(!cursor2.skipTo(1000));
+
+      zim::IndexArticle::Cursor cursor3(article, 2);
+      CXXTOOLS_UNIT_ASSERT(cursor3.skipTo(5));
+      CXXTOOLS_UNIT_ASSERT_EQUALS(cursor3->index, 17u);
+      CXXTOOLS_UNIT_ASSERT(!cursor3.skipTo(18));
+
+      zim::IndexArticle::Cursor cursor4(article, 1);
+      CXXTOOLS_UNIT_ASSERT(cursor4.end());
+      CXXTOOLS_UNIT_ASSERT(!cursor4.skipTo(0));
+    }
+
+  public:
+    IndexArticleTest()
+      : cxxtools::unit::TestSuite("zim::IndexArticleTest")
+    {
+      registerMethod("blockFormat", *this, &IndexArticleTest::blockFormat);
+      registerMethod("zFormat", *this, &IndexArticleTest::zFormat);
+      registerMethod("bFormat", *this, &IndexArticleTest::bFormat);
+      registerMethod("zPositions", *this, &IndexArticleTest::zPositions);
+      registerMethod("zNoOffset", *this, &IndexArticleTest::zNoOffset);
+
+      makeEntries();
+    }
+
+    void setUp()
+    {
+      createFile();
+    }
+
+    void tearDown()
+    {
+      ::remove("indexarticle.zim");
+    }
+
+    void blockFormat()
+    {
+      zim::File file("indexarticle.zim");
+      zim::IndexArticle article(file.getArticle('X', "blocks"));
+      CXXTOOLS_UNIT_ASSERT(article.isBlockFormat());
+
+      const zim::IndexArticle::BlocksType& blocks = article.getBlocks(0);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(blocks.size(), 3u);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(blocks[0].maxIndex, 189u);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(blocks[0].count, 128u);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(blocks[2].maxIndex, 447u);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(blocks[2].count, 44u);
+
+      checkSkipTo(article);
+
+      zim::IndexArticle article2(file.getArticle('X', "blocks"));
+      checkCategories(article2);
+    }
+
+    void zFormat()
+    {
+      zim::File file("indexarticle.zim");
+      zim::IndexArticle article(file.getArticle('X', "zformat"));
+      CXXTOOLS_UNIT_ASSERT(!article.isBlockFormat());
+      checkCategories(article);
+      checkSkipTo(article);
+    }
+
+    void bFormat()
+    {
+      zim::File file("indexarticle.zim");
+      zim::IndexArticle article(file.getArticle('X', "bformat"));
+      CXXTOOLS_UNIT_ASSERT(!article.isBlockFormat());
+      checkCategories(article);
+      checkSkipTo(article);
+    }
+
+    void zPositions()
+    {
+      zim::File file("indexarticle.zim");
+      zim::IndexArticle article(file.getArticle('X', "zpositions"));
+      CXXTOOLS_UNIT_ASSERT_EQUALS(article.getTotalCount(), positions[1].size());
+
+      const EntriesType& e = article.getCategory(1);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(e.size(), positions[1].size());
+      for (EntriesType::size_type n = 0; n < e.size(); ++n)
+      {
+        CXXTOOLS_UNIT_ASSERT_EQUALS(e[n].index, positions[1][n].index);
+        CXXTOOLS_UNIT_ASSERT_EQUALS(e[n].pos, positions[1][n].pos);
+      }
+    }
+
+    void zNoOffset()
+    {
+      zim::File file("indexarticle.zim");
+      zim::IndexArticle::setNoOffset();
+      zim::IndexArticle article(file.getArticle('X', "nooffset"));
+      EntriesType e = article.getCategory(0);
+      zim::IndexArticle::setNoOffset(false);
+
+      CXXTOOLS_UNIT_ASSERT_EQUALS(e.size(), 4u);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(e[0].index, 3u);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(e[0].pos, 2u);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(e[1].index, 3u);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(e[1].pos, 10u);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(e[2].index, 3u);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(e[2].pos, 25u);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(e[3].index, 7u);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(e[3].pos, 4u);
+    }
+};
+
+cxxtools::unit::RegisterTest<IndexArticleTest> register_IndexArticleTest;
@@ -0,0 +1,184 @@
+/*
+ * Copyright (C) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * is provided AS IS, WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, and
+ * NON-INFRINGEMENT.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ */
+
+// Index articles in the formats read by zim::IndexArticle for the tests.
+
+#ifndef ZIM_TEST_INDEXDATA_H
+#define ZIM_TEST_INDEXDATA_H
+
+#include <zim/indexarticle.h>
+#include <zim/writer/articlesource.h>
+#include <zim/endian.h>
+#include <zim/zintstream.h>
+#include <sstream>
+#include <vector>
+
+namespace indexdata
+{
+  class IndexTestArticle : public zim::writer::Article
+  {
+      std::string url;
+      std::string parameter;
+      std::string data;
+
+    public:
+      IndexTestArticle(const std::string& url_, const std::string& parameter_, const std::string& data_)
+        : url(url_),
+          parameter(parameter_),
+          data(data_)
+        { }
+
+      virtual std::string getAid() const        { return url; }
+      virtual char getNamespace() const         { return 'X'; }
+      virtual std::string getUrl() const        { return url; }
+      virtual std::string getTitle() const      { return url; }
+      virtual std::string getMimeType() const   { return "application/octet-stream"; }
+      virtual std::string getParameter() const  { return parameter; }
+
+      const std::string& getArticleData() const { return data; }
+  };
+
+  class IndexTestSource : public zim::writer::ArticleSource
+  {
+      std::vector<IndexTestArticle> articles;
+      unsigned next;
+
+    public:
+      IndexTestSource()
+        : next(0)
+        { }
+
+      void add(const IndexTestArticle& article)
+        { articles.push_back(article); }
+
+      virtual const zim::writer::Article* getNextArticle()
+        { return next < articles.size() ? &articles[next++] : 0; }
+
+      virtual zim::Blob getData(const std::string& aid)
+      {
+        for (unsigned n = 0; n < articles.size(); ++n)
+          if (articles[n].getAid() == aid)
+            return zim::Blob(articles[n].getArticleData().data(), articles[n].getArticleData().size());
+        return zim::Blob();
+      }
+  };
+
+  typedef zim::IndexArticle::EntriesType EntriesType;
+
+  inline zim::IndexArticle::Entry entry(unsigned index, unsigned pos)
+  {
+    zim::IndexArticle::Entry e;
+    e.index = index;
+    e.pos = pos;
+    return e;
+  }
+
+  // writes the categories in the block format
+  inline IndexTestArticle blockArticle(const std::string& url, const EntriesType entries[4])
+  {
+    std::ostringstream parameter;
+    zim::ZIntStream zparameter(parameter);
+    std::string data;
+
+    unsigned flags = zim::IndexArticle::blockFormatFlag;
+    for (unsigned c = 0; c < 4; ++c)
+      if (!entries[c].empty())
+        flags |= 1 << c;
+    zparameter.put(flags);
+
+    for (unsigned c = 0; c < 4; ++c)
+    {
+      if (entries[c].empty())
+        continue;
+      std::ostringstream d;
+      zim::IndexArticle::writeBlocks(d, entries[c]);
+      zparameter.put(d.str().size())
+                .put(entries[c].size());
+      data += d.str();
+    }
+
+    return IndexTestArticle(url, parameter.str(), data);
+  }
+
+  // writes the categories in the "Z" format like zimwriterdb does
+  inline IndexTestArticle zArticle(const std::string& url, const EntriesType entries[4])
+  {
+    std::ostringstream parameter;
+    zim::ZIntStream zparameter(parameter);
+    std::string data;
+
+    unsigned flags = 0;
+    for (unsigned c = 0; c < 4; ++c)
+      if (!entries[c].empty())
+        flags |= 1 << c;
+    zparameter.put(flags);
+
+    for (unsigned c = 0; c < 4; ++c)
+    {
+      if (entries[c].empty())
+        continue;
+
+      std::ostringstream d;
+      zim::ZIntStream zd(d);
+      unsigned lastidx = 0;
+      unsigned lastpos = 0;
+      for (EntriesType::size_type n = 1; n < entries[c].size(); ++n)
+      {
+        unsigned idx = entries[c][n].index - lastidx;
+        unsigned pos = entries[c][n].pos;
+        if (idx == 0)
+          pos -= lastpos;
+        else
+          lastidx = entries[c][n].index;
+        lastpos = entries[c][n].pos;
+        zd.put(idx).put(pos);
+      }
+
+      zparameter.put(d.str().size())
+                .put(entries[c][0].index)
+                .put(entries[c][0].pos);
+      data += d.str();
+    }
+
+    return IndexTestArticle(url, parameter.str(), data);
+  }
+
+  inline void putValue(std::string& data, zim::size_type v)
+  {
+    zim::size_type le = zim::fromLittleEndian<zim::size_type>(&v);
+    data.append(reinterpret_cast<const char*>(&le), sizeof(le));
+  }
+
+  // writes the categories in the "B" format
+  inline IndexTestArticle bArticle(const std::string& url, const EntriesType entries[4])
+  {
+    std::string data;
+    for (unsigned c = 0; c < 4; ++c)
+      putValue(data, entries[c].size());
+    for (unsigned c = 0; c < 4; ++c)
+      for (EntriesType::size_type n = 0; n < entries[c].size(); ++n)
+      {
+        putValue(data, entries[c][n].index);
+        putValue(data, entries[c][n].pos);
+      }
+    return IndexTestArticle(url, std::string(), data);
+  }
+}
+
+#endif // ZIM_TEST_INDEXDATA_H
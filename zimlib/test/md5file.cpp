@@ -0,0 +1,117 @@
+/*
+ * Copyright (C) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * is provided AS IS, WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, and
+ * NON-INFRINGEMENT.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ */
+#include <cxxtools/unit/testsuite.h>
+#include <cxxtools/unit/registertest.h>
+#include "md5file.h"
+#include "md5stream.h"
+#include <zim/progress.h>
+#include <cstring>
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+
+class Md5FileTest : public cxxtools::unit::TestSuite
+{
+    class CountProgress : public zim::Progress
+    {
+      public:
+        unsigned calls;
+        zim::offset_type last;
+
+        CountProgress()
+          : calls(0),
+            last(0)
+          { }
+
+        void progress(zim::offset_type done, zim::offset_type total)
+        {
+          ++calls;
+          last = done;
+        }
+    };
+
+    static std::string testData(unsigned size)
+    {
+      std::string data;
+      for (unsigned n = 0; n < size; ++n)
+        data += static_cast<char>(n * 7 + n / 251);
+      return data;
+    }
+
+    static void writeFile(const std::string& fname, const std::string& data)
+    {
+      std::ofstream out(fname.c_str(), std::ios::out | std::ios::binary);
+      out << data;
+    }
+
+  public:
+    Md5FileTest()
+      : cxxtools::unit::TestSuite("zim::Md5FileTest")
+    {
+      registerMethod("splitFile", *this, &Md5FileTest::splitFile);
+      registerMethod("shortFile", *this, &Md5FileTest::shortFile);
+    }
+
+    void splitFile()
+    {
+      // spans more blocks than there are buffers and a part boundary
+      // inside of a block
+      std::string data = testData(5 * zim::md5FileBlockSize + 1234);
+      std::string::size_type split = zim::md5FileBlockSize + 77;
+      writeFile("md5file-test.zimaa", data.substr(0, split));
+      writeFile("md5file-test.zimab", data.substr(split));
+
+      zim::streambuf::PartsType parts;
+      parts.push_back(zim::streambuf::PartsType::value_type("md5file-test.zimaa", split));
+      parts.push_back(zim::streambuf::PartsType::value_type("md5file-test.zimab", data.size() - split));
+
+      zim::offset_type size = data.size() - 10;
+      CountProgress progress;
+      unsigned char digest[16];
+      zim::md5File(parts, size, digest, &progress);
+
+      zim::Md5stream md5;
+      md5.write(data.data(), size);
+      unsigned char expected[16];
+      md5.getDigest(expected);
+
+      std::remove("md5file-test.zimaa");
+      std::remove("md5file-test.zimab");
+
+      CXXTOOLS_UNIT_ASSERT(std::memcmp(digest, expected, 16) == 0);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(progress.calls, 6u);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(progress.last, size);
+    }
+
+    void shortFile()
+    {
+      writeFile("md5file-test.zim", testData(100));
+
+      zim::streambuf::PartsType parts;
+      parts.push_back(zim::streambuf::PartsType::value_type("md5file-test.zim", 200));
+
+      unsigned char digest[16];
+      CXXTOOLS_UNIT_ASSERT_THROW(zim::md5File(parts, 200, digest), std::runtime_error);
+
+      std::remove("md5file-test.zim");
+    }
+
+};
+
+cxxtools::unit::RegisterTest<Md5FileTest> register_Md5FileTest;
@@ -0,0 +1,197 @@
+/*
+ * Copyright (C) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * is provided AS IS, WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, and
+ * NON-INFRINGEMENT.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ */
+
+#include <cxxtools/unit/testsuite.h>
+#include <cxxtools/unit/registertest.h>
+#include "indexdata.h"
+#include "phrase.h"
+#include <zim/writer/zimcreator.h>
+#include <zim/file.h>
+#include <cstdio>
+
+using namespace indexdata;
+
+class PhraseTest : public cxxtools::unit::TestSuite
+{
+    std::vector<std::string> words;
+    std::vector<std::vector<unsigned> > positions;
+
+    void phrase(const char* w1, const char* w2, const char* w3 = 0)
+    {
+      words.clear();
+      words.push_back(w1);
+      words.push_back(w2);
+      if (w3)
+        words.push_back(w3);
+      positions.assign(words.size(), std::vector<unsigned>());
+    }
+
+    std::vector<unsigned> find(const char* w1, const char* w2, unsigned gap,
+                               const std::vector<unsigned>* candidates = 0)
+    {
+      zim::File file("phrase.zim");
+      std::vector<zim::IndexArticle> articles;
+      articles.push_back(zim::IndexArticle(file.getArticle('X', w1)));
+      articles.push_back(zim::IndexArticle(file.getArticle('X', w2)));
+      phrase(w1, w2);
+
+      std::vector<unsigned> result;
+      zim::findPhrase(articles, words, gap, candidates, result);
+      return result;
+    }
+
+  public:
+    PhraseTest()
+      : cxxtools::unit::TestSuite("zim::PhraseTest")
+    {
+      registerMethod("adjacent", *this, &PhraseTest::adjacent);
+      registerMethod("gap", *this, &PhraseTest::gap);
+      registerMethod("repeatedWords", *this, &PhraseTest::repeatedWords);
+      registerMethod("noMatch", *this, &PhraseTest::noMatch);
+      registerMethod("findPhrase", *this, &PhraseTest::findPhrase);
+      registerMethod("findCandidates", *this, &PhraseTest::findCandidates);
+    }
+
+    void setUp()
+    {
+      // 1: "new york city"
+      // 2: "york new"
+      // 3: "new and york"
+      // 5: "new new york"
+      // 6: "york"
+      EntriesType newEntries[4];
+      newEntries[0].push_back(entry(1, 0));
+      newEntries[0].push_back(entry(3, 0));
+      newEntries[0].push_back(entry(5, 0));
+      newEntries[1].push_back(entry(2, 5));
+      newEntries[1].push_back(entry(5, 4));
+
+      EntriesType yorkEntries[4];
+      yorkEntries[0].push_back(entry(1, 4));
+      yorkEntries[0].push_back(entry(2, 0));
+      yorkEntries[0].push_back(entry(3, 8));
+      yorkEntries[2].push_back(entry(5, 8));
+      yorkEntries[2].push_back(entry(6, 0));
+
+      IndexTestSource src;
+      src.add(zArticle("new", newEntries));
+      src.add(zArticle("york", yorkEntries));
+
+      zim::writer::ZimCreator creator;
+      creator.create("phrase.zim", src);
+    }
+
+    void tearDown()
+    {
+      ::remove("phrase.zim");
+    }
+
+    void adjacent()
+    {
+      phrase("new", "york");
+      positions[0].push_back(0);
+      positions[1].push_back(4);
+      CXXTOOLS_UNIT_ASSERT(zim::matchPhrase(words, positions, 1));
+      CXXTOOLS_UNIT_ASSERT(!zim::matchPhrase(words, positions, 0));
+    }
+
+    void gap()
+    {
+      // "new and york": 5 bytes between the end of new and york
+      phrase("new", "york");
+      positions[0].push_back(0);
+      positions[1].push_back(8);
+      CXXTOOLS_UNIT_ASSERT(zim::matchPhrase(words, positions, 5));
+      CXXTOOLS_UNIT_ASSERT(!zim::matchPhrase(words, positions, 4));
+
+      // the closest preceding occurrence counts
+      positions[0].push_back(4);
+      CXXTOOLS_UNIT_ASSERT(!zim::matchPhrase(words, positions, 0));
+      CXXTOOLS_UNIT_ASSERT(zim::matchPhrase(words, positions, 1));
+    }
+
+    void repeatedWords()
+    {
+      // "new new york"
+      phrase("new", "new", "york");
+      positions[0].push_back(0);
+      positions[0].push_back(4);
+      positions[1] = positions[0];
+      positions[2].push_back(8);
+      CXXTOOLS_UNIT_ASSERT(zim::matchPhrase(words, positions, 1));
+
+      // an occurrence does not match twice
+      phrase("new", "new");
+      positions[0].push_back(0);
+      positions[1].push_back(0);
+      CXXTOOLS_UNIT_ASSERT(!zim::matchPhrase(words, positions, 100));
+    }
+
+    void noMatch()
+    {
+      // "york new"
+      phrase("new", "york");
+      positions[0].push_back(5);
+      positions[1].push_back(0);
+      CXXTOOLS_UNIT_ASSERT(!zim::matchPhrase(words, positions, 100));
+
+      positions[1].clear();
+      CXXTOOLS_UNIT_ASSERT(!zim::matchPhrase(words, positions, 100));
+
+      std::vector<unsigned> result = find("york", "new", 1);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(result.size(), 1u);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(result[0], 2u);
+
+      result = find("new", "city", 8);
+      CXXTOOLS_UNIT_ASSERT(result.empty());
+    }
+
+    void findPhrase()
+    {
+      std::vector<unsigned> result = find("new", "york", 1);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(result.size(), 2u);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(result[0], 1u);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(result[1], 5u);
+
+      result = find("new", "york", 5);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(result.size(), 3u);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(result[0], 1u);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(result[1], 3u);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(result[2], 5u);
+    }
+
+    void findCandidates()
+    {
+      std::vector<unsigned> candidates;
+      candidates.push_back(3);
+      candidates.push_back(5);
+      candidates.push_back(6);
+      std::vector<unsigned> result = find("new", "york", 5, &candidates);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(result.size(), 2u);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(result[0], 3u);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(result[1], 5u);
+
+      candidates.clear();
+      candidates.push_back(2);
+      result = find("new", "york", 5, &candidates);
+      CXXTOOLS_UNIT_ASSERT(result.empty());
+    }
+};
+
+cxxtools::unit::RegisterTest<PhraseTest> register_PhraseTest;
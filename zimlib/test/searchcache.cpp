@@ -0,0 +1,109 @@
+/*
+ * Copyright (C) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * is provided AS IS, WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, and
+ * NON-INFRINGEMENT.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ */
+
+#include <cxxtools/unit/testsuite.h>
+#include <cxxtools/unit/registertest.h>
+#include "searchcache.h"
+
+class SearchCacheTest : public cxxtools::unit::TestSuite
+{
+    static zim::SearchCache::Hits makeHits(unsigned count)
+    {
+      zim::SearchCache::Hits hits(count);
+      for (unsigned n = 0; n < count; ++n)
+      {
+        hits[n].index = n * 2;
+        hits[n].priority = 1000.0f - n;
+      }
+      return hits;
+    }
+
+  public:
+    SearchCacheTest()
+      : cxxtools::unit::TestSuite("zim::SearchCacheTest")
+    {
+      registerMethod("getPage", *this, &SearchCacheTest::getPage);
+      registerMethod("depth", *this, &SearchCacheTest::depth);
+      registerMethod("evict", *this, &SearchCacheTest::evict);
+    }
+
+    void getPage()
+    {
+      zim::SearchCache cache(1024 * 1024);
+      cache.put("foo", makeHits(50), 50);
+
+      zim::SearchCache::Hits page;
+      zim::size_type totalCount, depth;
+      CXXTOOLS_UNIT_ASSERT(cache.get("foo", 20, 10, page, totalCount, depth));
+      CXXTOOLS_UNIT_ASSERT_EQUALS(page.size(), 10u);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(page[0].index, 40u);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(totalCount, 50u);
+
+      // all matches are ranked, so a page beyond the end is just short
+      CXXTOOLS_UNIT_ASSERT(cache.get("foo", 45, 10, page, totalCount, depth));
+      CXXTOOLS_UNIT_ASSERT_EQUALS(page.size(), 5u);
+
+      CXXTOOLS_UNIT_ASSERT(!cache.get("bar", 0, 10, page, totalCount, depth));
+      CXXTOOLS_UNIT_ASSERT_EQUALS(depth, 0u);
+    }
+
+    void depth()
+    {
+      zim::SearchCache cache(1024 * 1024);
+      cache.put("foo", makeHits(20), 100);
+
+      zim::SearchCache::Hits page;
+      zim::size_type totalCount, depth;
+      CXXTOOLS_UNIT_ASSERT(cache.get("foo", 0, 20, page, totalCount, depth));
+      CXXTOOLS_UNIT_ASSERT(!cache.get("foo", 10, 20, page, totalCount, depth));
+      CXXTOOLS_UNIT_ASSERT_EQUALS(depth, 20u);
+
+      // a shorter ranking does not replace a longer one
+      cache.put("foo", makeHits(40), 100);
+      cache.put("foo", makeHits(30), 100);
+      CXXTOOLS_UNIT_ASSERT(cache.get("foo", 10, 30, page, totalCount, depth));
+      CXXTOOLS_UNIT_ASSERT_EQUALS(depth, 40u);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(cache.getCount(), 1u);
+    }
+
+    void evict()
+    {
+      zim::SearchCache cache(2000);
+      cache.put("a", makeHits(100), 100);
+      cache.put("b", makeHits(100), 100);
+
+      zim::SearchCache::Hits page;
+      zim::size_type totalCount, depth;
+      CXXTOOLS_UNIT_ASSERT(cache.get("a", 0, 10, page, totalCount, depth));
+
+      // "b" is the least recently used entry now
+      cache.put("c", makeHits(100), 100);
+      CXXTOOLS_UNIT_ASSERT(cache.get("a", 0, 10, page, totalCount, depth));
+      CXXTOOLS_UNIT_ASSERT(!cache.get("b", 0, 10, page, totalCount, depth));
+      CXXTOOLS_UNIT_ASSERT(cache.get("c", 0, 10, page, totalCount, depth));
+      CXXTOOLS_UNIT_ASSERT(cache.getSize() <= cache.getMaxSize());
+
+      // entries larger than the cache are not stored
+      cache.put("d", makeHits(1000), 1000);
+      CXXTOOLS_UNIT_ASSERT(!cache.get("d", 0, 10, page, totalCount, depth));
+    }
+
+};
+
+cxxtools::unit::RegisterTest<SearchCacheTest> register_SearchCacheTest;
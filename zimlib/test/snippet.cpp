@@ -0,0 +1,84 @@
+/*
+ * Copyright (C) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * is provided AS IS, WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, and
+ * NON-INFRINGEMENT.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ */
+#include <cxxtools/unit/testsuite.h>
+#include <cxxtools/unit/registertest.h>
+#include "snippet.h"
+
+class SnippetTest : public cxxtools::unit::TestSuite
+{
+    static std::string snippet(const std::string& html, const std::string& word, unsigned size)
+    {
+      std::vector<zim::HighlightType> highlights;
+      for (std::string::size_type p = html.find(word); p != std::string::npos; p = html.find(word, p + 1))
+        highlights.push_back(zim::HighlightType(p, word.size()));
+      return zim::makeSnippet(html.data(), html.size(), highlights, size);
+    }
+
+  public:
+    SnippetTest()
+      : cxxtools::unit::TestSuite("zim::SnippetTest")
+    {
+      registerMethod("highlight", *this, &SnippetTest::highlight);
+      registerMethod("window", *this, &SnippetTest::window);
+      registerMethod("insideTag", *this, &SnippetTest::insideTag);
+      registerMethod("noMatch", *this, &SnippetTest::noMatch);
+    }
+
+    void highlight()
+    {
+      CXXTOOLS_UNIT_ASSERT_EQUALS(
+        snippet("<p>The <i>quick</i>  brown\nfox &amp; dog</p>", "fox", 100),
+        "The quick brown <b>fox</b> &amp; dog");
+    }
+
+    void window()
+    {
+      std::string html = "<html><body><p>";
+      for (unsigned n = 0; n < 100; ++n)
+        html += "filler words here ";
+      html += "the target sentence</p><p>";
+      for (unsigned n = 0; n < 100; ++n)
+        html += "more filler ";
+      html += "</p></body></html>";
+
+      std::string s = snippet(html, "target", 40);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(s.substr(0, 4), "... ");
+      CXXTOOLS_UNIT_ASSERT(s.find("the <b>target</b> sentence more") != std::string::npos);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(s.substr(s.size() - 4), " ...");
+      CXXTOOLS_UNIT_ASSERT(s.size() < 80);
+    }
+
+    void insideTag()
+    {
+      // the window starts inside the attribute value of the link
+      std::string html = "<p>text <a href=\"/A/some_long_link_target_to_skip\">link</a> and then the word</p>";
+      std::string s = snippet(html, "word", 100);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(s, "... link and then the <b>word</b>");
+    }
+
+    void noMatch()
+    {
+      std::string html = "<html><head><title>Title</title><style>p { }</style></head>"
+                         "<body><h1>Heading</h1><script>var x = 1;</script><p>First words</p></body></html>";
+      CXXTOOLS_UNIT_ASSERT_EQUALS(snippet(html, "missing", 100), "... Heading First words");
+    }
+
+};
+
+cxxtools::unit::RegisterTest<SnippetTest> register_SnippetTest;
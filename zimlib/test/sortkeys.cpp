@@ -0,0 +1,100 @@
+/*
+ * Copyright (C) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * is provided AS IS, WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, and
+ * NON-INFRINGEMENT.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ */
+#include <cxxtools/unit/testsuite.h>
+#include <cxxtools/unit/registertest.h>
+#include "sortkeys.h"
+#include <algorithm>
+#include <cstdlib>
+
+class SortKeysTest : public cxxtools::unit::TestSuite
+{
+    typedef std::pair<std::string, zim::size_type> KeyType;
+
+    static void makeKeys(std::vector<KeyType>& keys, unsigned count)
+    {
+      // short keys with many duplicates and long keys with common prefixes
+      std::srand(1);
+      for (unsigned n = 0; n < count; ++n)
+      {
+        std::string key = n % 3 == 0 ? std::string("common prefix ") : std::string();
+        unsigned len = std::rand() % 12;
+        for (unsigned i = 0; i < len; ++i)
+          key += static_cast<char>("ab\0\xe4z"[std::rand() % 5]);
+        keys.push_back(KeyType(key, n));
+      }
+    }
+
+  public:
+    SortKeysTest()
+      : cxxtools::unit::TestSuite("zim::SortKeysTest")
+    {
+      registerMethod("sort", *this, &SortKeysTest::sort);
+      registerMethod("parallelSort", *this, &SortKeysTest::parallelSort);
+      registerMethod("find", *this, &SortKeysTest::find);
+    }
+
+    void checkSort(unsigned threads)
+    {
+      std::vector<KeyType> keys;
+      makeKeys(keys, 50000);
+
+      zim::writer::SortKeys sortKeys;
+      for (unsigned n = 0; n < keys.size(); ++n)
+        sortKeys.add(keys[n].first, keys[n].second);
+      sortKeys.sort(threads);
+
+      std::sort(keys.begin(), keys.end());
+
+      CXXTOOLS_UNIT_ASSERT_EQUALS(sortKeys.size(), keys.size());
+      for (unsigned n = 0; n < keys.size(); ++n)
+        CXXTOOLS_UNIT_ASSERT_EQUALS(sortKeys.getNumber(n), keys[n].second);
+    }
+
+    void sort()
+    {
+      checkSort(0);
+    }
+
+    void parallelSort()
+    {
+      checkSort(3);
+    }
+
+    void find()
+    {
+      zim::writer::SortKeys sortKeys;
+      sortKeys.add('A', "Berlin", 0);
+      sortKeys.add('A', "Bern", 1);
+      sortKeys.add('I', "Berlin", 2);
+      sortKeys.add('A', "Berlin, Germany", 3);
+      sortKeys.sort(1);
+
+      CXXTOOLS_UNIT_ASSERT_EQUALS(sortKeys.getNumber(0), 0u);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(sortKeys.getNumber(1), 3u);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(sortKeys.getNumber(2), 1u);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(sortKeys.getNumber(3), 2u);
+
+      CXXTOOLS_UNIT_ASSERT_EQUALS(sortKeys.find("ABern"), 1u);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(sortKeys.find("IBerlin"), 2u);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(sortKeys.find("ABer"), zim::writer::SortKeys::notFound);
+    }
+
+};
+
+cxxtools::unit::RegisterTest<SortKeysTest> register_SortKeysTest;
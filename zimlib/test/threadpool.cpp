@@ -0,0 +1,82 @@
+/*
+ * Copyright (C) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * is provided AS IS, WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, and
+ * NON-INFRINGEMENT.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ */
+#include <cxxtools/unit/testsuite.h>
+#include <cxxtools/unit/registertest.h>
+#include "threadpool.h"
+#include "mutex.h"
+#include <zim/multisearch.h>
+
+class ThreadPoolTest : public cxxtools::unit::TestSuite
+{
+    class CountTask : public zim::ThreadPool::Task
+    {
+        zim::Mutex& mutex;
+        unsigned& count;
+
+      public:
+        CountTask(zim::Mutex& mutex_, unsigned& count_)
+          : mutex(mutex_),
+            count(count_)
+          { }
+
+        void run()
+        {
+          zim::MutexLock lock(mutex);
+          ++count;
+        }
+    };
+
+  public:
+    ThreadPoolTest()
+      : cxxtools::unit::TestSuite("zim::ThreadPoolTest")
+    {
+      registerMethod("runAll", *this, &ThreadPoolTest::runAll);
+      registerMethod("emptyLibrary", *this, &ThreadPoolTest::emptyLibrary);
+    }
+
+    void runAll()
+    {
+      zim::Mutex mutex;
+      unsigned count = 0;
+
+      {
+        zim::ThreadPool pool(4);
+        CXXTOOLS_UNIT_ASSERT_EQUALS(pool.size(), 4u);
+        for (unsigned n = 0; n < 1000; ++n)
+          pool.add(new CountTask(mutex, count));
+      }
+
+      // the destructor runs the queued tasks
+      CXXTOOLS_UNIT_ASSERT_EQUALS(count, 1000u);
+    }
+
+    void emptyLibrary()
+    {
+      zim::MultiSearch search(2);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(search.getCountThreads(), 2u);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(search.size(), 0u);
+
+      zim::MultiSearch::Results results;
+      CXXTOOLS_UNIT_ASSERT_EQUALS(search.search(results, "foo", 10, 100), 0u);
+      CXXTOOLS_UNIT_ASSERT(results.empty());
+    }
+
+};
+
+cxxtools::unit::RegisterTest<ThreadPoolTest> register_ThreadPoolTest;
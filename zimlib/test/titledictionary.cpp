@@ -0,0 +1,105 @@
+/*
+ * Copyright (C) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * is provided AS IS, WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, and
+ * NON-INFRINGEMENT.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ */
+
+#include <cxxtools/unit/testsuite.h>
+#include <cxxtools/unit/registertest.h>
+#include "zim/titledictionary.h"
+#include <sstream>
+#include <set>
+
+class TitleDictionaryTest : public cxxtools::unit::TestSuite
+{
+    std::set<std::string> titles;
+    zim::TitleDictionary dict;
+
+  public:
+    TitleDictionaryTest()
+      : cxxtools::unit::TestSuite("zim::TitleDictionaryTest")
+    {
+      registerMethod("find", *this, &TitleDictionaryTest::find);
+      registerMethod("lowerBound", *this, &TitleDictionaryTest::lowerBound);
+      registerMethod("iterate", *this, &TitleDictionaryTest::iterate);
+
+      for (unsigned n = 0; n < 1000; ++n)
+      {
+        std::ostringstream s;
+        s << "title" << (n * 7) % 1000;
+        titles.insert(s.str());
+        if (n % 10 == 0)
+          titles.insert(s.str() + " (disambiguation)");
+      }
+
+      zim::size_type idx = 0;
+      for (std::set<std::string>::const_iterator it = titles.begin(); it != titles.end(); ++it)
+        dict.add(*it, idx++);
+    }
+
+    void find()
+    {
+      CXXTOOLS_UNIT_ASSERT_EQUALS(dict.size(), titles.size());
+
+      zim::size_type idx = 0;
+      for (std::set<std::string>::const_iterator it = titles.begin(); it != titles.end(); ++it, ++idx)
+      {
+        zim::size_type r;
+        CXXTOOLS_UNIT_ASSERT(dict.find(*it, r));
+        CXXTOOLS_UNIT_ASSERT_EQUALS(r, idx);
+      }
+
+      zim::size_type r;
+      CXXTOOLS_UNIT_ASSERT(!dict.find("title", r));
+      CXXTOOLS_UNIT_ASSERT(!dict.find("title10 ", r));
+      CXXTOOLS_UNIT_ASSERT(!dict.find("a", r));
+      CXXTOOLS_UNIT_ASSERT(!dict.find("z", r));
+      CXXTOOLS_UNIT_ASSERT(dict.find("title999") != dict.end());
+      CXXTOOLS_UNIT_ASSERT(dict.find("title1000") == dict.end());
+    }
+
+    void lowerBound()
+    {
+      const char* keys[] = { "", "a", "title", "title1", "title10 ", "title5", "title55 (d", "title999", "u" };
+      for (unsigned n = 0; n < sizeof(keys) / sizeof(keys[0]); ++n)
+      {
+        std::set<std::string>::const_iterator e = titles.lower_bound(keys[n]);
+        zim::TitleDictionary::const_iterator it = dict.lower_bound(keys[n]);
+        if (e == titles.end())
+          CXXTOOLS_UNIT_ASSERT(it == dict.end());
+        else
+        {
+          CXXTOOLS_UNIT_ASSERT(it != dict.end());
+          CXXTOOLS_UNIT_ASSERT_EQUALS(*it, *e);
+        }
+      }
+    }
+
+    void iterate()
+    {
+      std::set<std::string>::const_iterator e = titles.begin();
+      zim::size_type idx = 0;
+      for (zim::TitleDictionary::const_iterator it = dict.begin(); it != dict.end(); ++it, ++e, ++idx)
+      {
+        CXXTOOLS_UNIT_ASSERT_EQUALS(it.getTitle(), *e);
+        CXXTOOLS_UNIT_ASSERT_EQUALS(it.getIndex(), idx);
+      }
+      CXXTOOLS_UNIT_ASSERT(e == titles.end());
+    }
+
+};
+
+cxxtools::unit::RegisterTest<TitleDictionaryTest> register_TitleDictionaryTest;
@@ -0,0 +1,191 @@
+/*
+ * Copyright (C) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * is provided AS IS, WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, and
+ * NON-INFRINGEMENT.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ */
+
+#include <cxxtools/unit/testsuite.h>
+#include <cxxtools/unit/registertest.h>
+#include "zim/titleindex.h"
+#include "zim/zintstream.h"
+#include <sstream>
+#include <algorithm>
+#include <cctype>
+#include <stdexcept>
+
+class TitleIndexTest : public cxxtools::unit::TestSuite
+{
+    std::vector<std::string> titles;
+    zim::TitleIndex index;
+
+    zim::TitleIndex::Results expected(const std::string& expr) const
+    {
+      zim::TitleIndex::Results ret;
+      for (unsigned n = 0; n < titles.size(); ++n)
+        if (titles[n].find(expr) != std::string::npos)
+          ret.push_back(n * 3);
+      return ret;
+    }
+
+    void check(const zim::TitleIndex& idx, const std::string& expr)
+    {
+      zim::TitleIndex::Results results;
+      idx.search(expr, results);
+      zim::TitleIndex::Results e = expected(expr);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(results.size(), e.size());
+      for (unsigned n = 0; n < e.size(); ++n)
+        CXXTOOLS_UNIT_ASSERT_EQUALS(results[n], e[n]);
+    }
+
+    static unsigned levenshtein(const std::string& a, const std::string& b)
+    {
+      std::vector<unsigned> prev(b.size() + 1), cur(b.size() + 1);
+      for (unsigned j = 0; j <= b.size(); ++j)
+        prev[j] = j;
+      for (unsigned i = 1; i <= a.size(); ++i)
+      {
+        cur[0] = i;
+        for (unsigned j = 1; j <= b.size(); ++j)
+          cur[j] = std::min(std::min(prev[j] + 1, cur[j - 1] + 1),
+                            prev[j - 1] + (std::tolower(a[i - 1]) == std::tolower(b[j - 1]) ? 0 : 1));
+        prev.swap(cur);
+      }
+      return prev[b.size()];
+    }
+
+    void checkSimilar(const std::string& expr, unsigned maxDistance)
+    {
+      zim::TitleIndex::SimilarResults results;
+      index.findSimilar(expr, results, titles.size(), maxDistance);
+
+      zim::TitleIndex::SimilarResults e;
+      for (unsigned n = 0; n < titles.size(); ++n)
+      {
+        unsigned d = levenshtein(expr, titles[n]);
+        if (d <= maxDistance)
+          e.push_back(zim::TitleIndex::SimilarType(d, n));
+      }
+      std::sort(e.begin(), e.end());
+
+      CXXTOOLS_UNIT_ASSERT_EQUALS(results.size(), e.size());
+      for (unsigned n = 0; n < e.size(); ++n)
+      {
+        CXXTOOLS_UNIT_ASSERT_EQUALS(results[n].first, e[n].first);
+        CXXTOOLS_UNIT_ASSERT_EQUALS(results[n].second, e[n].second);
+      }
+    }
+
+  public:
+    TitleIndexTest()
+      : cxxtools::unit::TestSuite("zim::TitleIndexTest")
+    {
+      registerMethod("search", *this, &TitleIndexTest::search);
+      registerMethod("limit", *this, &TitleIndexTest::limit);
+      registerMethod("readWrite", *this, &TitleIndexTest::readWrite);
+      registerMethod("readInvalid", *this, &TitleIndexTest::readInvalid);
+      registerMethod("similar", *this, &TitleIndexTest::similar);
+
+      const char* words[] = { "Berlin", "Hamburg", "M\xc3\xbcnchen", "river", "Rhein", "castle", "of", "the" };
+      const unsigned numWords = sizeof(words) / sizeof(words[0]);
+      for (unsigned n = 0; n < 2000; ++n)
+      {
+        std::ostringstream s;
+        s << words[n % numWords] << ' ' << words[(n / numWords) % numWords];
+        if (n % 3 == 0)
+          s << " (" << n << ')';
+        titles.push_back(s.str());
+        index.add(titles.back(), n * 3);
+      }
+
+      titles.push_back("ab");
+      index.add("ab", (titles.size() - 1) * 3);
+      index.build();
+    }
+
+    void search()
+    {
+      CXXTOOLS_UNIT_ASSERT_EQUALS(index.size(), titles.size());
+
+      const char* exprs[] = { "", "a", "ab", "Berlin", "berlin", "river Rhein",
+        "the", "of the", "(1", "(123)", "ü", "nchen c", "xyz", "castle of", "e (" };
+      for (unsigned n = 0; n < sizeof(exprs) / sizeof(exprs[0]); ++n)
+        check(index, exprs[n]);
+    }
+
+    void limit()
+    {
+      zim::TitleIndex::Results results;
+      index.search("the", results, 10);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(results.size(), 10u);
+
+      results.clear();
+      index.search("e", results, 10);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(results.size(), 10u);
+    }
+
+    void readWrite()
+    {
+      std::stringstream data;
+      index.write(data);
+
+      zim::TitleIndex index2;
+      index2.read(data);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(index2.size(), index.size());
+      CXXTOOLS_UNIT_ASSERT_EQUALS(index2.getTitle(17), titles[17]);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(index2.getArticleIndex(17), 51u);
+      check(index2, "river Rhein");
+      check(index2, "ab");
+    }
+
+    void readInvalid()
+    {
+      // one title, but a bucket refers to title number 5
+      std::stringstream data;
+      zim::ZIntStream z(data);
+      z.put(1).put(10).put(4).put(1).put(1024).put(1);
+      data.write("abc", 4);
+      z.put(7);
+      for (unsigned b = 0; b < 1024; ++b)
+        z.put(b == 17 ? 1 : 0);
+      z.put(5);
+
+      zim::TitleIndex index2;
+      CXXTOOLS_UNIT_ASSERT_THROW(index2.read(data), std::runtime_error);
+    }
+
+    void similar()
+    {
+      checkSimilar("berlni river", 2);
+      checkSimilar("Hamburg Rhien", 2);
+      checkSimilar("castle fo", 1);
+      checkSimilar("castle of (16)", 3);
+      checkSimilar("the", 2);
+      checkSimilar("xyz abc", 2);
+
+      zim::TitleIndex::SimilarResults results;
+      index.findSimilar("Berlin rivr", results, 3);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(results.size(), 3u);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(results[0].first, 1u);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(index.getTitle(results[0].second), "Berlin river");
+
+      results.clear();
+      index.findSimilar("ab", results);
+      CXXTOOLS_UNIT_ASSERT(results.empty());
+    }
+
+};
+
+cxxtools::unit::RegisterTest<TitleIndexTest> register_TitleIndexTest;
@@ -21,6 +21,8 @@
 #include <cxxtools/unit/registertest.h>
 #include "zim/zintstream.h"
 #include <sstream>
+#include <vector>
+#include <stdexcept>
 
 class ZIntTest : public cxxtools::unit::TestSuite
 {
@@ -44,6 +46,9 @@ class ZIntTest : public cxxtools::unit::TestSuite
       registerMethod("zcompress1", *this, &ZIntTest::zcompress1);
       registerMethod("zcompress2", *this, &ZIntTest::zcompress2);
       registerMethod("zcompress3", *this, &ZIntTest::zcompress3);
+      registerMethod("bulkDecode", *this, &ZIntTest::bulkDecode);
+      registerMethod("bulkDecodeCount", *this, &ZIntTest::bulkDecodeCount);
+      registerMethod("bulkDecodeInvalid", *this, &ZIntTest::bulkDecodeInvalid);
     }
 
     void zcompress1()
@@ -63,6 +68,67 @@ class ZIntTest : public cxxtools::unit::TestSuite
       testNumber(16512);
     }
 
+    void bulkDecode()
+    {
+      // mix short and long values, so that groups of all lengths are decoded
+      std::vector<zim::size_type> values;
+      zim::size_type v = 1;
+      for (unsigned n = 0; n < 2000; ++n)
+      {
+        values.push_back(n % 7 == 0 ? v : n % 3);
+        v = v * 3 + 1;
+        if (v > 0x7fffffff)
+          v = n;
+      }
+      values.push_back(270549119);
+      values.push_back(270549120);
+      values.push_back(0xffffffff);
+
+      std::ostringstream data;
+      zim::ZIntStream zint(data);
+      for (unsigned n = 0; n < values.size(); ++n)
+        zint.put(values[n]);
+
+      std::string s = data.str();
+      std::vector<zim::size_type> result(s.size());
+      zim::size_type count = zim::decodeZInts(s.data(), s.data() + s.size(), &result[0]);
+
+      CXXTOOLS_UNIT_ASSERT_EQUALS(count, values.size());
+      for (unsigned n = 0; n < values.size(); ++n)
+        CXXTOOLS_UNIT_ASSERT_EQUALS(result[n], values[n]);
+    }
+
+    void bulkDecodeCount()
+    {
+      std::ostringstream data;
+      zim::ZIntStream zint(data);
+      for (unsigned n = 0; n < 100; ++n)
+        zint.put(n * 1000);
+
+      std::string s = data.str();
+      zim::size_type result[10];
+      const char* p = zim::decodeZInts(s.data(), s.data() + s.size(), result, 10);
+
+      for (unsigned n = 0; n < 10; ++n)
+        CXXTOOLS_UNIT_ASSERT_EQUALS(result[n], n * 1000);
+
+      std::istringstream in(s.substr(p - s.data()));
+      zim::ZIntStream zin(in);
+      zim::size_type next;
+      CXXTOOLS_UNIT_ASSERT(zin.get(next));
+      CXXTOOLS_UNIT_ASSERT_EQUALS(next, 10000u);
+    }
+
+    void bulkDecodeInvalid()
+    {
+      zim::size_type result[4];
+      std::string incomplete("\x01\xc0\x01", 3);
+      CXXTOOLS_UNIT_ASSERT_THROW(zim::decodeZInts(incomplete.data(), incomplete.data() + incomplete.size(), result), std::runtime_error);
+
+      std::string invalid("\x01\xff\x01", 3);
+      CXXTOOLS_UNIT_ASSERT_THROW(zim::decodeZInts(invalid.data(), invalid.data() + invalid.size(), result), std::runtime_error);
+    }
+
 };
 
 cxxtools::unit::RegisterTest<ZIntTest> register_ZIntTest;
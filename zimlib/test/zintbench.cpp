@@ -0,0 +1,93 @@
+/*
+ * Copyright (C) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * is provided AS IS, WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, and
+ * NON-INFRINGEMENT.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ */
+
+// Microbenchmark comparing zim::ZIntStream with the bulk decoder
+// zim::decodeZInts on data, which looks like full text index postings:
+// mostly small deltas with an occasional larger value.
+//
+// usage: zintbench [number-of-values [rounds]]
+
+#include <zim/zintstream.h>
+#include "ptrstream.h"
+#include <iostream>
+#include <sstream>
+#include <vector>
+#include <cstdlib>
+#include <sys/time.h>
+
+namespace
+{
+  double now()
+  {
+    struct timeval tv;
+    gettimeofday(&tv, 0);
+    return tv.tv_sec + tv.tv_usec / 1e6;
+  }
+}
+
+int main(int argc, char* argv[])
+{
+  unsigned count = argc > 1 ? std::atoi(argv[1]) : 1000000;
+  unsigned rounds = argc > 2 ? std::atoi(argv[2]) : 20;
+
+  std::ostringstream data;
+  zim::ZIntStream zout(data);
+  std::srand(1);
+  for (unsigned n = 0; n < count; ++n)
+  {
+    unsigned r = std::rand();
+    zout.put(r % 10 == 0 ? r % 100000 : r % 200);
+  }
+
+  std::string s = data.str();
+  std::vector<zim::size_type> values(s.size());
+
+  double t0 = now();
+  zim::size_type sum1 = 0;
+  for (unsigned r = 0; r < rounds; ++r)
+  {
+    zim::ptrstream in(const_cast<char*>(s.data()), const_cast<char*>(s.data() + s.size()));
+    zim::ZIntStream zin(in);
+    zim::size_type v;
+    while (zin.get(v))
+      sum1 += v;
+  }
+
+  double t1 = now();
+  zim::size_type sum2 = 0;
+  for (unsigned r = 0; r < rounds; ++r)
+  {
+    zim::size_type c = zim::decodeZInts(s.data(), s.data() + s.size(), &values[0]);
+    for (zim::size_type n = 0; n < c; ++n)
+      sum2 += values[n];
+  }
+
+  double t2 = now();
+
+  if (sum1 != sum2)
+  {
+    std::cerr << "checksum mismatch " << sum1 << " != " << sum2 << std::endl;
+    return 1;
+  }
+
+  double total = static_cast<double>(count) * rounds;
+  std::cout << count << " values, " << s.size() << " bytes, " << rounds << " rounds\n"
+               "ZIntStream:  " << (t1 - t0) << " s, " << total / (t1 - t0) / 1e6 << " M values/s\n"
+               "decodeZInts: " << (t2 - t1) << " s, " << total / (t2 - t1) / 1e6 << " M values/s" << std::endl;
+}
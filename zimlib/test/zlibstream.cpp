@@ -35,6 +35,7 @@ class ZlibstreamTest : public cxxtools::unit::TestSuite
     {
       registerMethod("inflatorIstream", *this, &ZlibstreamTest::inflatorIstreamTest);
       registerMethod("inflatorOstream", *this, &ZlibstreamTest::inflatorOstreamTest);
+      registerMethod("incompressible", *this, &ZlibstreamTest::incompressibleTest);
 
       for (unsigned n = 0; n < 10240; ++n)
         testtext += "Hello";
@@ -92,6 +93,25 @@ class ZlibstreamTest : public cxxtools::unit::TestSuite
       CXXTOOLS_UNIT_ASSERT_EQUALS(testtext, inflatetarget.str());
     }
 
+    void incompressibleTest()
+    {
+      // the deflated data does not fit into the buffer of the deflator
+      std::string data;
+      for (unsigned n = 0; n < 50000; ++n)
+        data += static_cast<char>(n * 7919 % 251 ^ n / 251 * 31);
+
+      std::stringstream deflatetarget;
+      zim::DeflateStream deflator(deflatetarget);
+      deflator << data << std::flush;
+
+      zim::InflateStream inflator(deflatetarget);
+      std::ostringstream inflatetarget;
+      inflatetarget << inflator.rdbuf();
+
+      CXXTOOLS_UNIT_ASSERT_EQUALS(data.size(), inflatetarget.str().size());
+      CXXTOOLS_UNIT_ASSERT(data == inflatetarget.str());
+    }
+
 };
 
 cxxtools::unit::RegisterTest<ZlibstreamTest> register_ZlibstreamTest;
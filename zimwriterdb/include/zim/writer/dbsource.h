@@ -33,6 +33,7 @@ namespace zim
     class DbArticle : public Article
     {
         tntdb::Row row;
+        mutable tntdb::Blob dataBlob;
 
       public:
         DbArticle()   { }
@@ -48,6 +49,8 @@ namespace zim
         virtual std::string getMimeType() const;
         virtual bool shouldCompress() const;
         virtual std::string getRedirectAid() const;
+        virtual bool hasData() const;
+        virtual Blob getData() const;
     };
 
     class DbSource : public ArticleSource
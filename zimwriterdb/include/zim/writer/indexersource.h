@@ -84,12 +84,19 @@ namespace zim
         MStream::size_type _count;
         MStream::size_type _progress;
 
+        bool _blockFormat;
+
         void transformData(const char* srcdata, unsigned srcsize);
         void fetchData(const std::string& aid);
 
       public:
         Indexer(const char* tmpfilename, const char* trivialWordsFile, unsigned memoryFactor);
 
+        /// write the index entries in the block format with skip entries
+        /// (see zim::IndexArticle) instead of a single zint stream
+        void setBlockFormat(bool sw = true)  { _blockFormat = sw; }
+        bool getBlockFormat() const          { return _blockFormat; }
+
         void createIndex(const char* infile);
 
         const Article* getNextArticle();
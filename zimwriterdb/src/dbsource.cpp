@@ -88,6 +88,18 @@ namespace zim
       return row[5].getString();
     }
 
+    bool DbArticle::hasData() const
+    {
+      return !isRedirect();
+    }
+
+    Blob DbArticle::getData() const
+    {
+      log_debug("getData");
+      row[7].getBlob(dataBlob);
+      return Blob(dataBlob.data(), dataBlob.size());
+    }
+
     DbSource::DbSource(int& argc, char* argv[])
       : initialized(false),
         dburl(cxxtools::Arg<std::string>(argc, argv, "--db", "postgresql:dbname=zim"))
@@ -113,7 +125,7 @@ namespace zim
       }
 
       stmt = conn.prepare(
-        "select a.aid, a.namespace, a.url, a.title, m.mimetype, r.aid, m.compress"
+        "select a.aid, a.namespace, a.url, a.title, m.mimetype, r.aid, m.compress, a.data"
         "  from article a"
         "  left outer join mimetype m"
         "    on m.id = a.mimetype"
@@ -20,11 +20,14 @@
 #include <zim/writer/indexersource.h>
 #include <zim/writer/zimindexer.h>
 #include <zim/zintstream.h>
+#include <zim/indexarticle.h>
 #include <cxxtools/arg.h>
 #include <zim/file.h>
 #include <zim/fileiterator.h>
 #include <stdexcept>
 #include <iostream>
+#include <sstream>
+#include <algorithm>
 #include <cxxtools/log.h>
 
 log_define("zim.writer.indexersource")
@@ -45,7 +48,8 @@ namespace zim
     Indexer::Indexer(const char* tmpfilename, const char* trivialWordsFile, unsigned memoryFactor)
       : _trivialWordsFile(trivialWordsFile),
         _mstream(tmpfilename),
-        _currentArticle(_mstream)
+        _currentArticle(_mstream),
+        _blockFormat(false)
     {
       MStream::setMinBuffersize(18);
       MStream::setMaxBuffersize(memoryFactor*18);
@@ -114,6 +118,23 @@ namespace zim
       _currentStream = _mstream.end();
     }
 
+    namespace
+    {
+      typedef std::vector<IndexEntry> IndexEntriesVector;
+
+      // writes the entries as blocks preceded by their skip entries
+      void writeBlocks(std::ostream& out, const IndexEntriesVector& entries)
+      {
+        zim::IndexArticle::EntriesType e(entries.size());
+        for (IndexEntriesVector::size_type n = 0; n < entries.size(); ++n)
+        {
+          e[n].index = entries[n].getIndex();
+          e[n].pos = entries[n].getPos();
+        }
+        zim::IndexArticle::writeBlocks(out, e);
+      }
+    }
+
     void Indexer::fetchData(const std::string& aid)
     {
       log_trace("fetch data for aid \"" << aid << '"');
@@ -128,7 +149,6 @@ namespace zim
       it->second->read(data);
       log_debug("data has " << data.size() << " bytes");
 
-      typedef std::vector<IndexEntry> IndexEntriesVector;
       IndexEntriesVector currentData[4];
 
       for (unsigned off = 0; off < data.size(); off += Zimindexer::Wordentry::size)
@@ -145,7 +165,11 @@ namespace zim
         log_debug("raw data of category " << c << " has " << currentData[c].size() << " entries");
 
         zim::ZIntStream zdatastream(zdata[c]);
-        if (!currentData[c].empty())
+        if (_blockFormat)
+        {
+          writeBlocks(zdata[c], currentData[c]);
+        }
+        else if (!currentData[c].empty())
         {
           zim::size_type lastidx = 0;
           zim::size_type lastpos = 0;
@@ -170,7 +194,7 @@ namespace zim
       log_debug("determine flags");
 
       // write flag
-      unsigned flags = 0;
+      unsigned flags = _blockFormat ? zim::IndexArticle::blockFormatFlag : 0;
       for (unsigned c = 0, flag = 1; c < 4; ++c, flag <<= 1)
       {
         log_debug("check category " << c);
@@ -190,7 +214,16 @@ namespace zim
       // write 1st entries
       for (unsigned c = 0; c < 4; ++c)
       {
-        if (!currentData[c].empty())
+        if (currentData[c].empty())
+          continue;
+
+        if (_blockFormat)
+        {
+          log_debug("write zparameter: category:" << c << " size:" << zdata[c].str().size() << " count:" << currentData[c].size());
+          zparameter.put(zdata[c].str().size())
+                    .put(currentData[c].size());
+        }
+        else
         {
           log_debug("write zparameter: category:" << c << " count:" << zdata[c].str().size() << " index:" << currentData[c][0].getIndex() << " pos:" << currentData[c][0].getPos());
           zparameter.put(zdata[c].str().size())
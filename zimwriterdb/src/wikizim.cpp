@@ -299,6 +299,14 @@ int main(int argc, char* argv[])
                    "            generates openzim-org.zim with the content of the openzim.org wiki\n"
                    "options:\n"
                    "\t-s <number>        specify chunk size for compression in kB (default 1024)\n"
+                   "\t-j <number>        number of threads compressing clusters (default 4, 0 compresses while writing)\n"
+                   "\t--dirent-memory <mb> sort directory entries in temporary files beyond this memory (default 0: in memory)\n"
+                   "\t--no-dedup           store blobs with identical content once for each directory entry\n"
+                   "\t--cluster-by <s>     fill clusters by url, mime, hint or title (default url)\n"
+                   "\t--adaptive           choose the compression of each cluster by compressing a sample\n"
+                   "\t--compression-budget <s> cpu seconds for adaptive compression (default 0: unlimited)\n"
+                   "\t--min-decode-speed <mb/s> minimum decompression speed for adaptive compression\n"
+                   "\t--block-size <kb>    compress clusters in independent blocks of this size (default 0: whole clusters)\n"
                    "\t--user-agent <ua>  set the user agent used for downloading (default \"wikizim " PACKAGE_VERSION "\")\n";
       return 1;
     }
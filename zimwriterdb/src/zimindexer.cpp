@@ -99,9 +99,11 @@ int main(int argc, char* argv[])
     cxxtools::Arg<const char*> tmpfilename(argc, argv, 't', "zimindexer.tmp");
     cxxtools::Arg<const char*> trivialWordsFile(argc, argv, 'T');
     cxxtools::Arg<unsigned> memoryFactor(argc, argv, 'M', 64);
+    cxxtools::Arg<bool> blockFormat(argc, argv, 'B');
 
     zim::writer::ZimCreator creator(argc, argv);
     zim::writer::Indexer indexer(tmpfilename, trivialWordsFile, memoryFactor);
+    indexer.setBlockFormat(blockFormat);
 
     if (argc != 3)
     {
@@ -111,7 +113,8 @@ int main(int argc, char* argv[])
                      "\t-T <file>         trivial words file for full text index (a text file with words, which are not indexed)\n"
                      "\t-M <number>       memory factor (default 64, smaller factors reduce memory usage but makes indexer slower,\n"
                      "\t                  try smaller values when you run out of memory)\n"
-                     "\t-t <filename>     temporary file name (default zimindexer.tmp)\n";
+                     "\t-t <filename>     temporary file name (default zimindexer.tmp)\n"
+                     "\t-B                write index entries in blocks with skip entries (needs a recent zimlib to read)\n";
         return -1;
     }
 
@@ -42,6 +42,14 @@ int create(int argc, char* argv[], zim::writer::ArticleSource& articleSource)
                  "\n"
                  "options:\n"
                  "\t-s <number>       specify chunk size for compression in kB (default 1024)\n"
+                 "\t-j <number>       number of threads compressing clusters (default 4, 0 compresses while writing)\n"
+                 "\t--dirent-memory <mb> sort directory entries in temporary files beyond this memory (default 0: in memory)\n"
+                 "\t--no-dedup           store blobs with identical content once for each directory entry\n"
+                 "\t--cluster-by <s>     fill clusters by url, mime, hint or title (default url)\n"
+                 "\t--adaptive           choose the compression of each cluster by compressing a sample\n"
+                 "\t--compression-budget <s> cpu seconds for adaptive compression (default 0: unlimited)\n"
+                 "\t--min-decode-speed <mb/s> minimum decompression speed for adaptive compression\n"
+                 "\t--block-size <kb>    compress clusters in independent blocks of this size (default 0: whole clusters)\n"
                  "\t--db <dburl>      specify a db source (default: postgresql:dbname=zim, tntdb is used here)\n"
                  "\t-Z <articlefile>  create a fulltext index for specified article\n"
                  "\t-S <words>        search in zim file for articles\n"
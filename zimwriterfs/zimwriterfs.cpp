@@ -80,8 +80,7 @@ magic_t magic;
 std::map<std::string, unsigned int> counters;
 std::map<std::string, std::string> fileMimeTypes;
 std::map<std::string, std::string> extMimeTypes;
-char *data = NULL;
-unsigned int dataSize = 0;
+std::string data;
 
 /* Decompress an STL string using zlib and return the original data. */
 inline std::string inflateString(const std::string& str) {
@@ -737,6 +736,7 @@ class ArticleSource : public zim::writer::ArticleSource {
     explicit ArticleSource();
     virtual const zim::writer::Article* getNextArticle();
     virtual zim::Blob getData(const std::string& aid);
+    virtual bool takeData(const std::string& aid, zim::writer::ArticleData& result);
     virtual std::string getMainPage();
 };
 
@@ -785,15 +785,19 @@ const zim::writer::Article* ArticleSource::getNextArticle() {
 }
 
 zim::Blob ArticleSource::getData(const std::string& aid) {
+  zim::writer::ArticleData result;
+  takeData(aid, result);
+  data = result.isFile() ? getFileContent(result.getFilename()) : result.getBuffer();
+  return zim::Blob(data.data(), data.size());
+}
+
+/* Hands the rewritten HTML and CSS over without copying them and
+   passes other files by name, so that they are not read here */
+bool ArticleSource::takeData(const std::string& aid, zim::writer::ArticleData& result) {
 
   if (isVerbose())
     std::cout << "Packing data for " << aid << std::endl;
 
-  if (data != NULL) {
-    delete(data);
-    data = NULL;
-  }
-
   if (aid.substr(0, 3) == "/M/") {
     std::string value; 
 
@@ -823,9 +827,7 @@ zim::Blob ArticleSource::getData(const std::string& aid) {
       value = stream.str();
     }
 
-    dataSize = value.length();
-    data = new char[dataSize];
-    memcpy(data, value.c_str(), dataSize);
+    result.take(value);
   } else {
     std::string aidPath = directoryPath + "/" + aid;
     
@@ -850,9 +852,7 @@ zim::Blob ArticleSource::getData(const std::string& aid) {
       }
       gumbo_destroy_output(&kGumboDefaultOptions, output);
 
-      dataSize = html.length();
-      data = new char[dataSize];
-      memcpy(data, html.c_str(), dataSize);
+      result.take(html);
     } else if (getMimeTypeForFile(aid).find("text/css") == 0) {
       std::string css = getFileContent(aidPath);
 
@@ -912,17 +912,13 @@ zim::Blob ArticleSource::getData(const std::string& aid) {
 	}
       }
 
-      dataSize = css.length();
-      data = new char[dataSize];
-      memcpy(data, css.c_str(), dataSize);
+      result.take(css);
     } else {
-      dataSize = getFileSize(aidPath);
-      data = new char[dataSize];
-      memcpy(data, getFileContent(aidPath).c_str(), dataSize);
+      result.setFile(aidPath, 0, getFileSize(aidPath));
     }
   }
 
-  return zim::Blob(data, dataSize);
+  return true;
 }
 
 /* Non ZIM related code */